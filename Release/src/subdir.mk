@@ -12,6 +12,7 @@ CPP_SRCS += \
 ../src/BehaviorAttack.cpp \
 ../src/BehaviorBase.cpp \
 ../src/BehaviorBlock.cpp \
+../src/BehaviorCandidates.cpp \
 ../src/BehaviorDefense.cpp \
 ../src/BehaviorDribble.cpp \
 ../src/BehaviorFormation.cpp \
@@ -30,24 +31,30 @@ CPP_SRCS += \
 ../src/CommunicateSystem.cpp \
 ../src/Dasher.cpp \
 ../src/DecisionData.cpp \
+../src/DecisionLookahead.cpp \
 ../src/DecisionTree.cpp \
+../src/DominanceMap.cpp \
 ../src/DynamicDebug.cpp \
 ../src/Evaluation.cpp \
 ../src/Formation.cpp \
 ../src/FormationTactics.cpp \
 ../src/Geometry.cpp \
+../src/HeadlessServer.cpp \
 ../src/InfoState.cpp \
 ../src/InterceptInfo.cpp \
 ../src/InterceptModel.cpp \
 ../src/Kicker.cpp \
 ../src/Logger.cpp \
+../src/MatchLog.cpp \
 ../src/Net.cpp \
 ../src/NetworkTest.cpp \
 ../src/Observer.cpp \
 ../src/ParamEngine.cpp \
 ../src/Parser.cpp \
+../src/PlannerPool.cpp \
 ../src/Player.cpp \
 ../src/PlayerParam.cpp \
+../src/PlayerSnapshot.cpp \
 ../src/PlayerState.cpp \
 ../src/Plotter.cpp \
 ../src/PositionInfo.cpp \
@@ -75,6 +82,7 @@ OBJS += \
 ./src/BehaviorAttack.o \
 ./src/BehaviorBase.o \
 ./src/BehaviorBlock.o \
+./src/BehaviorCandidates.o \
 ./src/BehaviorDefense.o \
 ./src/BehaviorDribble.o \
 ./src/BehaviorFormation.o \
@@ -93,24 +101,30 @@ OBJS += \
 ./src/CommunicateSystem.o \
 ./src/Dasher.o \
 ./src/DecisionData.o \
+./src/DecisionLookahead.o \
 ./src/DecisionTree.o \
+./src/DominanceMap.o \
 ./src/DynamicDebug.o \
 ./src/Evaluation.o \
 ./src/Formation.o \
 ./src/FormationTactics.o \
 ./src/Geometry.o \
+./src/HeadlessServer.o \
 ./src/InfoState.o \
 ./src/InterceptInfo.o \
 ./src/InterceptModel.o \
 ./src/Kicker.o \
 ./src/Logger.o \
+./src/MatchLog.o \
 ./src/Net.o \
 ./src/NetworkTest.o \
 ./src/Observer.o \
 ./src/ParamEngine.o \
 ./src/Parser.o \
+./src/PlannerPool.o \
 ./src/Player.o \
 ./src/PlayerParam.o \
+./src/PlayerSnapshot.o \
 ./src/PlayerState.o \
 ./src/Plotter.o \
 ./src/PositionInfo.o \
@@ -138,6 +152,7 @@ CPP_DEPS += \
 ./src/BehaviorAttack.d \
 ./src/BehaviorBase.d \
 ./src/BehaviorBlock.d \
+./src/BehaviorCandidates.d \
 ./src/BehaviorDefense.d \
 ./src/BehaviorDribble.d \
 ./src/BehaviorFormation.d \
@@ -156,24 +171,30 @@ CPP_DEPS += \
 ./src/CommunicateSystem.d \
 ./src/Dasher.d \
 ./src/DecisionData.d \
+./src/DecisionLookahead.d \
 ./src/DecisionTree.d \
+./src/DominanceMap.d \
 ./src/DynamicDebug.d \
 ./src/Evaluation.d \
 ./src/Formation.d \
 ./src/FormationTactics.d \
 ./src/Geometry.d \
+./src/HeadlessServer.d \
 ./src/InfoState.d \
 ./src/InterceptInfo.d \
 ./src/InterceptModel.d \
 ./src/Kicker.d \
 ./src/Logger.d \
+./src/MatchLog.d \
 ./src/Net.d \
 ./src/NetworkTest.d \
 ./src/Observer.d \
 ./src/ParamEngine.d \
 ./src/Parser.d \
+./src/PlannerPool.d \
 ./src/Player.d \
 ./src/PlayerParam.d \
+./src/PlayerSnapshot.d \
 ./src/PlayerState.d \
 ./src/Plotter.d \
 ./src/PositionInfo.d \
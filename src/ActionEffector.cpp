@@ -1181,14 +1181,17 @@ void ActionEffector::SendCommands(char *msg) {
     ActionEffector::CMD_QUEUE_MUTEX.UnLock();
 
     if (command_msg[0] != '\0') {
-      if (PlayerParam::instance().DynamicDebugMode()) {
+      if (PlayerParam::instance().HeadlessMode()) {
+        // 无头模式，命令由HeadlessServer直接执行
+      } else if (PlayerParam::instance().DynamicDebugMode()) {
         std::cerr << std::endl << command_msg; // 动态调试模式，直接输出命令即可
       } else if (UDPSocket::instance().Send(command_msg) < 0) // 发送命令
       {
         PRINT_ERROR("UDPSocket error!");
       }
     }
-    if (PlayerParam::instance().SaveServerMessage() &&
+    if ((PlayerParam::instance().SaveServerMessage() ||
+         PlayerParam::instance().HeadlessMode()) &&
         msg != 0) //说明要记录命令信息
     {
       strcat(msg, command_msg);
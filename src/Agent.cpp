@@ -40,7 +40,8 @@ Agent::Agent(Unum unum, WorldModel *world_model, bool reverse)
     : mSelfUnum(abs(unum)), mReverse(reverse), mpWorldModel(world_model),
       mpWorldState(&(world_model->World(reverse))),
       mpInfoState(new InfoState(mpWorldState)), mIsNewSight(false),
-      mpStrategy(0), mpAnalyser(0), mpActionEffector(0), mpFormation(0) {}
+      mHasDecisionDeadline(false), mpStrategy(0), mpAnalyser(0),
+      mpActionEffector(0), mpFormation(0) {}
 
 /**
  * Destructor.
@@ -82,6 +83,11 @@ Agent *Agent::CreateOpponentAgent(Unum unum) ///反算对手
   return new Agent(unum, mpWorldModel, !mReverse); // reverse属性相反
 }
 
+bool Agent::IsDecisionTimeOut() const {
+  return mHasDecisionDeadline &&
+         RealTime(GetRealTimeDecision()) > mDecisionDeadline;
+}
+
 void Agent::SaveActiveBehavior(const ActiveBehavior &beh) {
   BehaviorType type = beh.GetType();
 
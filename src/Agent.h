@@ -299,6 +299,18 @@ public:
    */
   bool IsReverse() const { return mReverse; }
 
+  /**
+   * 本周期决策的截止时间，过了截止时间各规划器尽快返回已有的最好结果
+   * Deadline of the current decision; planners return their best-so-far
+   * result once it has passed.
+   */
+  void SetDecisionDeadline(const RealTime &deadline) {
+    mDecisionDeadline = deadline;
+    mHasDecisionDeadline = true;
+  }
+  void ClearDecisionDeadline() { mHasDecisionDeadline = false; }
+  bool IsDecisionTimeOut() const;
+
 private:
   const Unum mSelfUnum; // Agent的号码总是为正
   const bool mReverse;  //标记这个Agent是否反算对手
@@ -314,6 +326,9 @@ private:
   bool mIsNewSight;
   Time mBallSeenTime;
 
+  bool mHasDecisionDeadline;
+  RealTime mDecisionDeadline;
+
   /** 以下变量在第一次使用时生成指向实例，在每次调用时检查是否需要更新 */
   Strategy *mpStrategy;
   Analyser *mpAnalyser;
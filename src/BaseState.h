@@ -265,6 +265,11 @@ public:
 
   void ResetPredictor() { mpPredictor->UpdatePosAndVel(GetPos(), GetVel()); }
 
+  /** 预先推算到最大步数，之后GetPredictedPos/Vel不再写预测表 */
+  void WarmPredictor() const {
+    mpPredictor->GetPredictedPos(Predictor::MAX_STEP);
+  }
+
 public:
   const Vector &GetPredictedPos(int step = 1) const {
     return mpPredictor->GetPredictedPos(step);
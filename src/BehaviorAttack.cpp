@@ -36,6 +36,8 @@
 #include "BehaviorPass.h"
 #include "BehaviorPosition.h"
 #include "BehaviorShoot.h"
+#include "PlannerPool.h"
+#include "TimeTest.h"
 #include "WorldState.h"
 
 BehaviorAttackPlanner::BehaviorAttackPlanner(Agent &agent)
@@ -44,22 +46,40 @@ BehaviorAttackPlanner::BehaviorAttackPlanner(Agent &agent)
 BehaviorAttackPlanner::~BehaviorAttackPlanner() {}
 
 void BehaviorAttackPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorAttackPlanner");
+
   if (mSelfState.IsBallCatchable() && mStrategy.IsLastOppControl() &&
       (!(mAgent.IsLastActiveBehaviorInActOf(BT_Pass) ||
          mAgent.IsLastActiveBehaviorInActOf(BT_Dribble))))
     return;
 
-  BehaviorInterceptPlanner(mAgent).Plan(mActiveBehaviorList);
-  BehaviorShootPlanner(mAgent).Plan(mActiveBehaviorList);
-  BehaviorPassPlanner(mAgent).Plan(mActiveBehaviorList);
-  BehaviorDribblePlanner(mAgent).Plan(mActiveBehaviorList);
-  BehaviorPositionPlanner(mAgent).Plan(mActiveBehaviorList);
-  BehaviorHoldPlanner(mAgent).Plan(mActiveBehaviorList);
+  //超过截止时间后不再运行剩下的规划器，用已有的最好结果
+  if (PlannerPool::instance().IsEnabled()) {
+    PlanParallel();
+  } else {
+    BehaviorInterceptPlanner(mAgent).Plan(mActiveBehaviorList);
+    if (!mAgent.IsDecisionTimeOut())
+      BehaviorShootPlanner(mAgent).Plan(mActiveBehaviorList);
+    if (!mAgent.IsDecisionTimeOut())
+      BehaviorPassPlanner(mAgent).Plan(mActiveBehaviorList);
+    if (!mAgent.IsDecisionTimeOut())
+      BehaviorDribblePlanner(mAgent).Plan(mActiveBehaviorList);
+    if (!mAgent.IsDecisionTimeOut())
+      BehaviorPositionPlanner(mAgent).Plan(mActiveBehaviorList);
+    if (!mAgent.IsDecisionTimeOut())
+      BehaviorHoldPlanner(mAgent).Plan(mActiveBehaviorList);
+  }
 
   if (!mActiveBehaviorList.empty()) {
     mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
     behavior_list.push_back(mActiveBehaviorList.front());
 
+    //多步搜索要重新评价所有候选，不只是最好的一个
+    if (PlayerParam::instance().DecisionSearchDepth() > 1) {
+      behavior_list.insert(behavior_list.end(), ++mActiveBehaviorList.begin(),
+                           mActiveBehaviorList.end());
+    }
+
     if (mActiveBehaviorList.size() > 1) { //允许非最优行为提交视觉请求
       double plus = 1.0;
       ActiveBehaviorPtr it = mActiveBehaviorList.begin();
@@ -70,3 +90,31 @@ void BehaviorAttackPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
     }
   }
 }
+
+/**
+ * 截球、射门、传球、带球、护球互不依赖，放到线程池里并行规划。
+ * 跑位规划要看前面有没有结果，所以合并前四个之后在本线程执行，再接上护球，
+ * 得到的列表和串行时完全一样
+ */
+void BehaviorAttackPlanner::PlanParallel() {
+  PlanTask<BehaviorInterceptPlanner> intercept(mAgent);
+  PlanTask<BehaviorShootPlanner> shoot(mAgent);
+  PlanTask<BehaviorPassPlanner> pass(mAgent);
+  PlanTask<BehaviorDribblePlanner> dribble(mAgent);
+  PlanTask<BehaviorHoldPlanner> hold(mAgent);
+
+  PlannerTask *tasks[] = {&intercept, &shoot, &pass, &dribble, &hold};
+  const int size = sizeof(tasks) / sizeof(tasks[0]);
+
+  PlannerPool::instance().Freeze(mAgent);
+  PlannerPool::instance().Run(mAgent, tasks, size);
+
+  for (int i = 0; i < size - 1; ++i) {
+    mActiveBehaviorList.splice(mActiveBehaviorList.end(),
+                               tasks[i]->GetBehaviorList());
+  }
+  if (!mAgent.IsDecisionTimeOut())
+    BehaviorPositionPlanner(mAgent).Plan(mActiveBehaviorList);
+  mActiveBehaviorList.splice(mActiveBehaviorList.end(),
+                             hold.GetBehaviorList());
+}
@@ -40,6 +40,9 @@ public:
   virtual ~BehaviorAttackPlanner();
 
   void Plan(std::list<ActiveBehavior> &behavior_list);
+
+private:
+  void PlanParallel();
 };
 
 #endif /* BEHAVIORATTACK_H_ */
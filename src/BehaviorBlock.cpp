@@ -38,6 +38,7 @@
 #include "Formation.h"
 #include "Logger.h"
 #include "PositionInfo.h"
+#include "TimeTest.h"
 #include "VisualSystem.h"
 
 const BehaviorType BehaviorBlockExecuter::BEHAVIOR_TYPE = BT_Block;
@@ -66,6 +67,8 @@ BehaviorBlockPlanner::BehaviorBlockPlanner(Agent &agent)
 BehaviorBlockPlanner::~BehaviorBlockPlanner() {}
 
 void BehaviorBlockPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorBlockPlanner");
+
   Unum closest_tm = mPositionInfo.GetClosestTeammateToBall();
   if (mWorldState.GetPlayMode() >= PM_Opp_Corner_Kick &&
       mWorldState.GetPlayMode() <= PM_Opp_Offside_Kick) {
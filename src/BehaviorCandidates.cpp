@@ -0,0 +1,192 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#include "BehaviorCandidates.h"
+#include "Evaluation.h"
+#include "PlayerParam.h"
+#include "PositionInfo.h"
+#include "WorldState.h"
+#include <algorithm>
+
+namespace {
+/**
+ * 堆的比较：a 比 b 好时返回 true，评价相同时先加入的更好
+ */
+class BetterCandidate {
+public:
+  BetterCandidate(const std::vector<double> &evaluation)
+      : mEvaluation(evaluation) {}
+
+  bool operator()(int a, int b) const {
+    return mEvaluation[a] != mEvaluation[b] ? mEvaluation[a] > mEvaluation[b]
+                                            : a < b;
+  }
+
+private:
+  const std::vector<double> &mEvaluation;
+};
+} // namespace
+
+BehaviorCandidates::BehaviorCandidates(const WorldState &world_state,
+                                       PositionInfo &position_info)
+    : mBallPos(world_state.GetBall().GetPos()) {
+  const std::vector<Unum> &opp2ball = position_info.GetCloseOpponentToBall();
+
+  for (unsigned int i = 0; i < opp2ball.size(); ++i) {
+    const PlayerState &opp = world_state.GetOpponent(opp2ball[i]);
+    const Vector rel_pos = opp.GetPos() - mBallPos;
+
+    mOppDist.push_back(rel_pos.Mod());
+    mOppDir.push_back(rel_pos.Dir());
+    mOppPos.push_back(opp.GetPos());
+    mOppConf.push_back(opp.GetPosConf());
+  }
+}
+
+int BehaviorCandidates::Add(const Vector &target, AngleDeg dir,
+                            double kick_speed, double range, int tag) {
+  mTarget.push_back(target);
+  mDir.push_back(dir);
+  mKickSpeed.push_back(kick_speed);
+  mRange.push_back(range);
+  mTag.push_back(tag);
+  mEvaluation.push_back(0.0);
+  mValid.push_back(1);
+  return Size() - 1;
+}
+
+void BehaviorCandidates::FilterOpponentCone(AngleDeg cone) {
+  std::vector<AngleDeg> min_differ(Size(), HUGE_VALUE);
+
+  for (unsigned int j = 0; j < mOppDir.size(); ++j) {
+    for (int i = 0; i < Size(); ++i) {
+      if (mOppDist[j] <= mRange[i]) {
+        const AngleDeg differ = GetAngleDegDiffer(mDir[i], mOppDir[j]);
+        if (differ < min_differ[i]) {
+          min_differ[i] = differ;
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < Size(); ++i) {
+    if (min_differ[i] < cone) {
+      mValid[i] = 0;
+    }
+  }
+}
+
+void BehaviorCandidates::FilterOpponentNearTarget(double factor,
+                                                  double min_conf) {
+  for (unsigned int j = 0; j < mOppPos.size(); ++j) {
+    for (int i = 0; i < Size(); ++i) {
+      if (mOppConf[j] < min_conf ||
+          (mOppPos[j] - mTarget[i]).Mod() < mKickSpeed[i] * factor) {
+        mValid[i] = 0;
+      }
+    }
+  }
+}
+
+void BehaviorCandidates::EvaluateTarget(bool ourside) {
+  std::vector<Vector> pos;
+  std::vector<int> index;
+  for (int i = 0; i < Size(); ++i) {
+    if (mValid[i]) {
+      pos.push_back(mTarget[i]);
+      index.push_back(i);
+    }
+  }
+
+  std::vector<double> evaluation(pos.size());
+  if (!pos.empty()) {
+    Evaluation::instance().EvaluatePosition(pos.size(), &pos[0], ourside,
+                                            &evaluation[0]);
+  }
+  for (unsigned int k = 0; k < index.size(); ++k) {
+    mEvaluation[index[k]] = evaluation[k];
+  }
+}
+
+void BehaviorCandidates::EvaluateCourse(const Vector &origin, int steps,
+                                        bool ourside) {
+  std::vector<Vector> pos;
+  std::vector<int> index;
+  for (int i = 0; i < Size(); ++i) {
+    if (mValid[i]) {
+      for (int s = 1; s <= steps; ++s) {
+        pos.push_back(origin + Polar2Vector(mKickSpeed[i] * s, mDir[i]));
+      }
+      index.push_back(i);
+    }
+  }
+
+  std::vector<double> evaluation(pos.size());
+  if (!pos.empty()) {
+    Evaluation::instance().EvaluatePosition(pos.size(), &pos[0], ourside,
+                                            &evaluation[0]);
+  }
+  for (unsigned int k = 0; k < index.size(); ++k) {
+    double sum = 0;
+    for (int s = 0; s < steps; ++s) {
+      sum += evaluation[k * steps + s];
+    }
+    mEvaluation[index[k]] = sum / steps;
+  }
+}
+
+const std::vector<int> &BehaviorCandidates::SelectTop(int k) {
+  BetterCandidate better(mEvaluation);
+
+  //小顶堆，堆顶是目前保留的候选中最差的一个
+  mTop.clear();
+  for (int i = 0; i < Size(); ++i) {
+    if (!mValid[i]) {
+      continue;
+    }
+    if ((int)mTop.size() < k) {
+      mTop.push_back(i);
+      std::push_heap(mTop.begin(), mTop.end(), better);
+    } else if (k > 0 && mEvaluation[i] > mEvaluation[mTop.front()]) {
+      std::pop_heap(mTop.begin(), mTop.end(), better);
+      mTop.back() = i;
+      std::push_heap(mTop.begin(), mTop.end(), better);
+    }
+  }
+
+  std::sort_heap(mTop.begin(), mTop.end(), better);
+  return mTop;
+}
+
+int BehaviorCandidates::GetPlannerTopK() const {
+  return PlayerParam::instance().DecisionSearchDepth() > 1 ? Size()
+                                                           : DEFAULT_TOP_K;
+}
@@ -0,0 +1,126 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#ifndef __BehaviorCandidates_H__
+#define __BehaviorCandidates_H__
+
+#include "Geometry.h"
+#include <vector>
+
+class WorldState;
+class PositionInfo;
+
+/**
+ * 传球、带球等规划器共用的候选动作打分流程：先把所有候选的目标点、方向和球速
+ * 放进连续数组，再逐遍做对手过滤和位置评价，最后只保留评价最高的前k个
+ * Flat candidate array shared by the pass and dribble planners. Filtering and
+ * evaluation run as whole-array passes and only the top k survive.
+ */
+class BehaviorCandidates {
+public:
+  BehaviorCandidates(const WorldState &world_state, PositionInfo &position_info);
+
+  enum {
+    DEFAULT_TOP_K = 3 /** 规划器默认保留的候选个数 */
+  };
+
+  /**
+   * 加入一个候选
+   * @param target 目标点
+   * @param dir 从球出发的方向，用于对手夹角过滤
+   * @param kick_speed 球速
+   * @param range 夹角过滤时只考虑这个距离以内的对手
+   * @param tag 调用者自己的标记
+   * @return 候选的下标
+   */
+  int Add(const Vector &target, AngleDeg dir, double kick_speed, double range,
+          int tag);
+
+  int Size() const { return (int)mTarget.size(); }
+  const Vector &GetTarget(int i) const { return mTarget[i]; }
+  AngleDeg GetDir(int i) const { return mDir[i]; }
+  double GetKickSpeed(int i) const { return mKickSpeed[i]; }
+  int GetTag(int i) const { return mTag[i]; }
+  double GetEvaluation(int i) const { return mEvaluation[i]; }
+  bool IsValid(int i) const { return mValid[i] != 0; }
+
+  /**
+   * 去掉范围内有对手、且对手与候选方向夹角小于 cone 的候选
+   */
+  void FilterOpponentCone(AngleDeg cone);
+
+  /**
+   * 去掉目标点附近 kick_speed * factor 以内有对手的候选；有对手位置不可信时全部去掉
+   */
+  void FilterOpponentNearTarget(double factor, double min_conf);
+
+  /**
+   * 评价每个候选的目标点
+   */
+  void EvaluateTarget(bool ourside);
+
+  /**
+   * 沿候选方向从 origin 出发，以球速为步长取 steps 个点，评价取平均
+   */
+  void EvaluateCourse(const Vector &origin, int steps, bool ourside);
+
+  /**
+   * 评价最高的前 k 个有效候选，从高到低；评价相同时先加入的在前
+   */
+  const std::vector<int> &SelectTop(int k);
+
+  /**
+   * 规划器交给决策树的候选个数：多步搜索时是全部候选，交给 DecisionLookahead
+   * 重新评价，否则是 DEFAULT_TOP_K
+   */
+  int GetPlannerTopK() const;
+
+private:
+  const Vector mBallPos;
+
+  /** 对手相对于球的距离、方向，以及位置和可信度 */
+  std::vector<double> mOppDist;
+  std::vector<AngleDeg> mOppDir;
+  std::vector<Vector> mOppPos;
+  std::vector<double> mOppConf;
+
+  std::vector<Vector> mTarget;
+  std::vector<AngleDeg> mDir;
+  std::vector<double> mKickSpeed;
+  std::vector<double> mRange;
+  std::vector<int> mTag;
+  std::vector<double> mEvaluation;
+  std::vector<char> mValid;
+
+  std::vector<int> mTop;
+};
+
+#endif
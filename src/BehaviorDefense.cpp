@@ -38,6 +38,8 @@
 #include "Dasher.h"
 #include "Formation.h"
 #include "Logger.h"
+#include "PlannerPool.h"
+#include "TimeTest.h"
 #include "WorldState.h"
 
 BehaviorDefensePlanner::BehaviorDefensePlanner(Agent &agent)
@@ -46,9 +48,18 @@ BehaviorDefensePlanner::BehaviorDefensePlanner(Agent &agent)
 BehaviorDefensePlanner::~BehaviorDefensePlanner() {}
 
 void BehaviorDefensePlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
-  BehaviorFormationPlanner(mAgent).Plan(behavior_list);
-  BehaviorBlockPlanner(mAgent).Plan(behavior_list);
-  BehaviorMarkPlanner(mAgent).Plan(behavior_list);
+  TIMETEST("BehaviorDefensePlanner");
+
+  //阵型总会规划，超过截止时间后不再运行封堵和盯人
+  if (PlannerPool::instance().IsEnabled()) {
+    PlanParallel(behavior_list);
+  } else {
+    BehaviorFormationPlanner(mAgent).Plan(behavior_list);
+    if (!mAgent.IsDecisionTimeOut())
+      BehaviorBlockPlanner(mAgent).Plan(behavior_list);
+    if (!mAgent.IsDecisionTimeOut())
+      BehaviorMarkPlanner(mAgent).Plan(behavior_list);
+  }
 
   if (!mActiveBehaviorList.empty()) {
     mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
@@ -64,3 +75,23 @@ void BehaviorDefensePlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
     }
   }
 }
+
+/**
+ * 阵型、封堵、盯人都只往 behavior_list 里加结果，互不依赖，并行规划后按原顺序合并
+ */
+void BehaviorDefensePlanner::PlanParallel(
+    std::list<ActiveBehavior> &behavior_list) {
+  PlanTask<BehaviorFormationPlanner> formation(mAgent);
+  PlanTask<BehaviorBlockPlanner> block(mAgent);
+  PlanTask<BehaviorMarkPlanner> mark(mAgent);
+
+  PlannerTask *tasks[] = {&formation, &block, &mark};
+  const int size = sizeof(tasks) / sizeof(tasks[0]);
+
+  PlannerPool::instance().Freeze(mAgent);
+  PlannerPool::instance().Run(mAgent, tasks, size);
+
+  for (int i = 0; i < size; ++i) {
+    behavior_list.splice(behavior_list.end(), tasks[i]->GetBehaviorList());
+  }
+}
@@ -42,6 +42,9 @@ public:
   virtual ~BehaviorDefensePlanner();
 
   void Plan(std::list<ActiveBehavior> &behavior_list);
+
+private:
+  void PlanParallel(std::list<ActiveBehavior> &behavior_list);
 };
 
 #endif /* BEHAVIORDEFENSE_H_ */
@@ -31,6 +31,7 @@
 
 #include "BehaviorDribble.h"
 #include "Agent.h"
+#include "BehaviorCandidates.h"
 #include "CommunicateSystem.h"
 #include "Dasher.h"
 #include "Evaluation.h"
@@ -38,6 +39,7 @@
 #include "Kicker.h"
 #include "Logger.h"
 #include "Strategy.h"
+#include "TimeTest.h"
 #include "Types.h"
 #include "Utilities.h"
 #include "VisualSystem.h"
@@ -144,6 +146,8 @@ BehaviorDribblePlanner::BehaviorDribblePlanner(Agent &agent)
 BehaviorDribblePlanner::~BehaviorDribblePlanner(void) {}
 
 void BehaviorDribblePlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorDribblePlanner");
+
   if (!mSelfState.IsKickable())
     return;
   if (mStrategy.IsForbidenDribble())
@@ -151,78 +155,64 @@ void BehaviorDribblePlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
   if (mSelfState.IsGoalie())
     return;
 
-  for (AngleDeg dir = -90.0; dir < 90.0; dir += 2.5) {
-    ActiveBehavior dribble(mAgent, BT_Dribble, BDT_Dribble_Normal);
-
-    dribble.mAngle = dir;
+  const AngleDeg angle_step = PlayerParam::instance().DribbleAngleStep();
+  const int angle_num = (int)ceil(180.0 / angle_step - FLOAT_EPS);
 
-    const std::vector<Unum> &opp2ball = mPositionInfo.GetCloseOpponentToBall();
-    AngleDeg min_differ = HUGE_VALUE;
+  // 普通带球：带球跑向身前一步，方向上 15 米内不能有对手
+  BehaviorCandidates normal(mWorldState, mPositionInfo);
+  for (int i = 0; i < angle_num; ++i) {
+    const AngleDeg dir = -90.0 + i * angle_step;
+    normal.Add(mSelfState.GetPos() +
+                   Polar2Vector(mSelfState.GetEffectiveSpeedMax(), dir),
+               dir, 0.0, 15.0, BDT_Dribble_Normal);
+  }
+  normal.FilterOpponentCone(10.0);
+  normal.EvaluateTarget(true);
 
-    for (uint j = 0; j < opp2ball.size(); ++j) {
-      Vector rel_pos =
-          mWorldState.GetOpponent(opp2ball[j]).GetPos() - mBallState.GetPos();
-      if (rel_pos.Mod() > 15.0)
-        continue;
+  // 快速带球：把球踢出 10 个周期的距离，目标点附近不能有对手
+  double speed = mSelfState.GetEffectiveSpeedMax();
 
-      AngleDeg differ = GetAngleDegDiffer(dir, rel_pos.Dir());
-      if (differ < min_differ) {
-        min_differ = differ;
-      }
+  BehaviorCandidates fast(mWorldState, mPositionInfo);
+  for (int i = 0; i < angle_num; ++i) {
+    const AngleDeg dir = -90.0 + i * angle_step;
+    Vector target = mBallState.GetPos() + Polar2Vector(speed * 10, dir);
+    if (ServerParam::instance().pitchRectanglar().IsWithin(target)) {
+      fast.Add(target, dir, speed, 0.0, BDT_Dribble_Fast);
     }
+  }
+  fast.FilterOpponentNearTarget(12.0, PlayerParam::instance().minValidConf());
+  fast.EvaluateCourse(mBallState.GetPos(), 8, true);
 
-    if (min_differ < 10.0)
-      continue;
-
-    dribble.mTarget = mSelfState.GetPos() +
-                      Polar2Vector(mSelfState.GetEffectiveSpeedMax(), dir);
-
-    dribble.mEvaluation =
-        Evaluation::instance().EvaluatePosition(dribble.mTarget, true);
-
+  //两类候选分别取前k个，普通带球在前，合并后保持评价相同时先加入的在前
+  const std::vector<int> &normal_top =
+      normal.SelectTop(normal.GetPlannerTopK());
+  for (unsigned int i = 0; i < normal_top.size(); ++i) {
+    ActiveBehavior dribble(mAgent, BT_Dribble, BDT_Dribble_Normal);
+    dribble.mAngle = normal.GetDir(normal_top[i]);
+    dribble.mTarget = normal.GetTarget(normal_top[i]);
+    dribble.mEvaluation = normal.GetEvaluation(normal_top[i]);
     mActiveBehaviorList.push_back(dribble);
   }
-  double speed = mSelfState.GetEffectiveSpeedMax();
 
-  for (AngleDeg dir = -90.0; dir < 90.0; dir += 2.5) {
+  const std::vector<int> &fast_top =
+      fast.SelectTop(fast.GetPlannerTopK());
+  for (unsigned int i = 0; i < fast_top.size(); ++i) {
     ActiveBehavior dribble(mAgent, BT_Dribble, BDT_Dribble_Fast);
-    dribble.mKickSpeed = speed;
-    dribble.mAngle = dir;
-
-    const std::vector<Unum> &opp2ball = mPositionInfo.GetCloseOpponentToBall();
-    Vector target = mBallState.GetPos() +
-                    Polar2Vector(dribble.mKickSpeed * 10, dribble.mAngle);
-    if (!ServerParam::instance().pitchRectanglar().IsWithin(target)) {
-      continue;
-    }
-    bool ok = true;
-    for (uint j = 0; j < opp2ball.size(); ++j) {
-      Vector rel_pos = mWorldState.GetOpponent(opp2ball[j]).GetPos() - target;
-      if (rel_pos.Mod() < dribble.mKickSpeed * 12 ||
-          mWorldState.GetOpponent(opp2ball[j]).GetPosConf() <
-              PlayerParam::instance().minValidConf()) {
-        ok = false;
-        break;
-      }
-    }
-    if (!ok) {
-      continue;
-    }
-    dribble.mEvaluation = 0;
-    for (int i = 1; i <= 8; ++i) {
-      dribble.mEvaluation += Evaluation::instance().EvaluatePosition(
-          mBallState.GetPos() +
-              Polar2Vector(dribble.mKickSpeed * i, dribble.mAngle),
-          true);
-    }
-    dribble.mEvaluation /= 8;
-    dribble.mTarget = target;
-
+    dribble.mKickSpeed = fast.GetKickSpeed(fast_top[i]);
+    dribble.mAngle = fast.GetDir(fast_top[i]);
+    dribble.mTarget = fast.GetTarget(fast_top[i]);
+    dribble.mEvaluation = fast.GetEvaluation(fast_top[i]);
     mActiveBehaviorList.push_back(dribble);
   }
 
   if (!mActiveBehaviorList.empty()) {
     mActiveBehaviorList.sort(std::greater<ActiveBehavior>());
     behavior_list.push_back(mActiveBehaviorList.front());
+
+    //多步搜索要重新评价所有候选，不只是最好的一个
+    if (PlayerParam::instance().DecisionSearchDepth() > 1) {
+      behavior_list.insert(behavior_list.end(), ++mActiveBehaviorList.begin(),
+                           mActiveBehaviorList.end());
+    }
   }
 }
@@ -38,6 +38,7 @@
 #include "Formation.h"
 #include "Logger.h"
 #include "PositionInfo.h"
+#include "TimeTest.h"
 #include "VisualSystem.h"
 #include <cstdlib>
 
@@ -68,6 +69,8 @@ BehaviorFormationPlanner::BehaviorFormationPlanner(Agent &agent)
 BehaviorFormationPlanner::~BehaviorFormationPlanner() {}
 
 void BehaviorFormationPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorFormationPlanner");
+
   ActiveBehavior formation(mAgent, BT_Formation);
 
   formation.mBuffer = 1.0;
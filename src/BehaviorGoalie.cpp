@@ -68,6 +68,8 @@ BehaviorGoalieExecuter::BehaviorGoalieExecuter(Agent &agent)
 BehaviorGoalieExecuter::~BehaviorGoalieExecuter(void) {}
 
 void BehaviorGoaliePlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorGoaliePlanner");
+
   if (mAgent.IsLastActiveBehaviorInActOf(BT_Pass) ||
       mAgent.IsLastActiveBehaviorInActOf(BT_Dribble))
     return;
@@ -30,6 +30,7 @@
 #include "Kicker.h"
 #include "Logger.h"
 #include "Strategy.h"
+#include "TimeTest.h"
 #include "Types.h"
 #include "Utilities.h"
 #include "VisualSystem.h"
@@ -72,6 +73,8 @@ BehaviorHoldPlanner::BehaviorHoldPlanner(Agent &agent)
 BehaviorHoldPlanner::~BehaviorHoldPlanner(void) {}
 
 void BehaviorHoldPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorHoldPlanner");
+
   if (!mSelfState.IsKickable())
     return;
   if (mSelfState.IsGoalie())
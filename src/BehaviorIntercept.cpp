@@ -39,6 +39,7 @@
 #include "InterceptInfo.h"
 #include "Logger.h"
 #include "Strategy.h"
+#include "TimeTest.h"
 #include "VisualSystem.h"
 #include <sstream>
 
@@ -69,6 +70,8 @@ BehaviorInterceptPlanner::BehaviorInterceptPlanner(Agent &agent)
 BehaviorInterceptPlanner::~BehaviorInterceptPlanner() {}
 
 void BehaviorInterceptPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorInterceptPlanner");
+
   if (mSelfState.IsKickable())
     return;
   PlayMode play_mode = mWorldState.GetPlayMode();
@@ -38,6 +38,7 @@
 #include "Formation.h"
 #include "Logger.h"
 #include "PositionInfo.h"
+#include "TimeTest.h"
 #include "VisualSystem.h"
 
 const BehaviorType BehaviorMarkExecuter::BEHAVIOR_TYPE = BT_Mark;
@@ -66,6 +67,8 @@ BehaviorMarkPlanner::BehaviorMarkPlanner(Agent &agent)
 BehaviorMarkPlanner::~BehaviorMarkPlanner() {}
 
 void BehaviorMarkPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorMarkPlanner");
+
   Unum closest_opp =
       mPositionInfo.GetClosestOpponentToTeammate(mSelfState.GetUnum());
   Unum closest_tm = mPositionInfo.GetClosestTeammateToOpponent(closest_opp);
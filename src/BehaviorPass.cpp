@@ -31,6 +31,7 @@
 
 #include "BehaviorPass.h"
 #include "Agent.h"
+#include "BehaviorCandidates.h"
 #include "CommunicateSystem.h"
 #include "Dasher.h"
 #include "Evaluation.h"
@@ -88,6 +89,8 @@ BehaviorPassPlanner::BehaviorPassPlanner(Agent &agent)
 BehaviorPassPlanner::~BehaviorPassPlanner(void) {}
 
 void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorPassPlanner");
+
   if (!mSelfState.IsKickable())
     return;
 
@@ -100,36 +103,28 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
 
   PlayerState oppState = mWorldState.GetOpponent(_opp);
   bool oppClose = oppState.IsKickable() || oppState.GetTackleProb(true) > 0.65;
+  //传球路线上（队友距离加 3 米以内）不能有对手
+  BehaviorCandidates candidates(mWorldState, mPositionInfo);
   for (uint i = 0; i < tm2ball.size(); ++i) {
-    ActiveBehavior pass(mAgent, BT_Pass);
-
-    pass.mTarget = mWorldState.GetTeammate(tm2ball[i]).GetPredictedPos();
-
     if (mWorldState.GetTeammate(tm2ball[i]).IsGoalie()) {
       continue;
     }
-    Vector rel_target = pass.mTarget - mBallState.GetPos();
-    const std::vector<Unum> &opp2tm =
-        mPositionInfo.GetCloseOpponentToTeammate(tm2ball[i]);
-    AngleDeg min_differ = HUGE_VALUE;
-
-    for (uint j = 0; j < opp2tm.size(); ++j) {
-      Vector rel_pos =
-          mWorldState.GetOpponent(opp2tm[j]).GetPos() - mBallState.GetPos();
-      if (rel_pos.Mod() > rel_target.Mod() + 3.0)
-        continue;
-
-      AngleDeg differ = GetAngleDegDiffer(rel_target.Dir(), rel_pos.Dir());
-      if (differ < min_differ) {
-        min_differ = differ;
-      }
-    }
+    Vector target = mWorldState.GetTeammate(tm2ball[i]).GetPredictedPos();
+    Vector rel_target = target - mBallState.GetPos();
+    candidates.Add(target, rel_target.Dir(), 0.0, rel_target.Mod() + 3.0,
+                   tm2ball[i]);
+  }
+  candidates.FilterOpponentCone(10.0);
+  candidates.EvaluateTarget(true);
 
-    if (min_differ < 10.0)
-      continue;
+  //只为保留的候选计算出球角度和球速，多步搜索时保留全部候选
+  const std::vector<int> &top =
+      candidates.SelectTop(candidates.GetPlannerTopK());
+  for (uint i = 0; i < top.size(); ++i) {
+    ActiveBehavior pass(mAgent, BT_Pass);
 
-    pass.mEvaluation =
-        Evaluation::instance().EvaluatePosition(pass.mTarget, true);
+    pass.mTarget = candidates.GetTarget(top[i]);
+    pass.mEvaluation = candidates.GetEvaluation(top[i]);
 
     pass.mAngle = (pass.mTarget - mSelfState.GetPos()).Dir();
     pass.mKickSpeed = ServerParam::instance().GetBallSpeed(
@@ -149,6 +144,12 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
       mActiveBehaviorList.front().mEvaluation = 1.0 + FLOAT_EPS;
     }
     behavior_list.push_back(mActiveBehaviorList.front());
+
+    //多步搜索要重新评价所有候选，不只是最好的一个
+    if (PlayerParam::instance().DecisionSearchDepth() > 1) {
+      behavior_list.insert(behavior_list.end(), ++mActiveBehaviorList.begin(),
+                           mActiveBehaviorList.end());
+    }
   } else { //如果此周期没有好的动作
     if (mAgent.IsLastActiveBehaviorInActOf(BT_Pass)) {
       ActiveBehavior pass(mAgent, BT_Pass, BDT_Pass_Direct);
@@ -163,56 +164,70 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
     }
     if (oppClose) {
       Vector p;
-      BallState SimBall = mBallState;
-      int MinTmInter = HUGE_VALUE, MinOppInter = HUGE_VALUE, MinTm;
-      Vector MinTmPos;
-      for (AngleDeg dir = -45; dir <= 45; dir += 2.5) {
+      BallState SimBall = mBallState; //每个方向的球轨迹由它的预测缓存，所有球员共用
+      const std::vector<Unum> &opp2ball =
+          mPositionInfo.GetCloseOpponentToBall();
+
+      //截球用的临时数据，不改动 InterceptInfo 中针对真实球的结果
+      PlayerInterceptInfo tm_info[TEAMSIZE], opp_info[TEAMSIZE];
+      PlayerInterceptInfo *teammates[TEAMSIZE], *opponents[TEAMSIZE];
+
+      const AngleDeg fan = PlayerParam::instance().PassClearFanAngle();
+      const AngleDeg step = PlayerParam::instance().PassClearAngleStep();
+      int dir_num = (int)floor(2.0 * fan / step + FLOAT_EPS) + 1;
+      if (fan >= 180.0 - FLOAT_EPS) {
+        dir_num = (int)ceil(360.0 / step - FLOAT_EPS); //整圈时不重复首尾方向
+      }
+
+      for (int k = 0; k < dir_num && !mAgent.IsDecisionTimeOut(); ++k) {
+        const AngleDeg dir = -fan + k * step;
+        const AngleDeg kick_dir = mSelfState.GetBodyDir() + dir;
         if (!Tackler::instance().CanTackleToDir(mAgent, dir)) {
           SimBall.UpdateVel(
-              Polar2Vector(Kicker::instance().GetMaxSpeed(
-                               mAgent, mSelfState.GetBodyDir() + dir, 1),
-                           mSelfState.GetBodyDir() + dir),
+              Polar2Vector(Kicker::instance().GetMaxSpeed(mAgent, kick_dir, 1),
+                           kick_dir),
               0, 1.0);
         } else
           SimBall.UpdateVel(
-              Polar2Vector(Max(Tackler::instance()
-                                   .GetBallVelAfterTackle(mAgent, dir)
-                                   .Mod(),
-                               Kicker::instance().GetMaxSpeed(
-                                   mAgent, mSelfState.GetBodyDir() + dir, 1)),
-                           mSelfState.GetBodyDir() + dir),
+              Polar2Vector(
+                  Max(Tackler::instance()
+                          .GetBallVelAfterTackle(mAgent, dir)
+                          .Mod(),
+                      Kicker::instance().GetMaxSpeed(mAgent, kick_dir, 1)),
+                  kick_dir),
               0, 1.0);
-        for (int i = 2; i <= 11; i++) {
-          if (fabs((mWorldState.GetTeammate(i).GetPos() - mSelfState.GetPos())
-                       .Dir() -
-                   dir) > 45) {
-            continue;
-          }
-          if (!mWorldState.GetPlayer(i).IsAlive()) {
+
+        //只考虑出球方向两侧 45 度以内的球员
+        int tm_size = 0;
+        for (int i = 2; i <= TEAMSIZE; i++) {
+          const PlayerState &tm = mWorldState.GetTeammate(i);
+          if (!tm.IsAlive() ||
+              GetAngleDegDiffer((tm.GetPos() - mSelfState.GetPos()).Dir(),
+                                kick_dir) > 45) {
             continue;
           }
-          PlayerInterceptInfo *a = mInterceptInfo.GetPlayerInterceptInfo(i);
-          mInterceptInfo.CalcTightInterception(SimBall, a, true);
-          if (MinTmInter > (*a).mMinCycle) {
-            MinTm = i;
-            MinTmInter = (*a).mMinCycle;
-            MinTmPos = (*a).mInterPos;
-          }
+          tm_info[tm_size].mpPlayer = &tm;
+          teammates[tm_size] = &tm_info[tm_size];
+          ++tm_size;
         }
-        for (int i = 1; i <= 11; i++) {
-          if (fabs((mWorldState.GetOpponent(i).GetPos() - mSelfState.GetPos())
-                       .Dir() -
-                   dir) > 45) {
+
+        //对手按离球由近到远求解，最先可能抢到球的先算
+        int opp_size = 0;
+        for (uint i = 0; i < opp2ball.size(); i++) {
+          const PlayerState &opp = mWorldState.GetOpponent(opp2ball[i]);
+          if (GetAngleDegDiffer((opp.GetPos() - mSelfState.GetPos()).Dir(),
+                                kick_dir) > 45) {
             continue;
           }
-          PlayerInterceptInfo *a = mInterceptInfo.GetPlayerInterceptInfo(-i);
-          mInterceptInfo.CalcTightInterception(SimBall, a, true);
-          if (MinOppInter > (*a).mMinCycle) {
-            MinOppInter = (*a).mMinCycle;
-          }
+          opp_info[opp_size].mpPlayer = &opp;
+          opponents[opp_size] = &opp_info[opp_size];
+          ++opp_size;
         }
-        if (MinOppInter > MinTmInter) {
-          Ray a(mSelfState.GetPos(), mSelfState.GetBodyDir() + dir);
+
+        PlayerInterceptInfo *best = InterceptInfo::CalcInterceptRace(
+            SimBall, teammates, tm_size, opponents, opp_size, true);
+        if (best) {
+          Ray a(mSelfState.GetPos(), kick_dir);
           Line c(ServerParam::instance().ourLeftGoalPost(),
                  ServerParam::instance().ourRightGoalPost());
           c.Intersection(a, p);
@@ -220,9 +235,9 @@ void BehaviorPassPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
               p.Y() > ServerParam::instance().ourPenaltyArea().Bottom()) {
 
             ActiveBehavior pass(mAgent, BT_Pass, BDT_Pass_Clear);
-            pass.mTarget = MinTmPos;
+            pass.mTarget = best->mInterPos;
             pass.mEvaluation = 1.0 + FLOAT_EPS;
-            pass.mAngle = mSelfState.GetBodyDir() + dir;
+            pass.mAngle = kick_dir;
             mActiveBehaviorList.push_back(pass);
           }
         }
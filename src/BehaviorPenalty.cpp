@@ -37,6 +37,7 @@
 #include "BehaviorShoot.h"
 #include "Dasher.h"
 #include "Kicker.h"
+#include "TimeTest.h"
 #include "VisualSystem.h"
 #include "WorldState.h"
 
@@ -113,6 +114,8 @@ BehaviorPenaltyPlanner::~BehaviorPenaltyPlanner() {}
 
 //==============================================================================
 void BehaviorPenaltyPlanner::Plan(std::list<ActiveBehavior> &behaviorlist) {
+  TIMETEST("BehaviorPenaltyPlanner");
+
   ActiveBehavior penaltyKO(mAgent, BT_Penalty);
 
   if (mSelfState.IsGoalie()) {
@@ -202,6 +205,7 @@ void BehaviorPenaltyPlanner::Plan(std::list<ActiveBehavior> &behaviorlist) {
     penaltyKO.mEvaluation = 1.0;
     behaviorlist.push_back(penaltyKO);
   } else if (penaltyKO.mDetailType == BDT_Setplay_GetBall) {
+    //超过截止时间后不再运行剩下的规划器，守门员的扑球和下面的默认行为总会有
     if (mSelfState.IsGoalie()) {
       BehaviorInterceptPlanner(mAgent).Plan(behaviorlist);
       if (behaviorlist.empty() || mSelfState.IsBallCatchable())
@@ -209,8 +213,10 @@ void BehaviorPenaltyPlanner::Plan(std::list<ActiveBehavior> &behaviorlist) {
     } else if (mStrategy.IsMyPenaltyTaken() == true) {
       // 先算dribble，shoot中根据dribble的情况来决策
       BehaviorDribblePlanner(mAgent).Plan(behaviorlist);
-      BehaviorShootPlanner(mAgent).Plan(behaviorlist);
-      BehaviorInterceptPlanner(mAgent).Plan(behaviorlist);
+      if (!mAgent.IsDecisionTimeOut())
+        BehaviorShootPlanner(mAgent).Plan(behaviorlist);
+      if (!mAgent.IsDecisionTimeOut())
+        BehaviorInterceptPlanner(mAgent).Plan(behaviorlist);
     }
 
     if (behaviorlist.empty()) {
@@ -70,6 +70,8 @@ BehaviorPositionPlanner::BehaviorPositionPlanner(Agent &agent)
     : BehaviorPlannerBase<BehaviorAttackData>(agent) {}
 
 void BehaviorPositionPlanner::Plan(ActiveBehaviorList &behavior_list) {
+  TIMETEST("BehaviorPositionPlanner");
+
   if (!behavior_list.empty())
     return;
 
@@ -39,6 +39,7 @@
 #include "Geometry.h"
 #include "Kicker.h"
 #include "ServerParam.h"
+#include "TimeTest.h"
 #include "Utilities.h"
 #include "VisualSystem.h"
 #include <algorithm>
@@ -90,6 +91,8 @@ BehaviorSetplayPlanner::BehaviorSetplayPlanner(Agent &agent)
 BehaviorSetplayPlanner::~BehaviorSetplayPlanner(void) {}
 
 void BehaviorSetplayPlanner::Plan(std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorSetplayPlanner");
+
   ActiveBehavior setplay(mAgent, BT_Setplay);
 
   setplay.mBuffer = 0.5;
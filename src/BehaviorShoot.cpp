@@ -100,6 +100,8 @@ BehaviorShootPlanner::~BehaviorShootPlanner() {}
  * None or one ActiveBehavior will be push back to behavior_list.
  */
 void BehaviorShootPlanner::Plan(list<ActiveBehavior> &behavior_list) {
+  TIMETEST("BehaviorShootPlanner");
+
   if (!mSelfState.IsKickable())
     return;
 
@@ -36,6 +36,7 @@
 #include "Dasher.h"
 #include "DynamicDebug.h"
 #include "Formation.h"
+#include "HeadlessServer.h"
 #include "InterceptModel.h"
 #include "Kicker.h"
 #include "Logger.h"
@@ -143,6 +144,65 @@ void Client::RunDynamicDebug() {
   }
 }
 
+void Client::RunHeadless() {
+  static char msg[MAX_MESSAGE];
+
+  if (PlayerParam::instance().isCoach() ||
+      PlayerParam::instance().isTrainer()) {
+    PRINT_ERROR("headless mode is only for players");
+    return;
+  }
+
+  srand(PlayerParam::instance().HeadlessSeed()); // 固定随机种子，结果可重复
+  srand48(PlayerParam::instance().HeadlessSeed());
+
+  HeadlessServer server(PlayerParam::instance().HeadlessUnum());
+
+  server.MakeInitMsg(msg);
+  mpParser->ParseInitializeMsg(msg);
+
+  ConstructAgent();
+
+  const int cycles = PlayerParam::instance().HeadlessCycles();
+  long decision_sum = 0; // 微秒
+  long decision_max = 0;
+
+  RealTime begin = GetRealTime();
+
+  for (int i = 0; i < cycles; ++i) {
+    mpObserver->Reset();
+    server.MakeSenseBodyMsg(msg);
+    mpParser->Parse(msg);
+    server.MakeFullstateMsg(msg);
+    mpParser->Parse(msg);
+
+    RealTime decision_begin = GetRealTime();
+    Run();
+    const long decision_cost = RealTime(GetRealTime()).Sub(decision_begin);
+    decision_sum += decision_cost;
+    decision_max = Max(decision_max, decision_cost);
+
+    Logger::instance().Flush(); // flush log
+    mpObserver->SetPlanned();
+
+    msg[0] = '\0';
+    mpCommandSender->Run(msg);
+    server.ExecuteCommands(msg);
+    server.Step();
+  }
+
+  const double wall_time = RealTime(GetRealTime()).Sub(begin) / 1000000.0;
+
+  std::cout << "WrightEagle headless: " << cycles << " cycles in " << wall_time
+            << " s (" << (wall_time > 0.0 ? cycles / wall_time : 0.0)
+            << " cycles/s), decision avg "
+            << (cycles > 0 ? decision_sum / 1000.0 / cycles : 0.0)
+            << " ms, max " << decision_max / 1000.0 << " ms, score "
+            << server.OurScore() << ":" << server.OppScore()
+            << ", reverse world used " << mpWorldModel->GetReverseCount()
+            << "/" << mpWorldModel->GetUpdateCount() << std::endl;
+}
+
 void Client::RunNormal() {
 
   mpCommandSender->Start();   //发送命令线程，向server发送信息
@@ -59,6 +59,11 @@ public:
    */
   void RunDynamicDebug();
 
+  /**
+   * 离线无头模式入口函数，在进程内用HeadlessServer模拟比赛，统计决策耗时
+   */
+  void RunHeadless();
+
   /**
    * 正常比赛时的球员入口函数
    */
@@ -35,6 +35,7 @@
 #include "Logger.h"
 #include "PlayerParam.h"
 #include "ServerParam.h"
+#include "TimeTest.h"
 #include "WorldState.h"
 #include <algorithm>
 #include <cmath>
@@ -46,19 +47,34 @@ const unsigned char *CommunicateSystem::CODE =
     (const unsigned char *)"uMKJNPpA1Yh0)f6_x3WU<>SgQ4wbDizV5dc9t2XZ?(/"
                            "7*s.FEHvLG8yRTkej-OlB+armnoqCI";
 
-int CommunicateSystem::CODE_TO_INT[128];
+int CommunicateSystem::CODE_TO_INT[256];
 const int CommunicateSystem::CODE_SIZE = 73;
 const int CommunicateSystem::MAX_MSG_SIZE = 10;
 int CommunicateSystem::MAX_BITS_USED = 61;
 
+namespace {
+const double SAY_MAX_ERROR = 10.0;       //队友认知误差的上限
+const double SAY_ERROR_PER_CYCLE = 0.2;  //说过之后每周期增加的误差
+const double SAY_VEL_HORIZON = 5.0;      //球速误差折算成几周期后的位置误差
+const double SAY_BALL_RELEVANCE = 2.0;   //球相对球员的重要程度
+const double SAY_RELEVANCE_DIST = 20.0;  //球员离球越远越不重要
+
+struct SayOption {
+  int mGroup; //同一组至多选一个
+  CommunicateSystem::FreeFormType mType;
+  Unum mNum;
+  int mBits;
+  double mUtility;
+};
+} // namespace
+
 CommunicateSystem::CommunicateSystem() {
   memset(CODE_TO_INT, 0, sizeof(CODE_TO_INT));
   for (int i = 0; i < CODE_SIZE; ++i) {
     CODE_TO_INT[CODE[i]] = i;
   }
 
-  memset(mCodecBitCount, 0, sizeof(mCodecBitCount));
-  memset(mCodecMask, 0, sizeof(mCodecMask));
+  memset(mCodec, 0, sizeof(mCodec));
 
   mCommuFlagBitCount =
       static_cast<int>(ceil(log(static_cast<double>(COMMU_MAX)) / log(2.0)));
@@ -75,42 +91,41 @@ CommunicateSystem::CommunicateSystem() {
   mTacticsBitCount = 5;
   mTacticsFlagMask = (1 << mTacticsBitCount) - 1;
 
-  mCodecBitCount[FREE_FORM][POS_X] =
+  mCodec[FREE_FORM][POS_X].mBitCount =
       BitCountOfEps(PlayerParam::instance().sayPosXEps(), POS_X);
-  mCodecMask[FREE_FORM][POS_X] = (1 << mCodecBitCount[FREE_FORM][POS_X]) - 1;
-  mCodecBitCount[FREE_FORM][POS_Y] =
+  mCodec[FREE_FORM][POS_Y].mBitCount =
       BitCountOfEps(PlayerParam::instance().sayPosYEps(), POS_Y);
-  mCodecMask[FREE_FORM][POS_Y] = (1 << mCodecBitCount[FREE_FORM][POS_Y]) - 1;
-  mCodecBitCount[FREE_FORM][BALL_SPEED] =
+  mCodec[FREE_FORM][BALL_SPEED].mBitCount =
       BitCountOfEps(PlayerParam::instance().sayBallSpeedEps(), BALL_SPEED);
-  mCodecMask[FREE_FORM][BALL_SPEED] =
-      (1 << mCodecBitCount[FREE_FORM][BALL_SPEED]) - 1;
-  mCodecBitCount[FREE_FORM][PLAYER_SPEED] =
+  mCodec[FREE_FORM][PLAYER_SPEED].mBitCount =
       BitCountOfEps(PlayerParam::instance().sayPlayerSpeedEps(), BALL_SPEED);
-  mCodecMask[FREE_FORM][PLAYER_SPEED] =
-      (1 << mCodecBitCount[FREE_FORM][PLAYER_SPEED]) - 1;
-  mCodecBitCount[FREE_FORM][DIR] =
+  mCodec[FREE_FORM][DIR].mBitCount =
       BitCountOfEps(PlayerParam::instance().sayDirEps(), DIR);
-  mCodecMask[FREE_FORM][DIR] = (1 << mCodecBitCount[FREE_FORM][DIR]) - 1;
 
+  for (int i = 0; i < COMMU_MAX; ++i) {
+    for (int j = 0; j < CODEC_MAX; ++j) {
+      mCodec[i][j].mMask = (1 << mCodec[i][j].mBitCount) - 1;
+    }
+  }
+  UpdateCodecs();
+  SetCommunicateType(FREE_FORM);
+
+  const int pos_bit_count =
+      mCodec[FREE_FORM][POS_X].mBitCount + mCodec[FREE_FORM][POS_Y].mBitCount;
   mFreeFormCodecBitCount[BALL_WITH_SPEED] =
-      mCodecBitCount[FREE_FORM][POS_X] + mCodecBitCount[FREE_FORM][POS_Y] +
-      mCodecBitCount[FREE_FORM][BALL_SPEED] + mCodecBitCount[FREE_FORM][DIR] +
-      mFreeFormFlagBitCount;
+      pos_bit_count + mCodec[FREE_FORM][BALL_SPEED].mBitCount +
+      mCodec[FREE_FORM][DIR].mBitCount + mFreeFormFlagBitCount;
   mFreeFormCodecBitCount[BALL_WITH_ZERO_SPEED] =
-      mCodecBitCount[FREE_FORM][POS_X] + mCodecBitCount[FREE_FORM][POS_Y] +
-      mFreeFormFlagBitCount;
-  mFreeFormCodecBitCount[BALL_ONLY_POS] = mCodecBitCount[FREE_FORM][POS_X] +
-                                          mCodecBitCount[FREE_FORM][POS_Y] +
-                                          mFreeFormFlagBitCount;
-  mFreeFormCodecBitCount[TEAMMATE_ONLY_POS] = mCodecBitCount[FREE_FORM][POS_X] +
-                                              mCodecBitCount[FREE_FORM][POS_Y] +
-                                              mFreeFormFlagBitCount;
-  mFreeFormCodecBitCount[OPPONENT_ONLY_POS] = mCodecBitCount[FREE_FORM][POS_X] +
-                                              mCodecBitCount[FREE_FORM][POS_Y] +
-                                              mFreeFormFlagBitCount;
+      pos_bit_count + mFreeFormFlagBitCount;
+  mFreeFormCodecBitCount[BALL_ONLY_POS] = pos_bit_count + mFreeFormFlagBitCount;
+  mFreeFormCodecBitCount[TEAMMATE_ONLY_POS] =
+      pos_bit_count + mFreeFormFlagBitCount;
+  mFreeFormCodecBitCount[OPPONENT_ONLY_POS] =
+      pos_bit_count + mFreeFormFlagBitCount;
 
   MAX_BITS_USED -= mCommuFlagBitCount; //这个是一定要用的位
+
+  mToldBallVelValid = false;
 }
 
 CommunicateSystem::~CommunicateSystem() {}
@@ -123,6 +138,10 @@ CommunicateSystem &CommunicateSystem::instance() {
 void CommunicateSystem::Initial(Observer *observer, Agent *agent) {
   mpObserver = observer;
   mpAgent = agent;
+
+  if (PlayerParam::instance().sayCodecCheck()) {
+    CheckCodecs();
+  }
 }
 
 int CommunicateSystem::BitCountOfEps(double eps, CodecType type) {
@@ -162,61 +181,155 @@ void CommunicateSystem::GetCodecRange(CodecType type, double &min,
   }
 }
 
+void CommunicateSystem::UpdateCodecs() {
+  for (int i = 0; i < COMMU_MAX; ++i) {
+    for (int j = 0; j < CODEC_MAX; ++j) {
+      Codec &codec = mCodec[i][j];
+      double min = 0.0, max = 1.0;
+      GetCodecRange(static_cast<CodecType>(j), min, max);
+
+      codec.mMin = min;
+      codec.mMax = max;
+      codec.mSpan = max - min;
+      codec.mRange = static_cast<double>(static_cast<int>(codec.mMask));
+      codec.mStep = codec.mSpan / Max(codec.mRange, 1.0);
+      codec.mClampLow = min + 0.001 * min;
+      codec.mClampHigh = max - 0.001 * max;
+    }
+  }
+}
+
 CommunicateSystem::DWORD64
 CommunicateSystem::DoubleToBit(double value,
                                CommunicateSystem::CodecType type) {
-  int range = static_cast<int>((*mpCodecMask)[type]); // [0, range]
+  const Codec &codec = mpCodec[type]; // [0, range]
 
-  double min = 0.0, max = 1.0;
-  GetCodecRange(type, min, max);
+  value = value > codec.mMax ? codec.mClampHigh : value;
+  value = value < codec.mMin ? codec.mClampLow : value;
 
-  if (value > max) {
-    value = max - 0.001 * max;
-  } else if (value < min) {
-    value = min + 0.001 * min;
-  }
-
-  return static_cast<DWORD64>(
-      ((value - min) / (max - min) * static_cast<double>(range)));
+  return static_cast<DWORD64>((value - codec.mMin) / codec.mSpan *
+                              codec.mRange);
 }
 
 double CommunicateSystem::BitToDouble(DWORD64 bits,
                                       CommunicateSystem::CodecType type) {
-  int range = static_cast<int>((*mpCodecMask)[type]); // [0, range]
-  DWORD64 mask = (*mpCodecMask)[type];
+  const Codec &codec = mpCodec[type];
 
-  double min = 0.0, max = 1.0;
-  GetCodecRange(type, min, max);
-
-  return static_cast<double>(bits & mask) / static_cast<double>(range) *
-             (max - min) +
-         min;
+  return static_cast<double>(bits & codec.mMask) / codec.mRange *
+             codec.mSpan +
+         codec.mMin;
 }
 
+/**
+ * 73^5 < 2^31，先把 bits 拆成高低两段，每段用 32 位的常数除法（编译器会换成乘法）
+ * 取出 5 位；消息长度为最高非零位，不用按位判断循环结束
+ */
 void CommunicateSystem::Encode(DWORD64 bits, unsigned char *msg,
                                bool is_coach) {
-  int i = 0, rem;
+  static const unsigned HALF_SIZE = 73u * 73u * 73u * 73u * 73u;
 
-  while (bits != 0 || (is_coach && i < MAX_MSG_SIZE)) {
-    rem = bits % CODE_SIZE;
-    bits = (bits - rem) / CODE_SIZE;
-    if (i >= MAX_MSG_SIZE) {
-      PRINT_ERROR("codec msg size greater than " << MAX_MSG_SIZE);
-      break;
-    }
-    msg[i++] = CODE[rem];
+  const UDWORD64 value = static_cast<UDWORD64>(bits);
+  unsigned half[2] = {static_cast<unsigned>(value % HALF_SIZE),
+                      static_cast<unsigned>(value / HALF_SIZE % HALF_SIZE)};
+  if (value / HALF_SIZE >= HALF_SIZE) {
+    PRINT_ERROR("codec msg size greater than " << MAX_MSG_SIZE);
   }
-  msg[i] = '\0';
+
+  int size = 0;
+  for (int i = 0; i < MAX_MSG_SIZE; ++i) {
+    const unsigned rem = half[i / 5] % CODE_SIZE;
+    half[i / 5] /= CODE_SIZE;
+    msg[i] = CODE[rem];
+    size = rem != 0 ? i + 1 : size;
+  }
+  size = is_coach ? MAX_MSG_SIZE : size;
+  msg[size] = '\0';
 }
 
 void CommunicateSystem::Decode(const unsigned char *msg, DWORD64 &bits,
                                bool is_coach) {
   int n = is_coach ? MAX_MSG_SIZE : strlen((const char *)msg);
-  bits = 0;
-  DWORD64 plus = 1;
-  for (int i = 0; i < n; ++i) {
-    bits += CODE_TO_INT[msg[i]] * plus;
-    plus *= CODE_SIZE;
+  UDWORD64 value = 0;
+  for (int i = n - 1; i >= 0; --i) {
+    value = value * CODE_SIZE + CODE_TO_INT[msg[i]];
+  }
+  bits = static_cast<DWORD64>(value);
+}
+
+/**
+ * 每种编码取随机值（两端各含 1% 的越界值）做往返，误差不应超过一个量化步长；随机的 61 位
+ * 数做 Encode/Decode 往返，应完全一致。同时统计每次往返的耗时
+ */
+void CommunicateSystem::CheckCodecs() {
+  static const int SAMPLES = 1000000;
+  static const char *NAME[CODEC_MAX] = {"pos_x", "pos_y", "ball_speed",
+                                        "player_speed", "dir"};
+
+  UDWORD64 seed = 88172645463325252ULL;
+  SetCommunicateType(FREE_FORM);
+
+  for (int type = 0; type < CODEC_MAX; ++type) {
+    const CodecType codec_type = static_cast<CodecType>(type);
+    const Codec &codec = mpCodec[type];
+    double max_error = 0.0;
+
+    const timeval start = GetRealTime();
+    for (int i = 0; i < SAMPLES; ++i) {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+      const double value =
+          codec.mMin + ((seed >> 11) / 9007199254740992.0 * 1.02 - 0.01) *
+                           codec.mSpan;
+      const double clamped =
+          value > codec.mMax ? codec.mClampHigh
+                             : (value < codec.mMin ? codec.mClampLow : value);
+      const double error =
+          fabs(BitToDouble(DoubleToBit(value, codec_type), codec_type) -
+               clamped);
+      max_error = Max(max_error, error);
+    }
+    const timeval end = GetRealTime();
+
+    if (max_error > codec.mStep + FLOAT_EPS) {
+      PRINT_ERROR("say codec " << NAME[type] << " error " << max_error
+                               << " greater than step " << codec.mStep);
+    }
+    std::cout << "say codec " << NAME[type] << ": " << codec.mBitCount
+              << " bits, step " << codec.mStep << ", max error " << max_error
+              << ", "
+              << ((end.tv_sec - start.tv_sec) * 1.0e6 +
+                  (end.tv_usec - start.tv_usec)) *
+                     1000.0 / SAMPLES
+              << " ns per round trip" << std::endl;
+  }
+
+  for (int coach = 0; coach < 2; ++coach) {
+    int mismatch = 0;
+    unsigned char msg[MAX_MSG_SIZE + 1];
+
+    const timeval start = GetRealTime();
+    for (int i = 0; i < SAMPLES; ++i) {
+      seed ^= seed << 13;
+      seed ^= seed >> 7;
+      seed ^= seed << 17;
+      const DWORD64 bits = static_cast<DWORD64>(seed >> (64 - 61));
+      DWORD64 decoded = 0;
+      Encode(bits, msg, coach != 0);
+      Decode(msg, decoded, coach != 0);
+      mismatch += decoded != bits;
+    }
+    const timeval end = GetRealTime();
+
+    if (mismatch > 0) {
+      PRINT_ERROR("say message " << mismatch << " round trip mismatches");
+    }
+    std::cout << "say message" << (coach ? " (coach)" : "") << ": " << SAMPLES
+              << " round trips, " << mismatch << " mismatches, "
+              << ((end.tv_sec - start.tv_sec) * 1.0e6 +
+                  (end.tv_usec - start.tv_usec)) *
+                     1000.0 / SAMPLES
+              << " ns per encode and decode" << std::endl;
   }
 }
 
@@ -235,6 +348,8 @@ void CommunicateSystem::PrintBits(DWORD64 bits) {
 }
 
 void CommunicateSystem::Update() {
+  UpdateCodecs(); // server_param 可能刚收到
+
   // some reset work
   mCommuBits = 0;
   mBitsUsed = 0;
@@ -259,13 +374,13 @@ void CommunicateSystem::Update() {
 }
 
 bool CommunicateSystem::AddDataToCommuBits(double value, CodecType type) {
-  if (mBitsUsed + (*mpCodecBitCount)[type] > MAX_BITS_USED) {
+  if (mBitsUsed + mpCodec[type].mBitCount > MAX_BITS_USED) {
     PRINT_ERROR("bits used greater then " << MAX_BITS_USED);
     return false;
   } else {
-    mCommuBits <<= (*mpCodecBitCount)[type];
+    mCommuBits <<= mpCodec[type].mBitCount;
     mCommuBits += DoubleToBit(value, type);
-    mBitsUsed += (*mpCodecBitCount)[type];
+    mBitsUsed += mpCodec[type].mBitCount;
 
     return true;
   }
@@ -346,44 +461,56 @@ bool CommunicateSystem::SendBallStatus(const BallState &ball_state, int cd) {
     }
   }
   if (send_type != FREE_FORM_MAX) {
-    switch (send_type) {
-    case BALL_WITH_SPEED:
-      AddDataToCommuBits(pos.X(), POS_X);
-      AddDataToCommuBits(pos.Y(), POS_Y);
-      AddDataToCommuBits(vel.Mod(), BALL_SPEED);
-      AddDataToCommuBits(vel.Dir(), DIR);
-      AddFreeFormFlagToCommuBits(BALL_WITH_SPEED);
-      mBallSended = true;
-      Logger::instance().GetTextLogger("freeform")
-          << mpAgent->GetWorldState().CurrentTime() << " send ball: " << pos
-          << " " << vel << endl;
-      return true;
-    case BALL_WITH_ZERO_SPEED:
-      AddDataToCommuBits(pos.X(), POS_X);
-      AddDataToCommuBits(pos.Y(), POS_Y);
-      AddFreeFormFlagToCommuBits(BALL_WITH_ZERO_SPEED);
-      mBallSended = true;
-      Logger::instance().GetTextLogger("freeform")
-          << mpAgent->GetWorldState().CurrentTime() << " send ball: " << pos
-          << " " << Vector(0, 0) << endl;
-      return true;
-    case BALL_ONLY_POS:
-      AddDataToCommuBits(pos.X(), POS_X);
-      AddDataToCommuBits(pos.Y(), POS_Y);
-      AddFreeFormFlagToCommuBits(BALL_ONLY_POS);
-      Logger::instance().GetTextLogger("freeform")
-          << mpAgent->GetWorldState().CurrentTime() << " send ball: " << pos
-          << endl;
-      mBallSended = true;
-      return true;
-    default:
-      PRINT_ERROR("send ball status");
-      break;
-    }
+    AddBallToCommuBits(send_type, pos, vel);
+    return true;
   }
   return false;
 }
 
+void CommunicateSystem::AddBallToCommuBits(FreeFormType type,
+                                           const Vector &pos,
+                                           const Vector &vel) {
+  switch (type) {
+  case BALL_WITH_SPEED:
+    AddDataToCommuBits(pos.X(), POS_X);
+    AddDataToCommuBits(pos.Y(), POS_Y);
+    AddDataToCommuBits(vel.Mod(), BALL_SPEED);
+    AddDataToCommuBits(vel.Dir(), DIR);
+    AddFreeFormFlagToCommuBits(BALL_WITH_SPEED);
+    mToldBallVel = vel;
+    mToldBallVelValid = true;
+    Logger::instance().GetTextLogger("freeform")
+        << mpAgent->GetWorldState().CurrentTime() << " send ball: " << pos
+        << " " << vel << endl;
+    break;
+  case BALL_WITH_ZERO_SPEED:
+    AddDataToCommuBits(pos.X(), POS_X);
+    AddDataToCommuBits(pos.Y(), POS_Y);
+    AddFreeFormFlagToCommuBits(BALL_WITH_ZERO_SPEED);
+    mToldBallVel = Vector(0, 0);
+    mToldBallVelValid = true;
+    Logger::instance().GetTextLogger("freeform")
+        << mpAgent->GetWorldState().CurrentTime() << " send ball: " << pos
+        << " " << Vector(0, 0) << endl;
+    break;
+  case BALL_ONLY_POS:
+    AddDataToCommuBits(pos.X(), POS_X);
+    AddDataToCommuBits(pos.Y(), POS_Y);
+    AddFreeFormFlagToCommuBits(BALL_ONLY_POS);
+    mToldBallVelValid = false;
+    Logger::instance().GetTextLogger("freeform")
+        << mpAgent->GetWorldState().CurrentTime() << " send ball: " << pos
+        << endl;
+    break;
+  default:
+    PRINT_ERROR("send ball status");
+    return;
+  }
+
+  mBallSended = true;
+  Tell(TOLD_BALL, pos);
+}
+
 bool CommunicateSystem::SendTeammateStatus(const WorldState *pWorldState,
                                            Unum num, int cd) {
   Assert(num > 0);
@@ -419,6 +546,7 @@ bool CommunicateSystem::SendTeammateStatus(const WorldState *pWorldState,
           << mpAgent->GetWorldState().CurrentTime() << " send tm: " << num
           << " " << pos << endl;
       mTeammateSended[num] = true;
+      Tell(num, pos);
       return true;
     }
   }
@@ -460,6 +588,7 @@ bool CommunicateSystem::SendOpponentStatus(const WorldState *pWorldState,
       Logger::instance().GetTextLogger("freeform")
           << mpAgent->GetWorldState().CurrentTime() << " send opp: " << num
           << " " << pos << endl;
+      Tell(TEAMSIZE + num, pos);
       return true;
     }
   }
@@ -467,6 +596,8 @@ bool CommunicateSystem::SendOpponentStatus(const WorldState *pWorldState,
 }
 
 void CommunicateSystem::Decision() {
+  TIMETEST("CommunicateSystem");
+
   DoCommunication();
 
   if (mBitsUsed != 0) {
@@ -498,8 +629,8 @@ double CommunicateSystem::ExtractDataFromBits(DWORD64 &bits, CodecType type,
   double res;
 
   res = BitToDouble(bits, type);
-  bits >>= (*mpCodecBitCount)[type];
-  bit_left -= (*mpCodecBitCount)[type];
+  bits >>= mpCodec[type].mBitCount;
+  bit_left -= mpCodec[type].mBitCount;
 
   return res;
 }
@@ -538,6 +669,9 @@ void CommunicateSystem::RecvFreeForm(DWORD64 bits) {
       double y = ExtractDataFromBits(bits, POS_Y, bit_left);
       double x = ExtractDataFromBits(bits, POS_X, bit_left);
       mpObserver->HearBall(Vector(x, y), Polar2Vector(speed, dir));
+      Tell(TOLD_BALL, Vector(x, y));
+      mToldBallVel = Polar2Vector(speed, dir);
+      mToldBallVelValid = true;
       Logger::instance().GetTextLogger("freeform")
           << mpObserver->CurrentTime() << " hear ball: " << Vector(x, y) << " "
           << Polar2Vector(speed, dir) << endl;
@@ -545,6 +679,9 @@ void CommunicateSystem::RecvFreeForm(DWORD64 bits) {
       double y = ExtractDataFromBits(bits, POS_Y, bit_left);
       double x = ExtractDataFromBits(bits, POS_X, bit_left);
       mpObserver->HearBall(Vector(x, y), Vector(0.0, 0.0));
+      Tell(TOLD_BALL, Vector(x, y));
+      mToldBallVel = Vector(0.0, 0.0);
+      mToldBallVelValid = true;
       Logger::instance().GetTextLogger("freeform")
           << mpObserver->CurrentTime() << " hear ball: " << Vector(x, y) << " "
           << Polar2Vector(0, 0) << endl;
@@ -552,6 +689,8 @@ void CommunicateSystem::RecvFreeForm(DWORD64 bits) {
       double y = ExtractDataFromBits(bits, POS_Y, bit_left);
       double x = ExtractDataFromBits(bits, POS_X, bit_left);
       mpObserver->HearBall(Vector(x, y));
+      Tell(TOLD_BALL, Vector(x, y));
+      mToldBallVelValid = false;
       Logger::instance().GetTextLogger("freeform")
           << mpObserver->CurrentTime() << " hear ball: " << Vector(x, y)
           << endl;
@@ -560,6 +699,7 @@ void CommunicateSystem::RecvFreeForm(DWORD64 bits) {
       double x = ExtractDataFromBits(bits, POS_X, bit_left);
       Unum num = ExtractUnumFromBits(bits, bit_left);
       mpObserver->HearTeammate(num, Vector(x, y));
+      Tell(num, Vector(x, y));
       Logger::instance().GetTextLogger("freeform")
           << mpObserver->CurrentTime() << " hear tm: " << num << " "
           << Vector(x, y) << endl;
@@ -568,6 +708,7 @@ void CommunicateSystem::RecvFreeForm(DWORD64 bits) {
       double x = ExtractDataFromBits(bits, POS_X, bit_left);
       Unum num = ExtractUnumFromBits(bits, bit_left);
       mpObserver->HearOpponent(num, Vector(x, y));
+      Tell(TEAMSIZE + num, Vector(x, y));
       Logger::instance().GetTextLogger("freeform")
           << mpObserver->CurrentTime() << " hear opp: " << num << " "
           << Vector(x, y) << endl;
@@ -617,6 +758,11 @@ void CommunicateSystem::DoCommunication() {
     }
   }
 
+  if (PlayerParam::instance().sayPlanner()) {
+    PlanCommunication();
+    return;
+  }
+
   SendBallStatus(mpAgent->GetWorldState().GetBall());
   SendTeammateStatus(&mpAgent->GetWorldState(), mpAgent->GetSelfUnum());
 
@@ -636,3 +782,135 @@ void CommunicateSystem::DoCommunication() {
     }
   }
 }
+
+void CommunicateSystem::Tell(int object, const Vector &pos) {
+  mToldTime[object] = mpObserver->CurrentTime();
+  mToldPos[object] = pos;
+}
+
+double CommunicateSystem::ToldError(int object, const Vector &pos) const {
+  if (mToldTime[object].T() < 0) {
+    return SAY_MAX_ERROR;
+  }
+
+  const int age = mpAgent->GetWorldState().CurrentTime() - mToldTime[object];
+  Vector told_pos = mToldPos[object];
+  if (object == TOLD_BALL && mToldBallVelValid) { //说过球速，队友会自己预测
+    const double decay = ServerParam::instance().ballDecay();
+    told_pos += mToldBallVel * ((1.0 - pow(decay, age)) / (1.0 - decay));
+  }
+
+  return Min(pos.Dist(told_pos) + age * SAY_ERROR_PER_CYCLE, SAY_MAX_ERROR);
+}
+
+/**
+ * 候选内容为看到的球（几种编码方式为一组）和 unum_far_length 内看到的各球员，效用为
+ * 决策相关度（球固定，球员按离球距离衰减）乘以队友认知的估计误差；最近说过且没怎么动
+ * 的对象误差小，自然不会重复说。在剩余位数内做分组背包，每组至多选一个
+ */
+void CommunicateSystem::PlanCommunication() {
+  const WorldState &world_state = mpAgent->GetWorldState();
+  const BallState &ball = world_state.GetBall();
+  const Vector &ball_pos = ball.GetPos();
+
+  vector<SayOption> options;
+  int groups = 0;
+
+  if (ball.GetPosDelay() <= 0) {
+    const double pos_utility =
+        SAY_BALL_RELEVANCE * ToldError(TOLD_BALL, ball_pos);
+    double vel_utility = SAY_BALL_RELEVANCE * SAY_MAX_ERROR;
+    if (mToldBallVelValid && mToldTime[TOLD_BALL].T() >= 0) {
+      vel_utility = SAY_BALL_RELEVANCE *
+                    Min(ball.GetVel().Dist(mToldBallVel) * SAY_VEL_HORIZON,
+                        SAY_MAX_ERROR);
+    }
+
+    SayOption option = {groups, BALL_ONLY_POS, 0,
+                        mFreeFormCodecBitCount[BALL_ONLY_POS], pos_utility};
+    if (ball.GetVelDelay() <= 0) {
+      if (ball.GetVel().Mod2() > FLOAT_EPS) {
+        options.push_back(option);
+        option.mType = BALL_WITH_SPEED;
+        option.mBits = mFreeFormCodecBitCount[BALL_WITH_SPEED];
+      } else {
+        option.mType = BALL_WITH_ZERO_SPEED;
+        option.mBits = mFreeFormCodecBitCount[BALL_WITH_ZERO_SPEED];
+      }
+      option.mUtility += vel_utility;
+    }
+    options.push_back(option);
+    ++groups;
+  }
+
+  for (int i = -TEAMSIZE; i <= TEAMSIZE; ++i) {
+    if (i == 0) {
+      continue;
+    }
+
+    const PlayerState &player = world_state.GetPlayer(i);
+    if (!player.IsAlive() || player.GetPosDelay() > 0 ||
+        mpAgent->GetInfoState().GetPositionInfo().GetPlayerDistToPlayer(
+            mpAgent->GetSelfUnum(), i) >
+            ServerParam::instance().unumFarLength()) {
+      continue;
+    }
+
+    const int object = i > 0 ? i : TEAMSIZE - i;
+    const int bits = mFreeFormCodecBitCount[TEAMMATE_ONLY_POS] + mUnumBitCount;
+    const double relevance =
+        exp(-player.GetPos().Dist(ball_pos) / SAY_RELEVANCE_DIST);
+    SayOption option = {groups++, i > 0 ? TEAMMATE_ONLY_POS : OPPONENT_ONLY_POS,
+                        i, bits, relevance * ToldError(object, player.GetPos())};
+    options.push_back(option);
+  }
+
+  const int capacity = MAX_BITS_USED - mBitsUsed;
+  if (groups == 0 || capacity <= 0) {
+    return;
+  }
+
+  // best[w] 为前若干组用不超过 w 位的最大效用，choice 记录每组在各位数下选的候选
+  vector<double> best(capacity + 1, 0.0);
+  vector<int> choice(groups * (capacity + 1), -1);
+
+  unsigned begin = 0;
+  for (int group = 0; group < groups; ++group) {
+    vector<double> next(best);
+    unsigned end = begin;
+    for (; end < options.size() && options[end].mGroup == group; ++end) {
+      const SayOption &option = options[end];
+      for (int w = option.mBits; w <= capacity; ++w) {
+        const double value = best[w - option.mBits] + option.mUtility;
+        if (value > next[w]) {
+          next[w] = value;
+          choice[group * (capacity + 1) + w] = end;
+        }
+      }
+    }
+    best.swap(next);
+    begin = end;
+  }
+
+  int w = capacity;
+  for (int group = groups - 1; group >= 0; --group) {
+    const int index = choice[group * (capacity + 1) + w];
+    if (index < 0) {
+      continue;
+    }
+
+    const SayOption &option = options[index];
+    w -= option.mBits;
+    switch (option.mType) {
+    case TEAMMATE_ONLY_POS:
+      SendTeammateStatus(&world_state, option.mNum);
+      break;
+    case OPPONENT_ONLY_POS:
+      SendOpponentStatus(&world_state, -option.mNum);
+      break;
+    default:
+      AddBallToCommuBits(option.mType, ball_pos, ball.GetVel());
+      break;
+    }
+  }
+}
@@ -55,7 +55,7 @@ static const int MAX_DENGER_OPP = 4;
 class CommunicateSystem {
 public:
   static const unsigned char *CODE;
-  static int CODE_TO_INT[128];
+  static int CODE_TO_INT[256];
   static const int CODE_SIZE;
   static const int MAX_MSG_SIZE;
   static int MAX_BITS_USED;
@@ -143,11 +143,33 @@ public:
   int mUnumBitCount;
   DWORD64 mUnumMask;
 
-  int mCodecBitCount[COMMU_MAX][CODEC_MAX];
-  DWORD64 mCodecMask[COMMU_MAX][CODEC_MAX];
+  /**
+   * 编解码描述：范围、量化级数、步长和位数，每周期按 GetCodecRange 刷新，编解码时直接查表
+   */
+  struct Codec {
+    double mMin;
+    double mSpan;      // max - min
+    double mRange;     //量化级数，即 mMask
+    double mStep;      //量化步长
+    double mClampLow;  //越界时的取值
+    double mClampHigh;
+    double mMax;
+    int mBitCount;
+    DWORD64 mMask;
+  };
 
-  int (*mpCodecBitCount)[CODEC_MAX];
-  DWORD64 (*mpCodecMask)[CODEC_MAX];
+  Codec mCodec[COMMU_MAX][CODEC_MAX];
+  const Codec *mpCodec;
+
+  /**
+   * 按当前的 ServerParam 刷新各编解码的范围
+   */
+  void UpdateCodecs();
+
+  /**
+   * 编解码的往返误差和耗时
+   */
+  void CheckCodecs();
 
   int mFreeFormCodecBitCount[FREE_FORM_MAX];
 
@@ -189,10 +211,32 @@ public:
   void RecvFreeForm(DWORD64 bits);
 
   void SetCommunicateType(CommuType type) {
-    mpCodecBitCount = &mCodecBitCount[type];
-    mpCodecMask = &mCodecMask[type];
+    mpCodec = mCodec[type];
   }
 
+  /**
+   * 队友对各对象的认知：上次由自己或队友说出的时间和内容
+   * 下标：0为球，1-11为队友，12-22为对手
+   */
+  enum { TOLD_BALL = 0, TOLD_SIZE = 1 + 2 * TEAMSIZE };
+  Time mToldTime[TOLD_SIZE];
+  Vector mToldPos[TOLD_SIZE];
+  Vector mToldBallVel;
+  bool mToldBallVelValid;
+
+  void Tell(int object, const Vector &pos);
+
+  /**
+   * 估计队友对对象位置认知的误差，从未说过则为最大值
+   */
+  double ToldError(int object, const Vector &pos) const;
+
+  /**
+   * 按指定的编码方式把球加入 communicate bits
+   */
+  void AddBallToCommuBits(FreeFormType type, const Vector &pos,
+                          const Vector &vel);
+
 private:
   CommunicateSystem();
 
@@ -201,6 +245,11 @@ private:
    */
   void DoCommunication();
 
+  /**
+   * 按效用用分组背包选择说话内容
+   */
+  void PlanCommunication();
+
 public:
   virtual ~CommunicateSystem();
 
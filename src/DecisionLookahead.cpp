@@ -0,0 +1,272 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#include "DecisionLookahead.h"
+#include "Agent.h"
+#include "BehaviorBase.h"
+#include "Evaluation.h"
+#include "Simulator.h"
+#include "WorldState.h"
+#include <algorithm>
+
+namespace {
+inline int PlayerIndex(Unum unum) {
+  return unum > 0 ? unum - 1 : TEAMSIZE - unum - 1;
+}
+} // namespace
+
+DecisionLookahead::DecisionLookahead()
+    : mpAgent(0), mPool(MAX_DEPTH + 1), mMemoStamp(0), mMemoSize(0),
+      mNodeBudget(0), mNodeCount(0), mDiscount(1.0) {
+  //每展开一个节点最多写入一项，表最多用一半
+  const int budget = PlayerParam::instance().LookaheadNodeBudget();
+  size_t capacity = 16;
+  while (capacity < 2 * (size_t)Max(budget, 0)) {
+    capacity *= 2;
+  }
+
+  mMemoKey.resize(capacity, 0);
+  mMemoValue.resize(capacity, 0.0);
+  mMemoCellStamp.resize(capacity, 0);
+}
+
+void DecisionLookahead::Reset(Agent &agent, int node_budget) {
+  mpAgent = &agent;
+  mNodeBudget = node_budget;
+  mNodeCount = 0;
+  mDiscount = PlayerParam::instance().LookaheadDiscount();
+  if (++mMemoStamp == 0) { //戳用完一轮，清空重来
+    std::fill(mMemoCellStamp.begin(), mMemoCellStamp.end(), 0u);
+    mMemoStamp = 1;
+  }
+  mMemoSize = 0;
+
+  const WorldState &world_state = agent.GetWorldState();
+  Snapshot &root = mPool[0];
+
+  root.mBallPos = world_state.GetBall().GetPos();
+  root.mHolder = agent.GetSelfUnum();
+
+  for (Unum i = -TEAMSIZE; i <= TEAMSIZE; ++i) {
+    if (i == 0)
+      continue;
+
+    const PlayerState &player = world_state.GetPlayer(i);
+    const int index = PlayerIndex(i);
+
+    mAlive[index] = player.IsAlive();
+    mGoalie[index] = player.IsGoalie();
+    mSpeedMax[index] = player.GetEffectiveSpeedMax();
+    mKickableArea[index] = player.GetKickableArea();
+    root.mPlayerPos[index] = player.GetPos();
+  }
+}
+
+double DecisionLookahead::Evaluate(const ActiveBehavior &behavior, int depth) {
+  depth = MinMax(1, depth, int(MAX_DEPTH));
+
+  const Snapshot &root = mPool[0];
+  Snapshot &child = mPool[1];
+  Unum winner = 0;
+
+  if (behavior.GetType() == BT_Pass &&
+      behavior.mDetailType == BDT_Pass_Direct) {
+    winner = Rollout(root, Polar2Vector(behavior.mKickSpeed, behavior.mAngle),
+                     root.mHolder, &child);
+  } else if (behavior.GetType() == BT_Dribble &&
+             behavior.mDetailType == BDT_Dribble_Fast) {
+    winner = Rollout(root, Polar2Vector(behavior.mKickSpeed, behavior.mAngle),
+                     0, &child);
+  } else if (behavior.GetType() == BT_Dribble &&
+             behavior.mDetailType == BDT_Dribble_Normal) {
+    //球随人走向目标点，先到球边的人控球
+    winner = Rollout(root, behavior.mTarget - root.mBallPos, 0, &child);
+  } else {
+    return -1.0;
+  }
+
+  if (winner <= 0) {
+    return 0.0; //对手控球或出界
+  }
+
+  return Expand(child, depth - 1, 1);
+}
+
+Unum DecisionLookahead::Rollout(const Snapshot &from, const Vector &ball_vel,
+                                Unum kicker, Snapshot *to) {
+  Simulator::Ball ball(from.mBallPos, ball_vel);
+
+  for (int t = 1; t <= MAX_ROLLOUT; ++t) {
+    ball.Step();
+    if (!ServerParam::instance().pitchRectanglar().IsWithin(ball.mPos)) {
+      return 0;
+    }
+
+    //t 个周期内能跑到球边的人可以控球，同时到达时算对手的
+    Unum winner = 0;
+    for (Unum i = -1; i >= -TEAMSIZE && !winner; --i) {
+      const int index = PlayerIndex(i);
+      if (mAlive[index] &&
+          from.mPlayerPos[index].Dist(ball.mPos) <=
+              mSpeedMax[index] * t + mKickableArea[index]) {
+        winner = i;
+      }
+    }
+    for (Unum i = 1; i <= TEAMSIZE && !winner; ++i) {
+      const int index = PlayerIndex(i);
+      if (mAlive[index] && i != kicker &&
+          from.mPlayerPos[index].Dist(ball.mPos) <=
+              mSpeedMax[index] * t + mKickableArea[index]) {
+        winner = i;
+      }
+    }
+    if (!winner)
+      continue;
+
+    //对手都向球逼近，队友留在原地
+    to->mBallPos = ball.mPos;
+    to->mHolder = winner > 0 ? winner : 0;
+    for (Unum i = -TEAMSIZE; i <= TEAMSIZE; ++i) {
+      if (i == 0)
+        continue;
+
+      const int index = PlayerIndex(i);
+      const Vector &pos = from.mPlayerPos[index];
+      if (i == winner) {
+        to->mPlayerPos[index] = ball.mPos;
+      } else if (i < 0) {
+        const double dist = pos.Dist(ball.mPos);
+        const double move = Min(dist, mSpeedMax[index] * t);
+        to->mPlayerPos[index] =
+            dist > FLOAT_EPS ? pos + (ball.mPos - pos) * (move / dist) : pos;
+      } else {
+        to->mPlayerPos[index] = pos;
+      }
+    }
+    return winner;
+  }
+
+  return 0;
+}
+
+double DecisionLookahead::Expand(const Snapshot &s, int depth, int level) {
+  ++mNodeCount;
+
+  double value = EvaluateState(s);
+  if (depth <= 0 || mNodeCount >= mNodeBudget ||
+      mpAgent->IsDecisionTimeOut()) {
+    return value;
+  }
+
+  //球和球员都落在同样的 1 米格子里、控球人和剩余深度也相同的状态只展开一次
+  const unsigned long long key = GetMemoKey(s, depth);
+  double memo;
+  if (FindMemo(key, &memo)) {
+    return memo;
+  }
+
+  Snapshot &child = mPool[level + 1];
+  for (Unum i = 1; i <= TEAMSIZE && mNodeCount < mNodeBudget; ++i) {
+    const int index = PlayerIndex(i);
+    if (i == s.mHolder || !mAlive[index] || mGoalie[index])
+      continue;
+
+    const Vector &target = s.mPlayerPos[index];
+    const double speed = MinMax(
+        2.0,
+        ServerParam::instance().GetBallSpeed(5, target.Dist(s.mBallPos)),
+        ServerParam::instance().ballSpeedMax());
+
+    if (Rollout(s, Polar2Vector(speed, (target - s.mBallPos).Dir()),
+                s.mHolder, &child) > 0) {
+      value = Max(value, mDiscount * Expand(child, depth - 1, level + 1));
+    }
+  }
+
+  InsertMemo(key, value);
+  return value;
+}
+
+double DecisionLookahead::EvaluateState(const Snapshot &s) const {
+  return Evaluation::instance().EvaluatePosition(s.mBallPos, true);
+}
+
+unsigned long long DecisionLookahead::GetMemoKey(const Snapshot &s,
+                                                 int depth) {
+  // FNV-1a，格子坐标平移到非负
+  unsigned long long key = 14695981039346656037ULL;
+  const unsigned long long prime = 1099511628211ULL;
+
+  key = (key ^ (unsigned long long)(s.mHolder + TEAMSIZE)) * prime;
+  key = (key ^ (unsigned long long)depth) * prime;
+  key = (key ^ (unsigned long long)floor(s.mBallPos.X() + 128.0)) * prime;
+  key = (key ^ (unsigned long long)floor(s.mBallPos.Y() + 128.0)) * prime;
+  for (int i = 0; i < 2 * TEAMSIZE; ++i) {
+    key = (key ^ (unsigned long long)floor(s.mPlayerPos[i].X() + 128.0)) *
+          prime;
+    key = (key ^ (unsigned long long)floor(s.mPlayerPos[i].Y() + 128.0)) *
+          prime;
+  }
+  return key;
+}
+
+bool DecisionLookahead::FindMemo(unsigned long long key, double *value) const {
+  const size_t mask = mMemoKey.size() - 1;
+
+  for (size_t i = key & mask; mMemoCellStamp[i] == mMemoStamp;
+       i = (i + 1) & mask) {
+    if (mMemoKey[i] == key) {
+      *value = mMemoValue[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+void DecisionLookahead::InsertMemo(unsigned long long key, double value) {
+  const size_t mask = mMemoKey.size() - 1;
+  if (2 * (size_t)mMemoSize >= mMemoKey.size()) {
+    return;
+  }
+
+  size_t i = key & mask;
+  for (; mMemoCellStamp[i] == mMemoStamp; i = (i + 1) & mask) {
+    if (mMemoKey[i] == key) {
+      mMemoValue[i] = value;
+      return;
+    }
+  }
+
+  mMemoCellStamp[i] = mMemoStamp;
+  mMemoKey[i] = key;
+  mMemoValue[i] = value;
+  ++mMemoSize;
+}
@@ -0,0 +1,135 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#ifndef __DecisionLookahead_H__
+#define __DecisionLookahead_H__
+
+#include "Geometry.h"
+#include "Types.h"
+#include <vector>
+
+class Agent;
+class ActiveBehavior;
+
+/**
+ * 决策树的多步搜索：从当前状态出发，模拟传球、带球之后谁先控到球，在我方控球
+ * 的状态上继续展开接球队员的下一步传球，用叶子状态的位置评价给根节点的行为打分
+ * Multi-step lookahead used by DecisionTree::Search. Sub-states are plain
+ * snapshots taken from a per-depth pool and the memo is an open-addressing
+ * table sized once in the constructor, so a search allocates nothing.
+ */
+class DecisionLookahead {
+public:
+  DecisionLookahead();
+
+  enum {
+    MAX_DEPTH = 4,   /** 最多展开的步数 */
+    MAX_ROLLOUT = 30 /** 一次传球最多模拟的周期数 */
+  };
+
+  /**
+   * 每次决策开始时调用，从 agent 的世界状态得到根节点
+   */
+  void Reset(Agent &agent, int node_budget);
+
+  /**
+   * 执行 behavior 之后再展开 depth - 1 步得到的评价；不支持的行为返回负数
+   */
+  double Evaluate(const ActiveBehavior &behavior, int depth);
+
+  int GetNodeCount() const { return mNodeCount; }
+
+private:
+  struct Snapshot {
+    Vector mBallPos;
+    Unum mHolder; //控球的队友，0 表示没有人控球
+
+    Vector mPlayerPos[2 * TEAMSIZE]; //队友在前，对手在后
+  };
+
+  /**
+   * 球以 ball_vel 从 from 出发，模拟到有人能控球为止
+   * @param kicker 出球的人，这一步不参与抢球
+   * @return 控到球的人，+ 为队友，- 为对手，0 表示出界或模拟结束没人控到
+   */
+  Unum Rollout(const Snapshot &from, const Vector &ball_vel, Unum kicker,
+               Snapshot *to);
+
+  /**
+   * 我方控球的状态 s 继续展开 depth 步的评价，子状态放在 mPool[level + 1]
+   */
+  double Expand(const Snapshot &s, int depth, int level);
+
+  double EvaluateState(const Snapshot &s) const;
+
+  /**
+   * 记忆化用的键：控球人、剩余深度，以及球和所有球员所在的 1 米格子
+   */
+  static unsigned long long GetMemoKey(const Snapshot &s, int depth);
+
+  /**
+   * 在记忆表中查找 key，找到时写入 value 返回 true
+   */
+  bool FindMemo(unsigned long long key, double *value) const;
+
+  /**
+   * 写入记忆表，表满一半之后不再写入
+   */
+  void InsertMemo(unsigned long long key, double value);
+
+private:
+  Agent *mpAgent;
+
+  /** 球员的不变属性，Reset 时取一次 */
+  Array<bool, 2 * TEAMSIZE> mAlive;
+  Array<bool, 2 * TEAMSIZE> mGoalie;
+  Array<double, 2 * TEAMSIZE> mSpeedMax;
+  Array<double, 2 * TEAMSIZE> mKickableArea;
+
+  /** 每层一个，深度优先搜索时同一层的子状态轮流使用 */
+  std::vector<Snapshot> mPool;
+
+  /**
+   * 记忆表：线性探测，容量是不小于两倍 lookahead_node_budget 的 2 的幂，
+   * 戳等于 mMemoStamp 的格子才有效，每次搜索只需把 mMemoStamp 加一
+   */
+  std::vector<unsigned long long> mMemoKey;
+  std::vector<double> mMemoValue;
+  std::vector<unsigned> mMemoCellStamp;
+  unsigned mMemoStamp;
+  int mMemoSize;
+
+  int mNodeBudget;
+  int mNodeCount;
+  double mDiscount;
+};
+
+#endif
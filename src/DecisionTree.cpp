@@ -37,13 +37,22 @@
 #include "BehaviorIntercept.h"
 #include "BehaviorPenalty.h"
 #include "BehaviorSetplay.h"
+#include "Logger.h"
 #include "Strategy.h"
 #include "TimeTest.h"
 
 bool DecisionTree::Decision(Agent &agent) {
   Assert(agent.GetSelf().IsAlive());
 
-  ActiveBehavior beh = Search(agent, 1);
+  ActiveBehavior beh =
+      Search(agent, Max(PlayerParam::instance().DecisionSearchDepth(), 1));
+
+  //负载高时每周期都可能超时，只记到文本日志里，不刷stderr
+  if (agent.IsDecisionTimeOut()) {
+    Logger::instance().GetTextLogger("decision")
+        << agent.GetWorldState().CurrentTime() << " player "
+        << agent.GetSelfUnum() << " passed the decision deadline" << std::endl;
+  }
 
   if (beh.GetType() != BT_None) {
     agent.SetActiveBehaviorInAct(beh.GetType());
@@ -54,35 +63,54 @@ bool DecisionTree::Decision(Agent &agent) {
 }
 
 ActiveBehavior DecisionTree::Search(Agent &agent, int step) {
-  if (step == 1) {
-    if (agent.GetSelf().IsIdling()) {
-      return ActiveBehavior(agent, BT_None);
-    }
+  TIMETEST("Search");
 
-    std::list<ActiveBehavior> active_behavior_list;
-
-    if (agent.GetSelf().IsGoalie()) {
-      MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
-          MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
-          MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
-          MutexPlan<BehaviorGoaliePlanner>(agent, active_behavior_list);
-    } else {
-      MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
-          MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
-          MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
-          MutexPlan<BehaviorDefensePlanner>(agent, active_behavior_list);
-    }
+  if (agent.GetSelf().IsIdling()) {
+    return ActiveBehavior(agent, BT_None);
+  }
 
-    if (!active_behavior_list.empty()) {
-      return GetBestActiveBehavior(agent, active_behavior_list);
-    } else {
-      return ActiveBehavior(agent, BT_None);
-    }
+  std::list<ActiveBehavior> active_behavior_list;
+
+  if (agent.GetSelf().IsGoalie()) {
+    MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
+        MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
+        MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
+        MutexPlan<BehaviorGoaliePlanner>(agent, active_behavior_list);
+  } else {
+    MutexPlan<BehaviorPenaltyPlanner>(agent, active_behavior_list) ||
+        MutexPlan<BehaviorSetplayPlanner>(agent, active_behavior_list) ||
+        MutexPlan<BehaviorAttackPlanner>(agent, active_behavior_list) ||
+        MutexPlan<BehaviorDefensePlanner>(agent, active_behavior_list);
+  }
+
+  //可踢时后面几步由接球的队员继续，多步搜索只在这时有意义
+  if (step > 1 && agent.GetSelf().IsKickable() &&
+      !agent.IsDecisionTimeOut()) {
+    Lookahead(agent, step, active_behavior_list);
+  }
+
+  if (!active_behavior_list.empty()) {
+    return GetBestActiveBehavior(agent, active_behavior_list);
   } else {
     return ActiveBehavior(agent, BT_None);
   }
 }
 
+void DecisionTree::Lookahead(Agent &agent, int step,
+                             std::list<ActiveBehavior> &behavior_list) {
+  TIMETEST("Lookahead");
+
+  mLookahead.Reset(agent, PlayerParam::instance().LookaheadNodeBudget());
+
+  for (std::list<ActiveBehavior>::iterator it = behavior_list.begin();
+       it != behavior_list.end(); ++it) {
+    const double evaluation = mLookahead.Evaluate(*it, step);
+    if (evaluation >= 0.0) {
+      it->mEvaluation = evaluation;
+    }
+  }
+}
+
 ActiveBehavior
 DecisionTree::GetBestActiveBehavior(Agent &agent,
                                     std::list<ActiveBehavior> &behavior_list) {
@@ -33,6 +33,7 @@
 #define DECISIONTREE_H_
 
 #include "BehaviorBase.h"
+#include "DecisionLookahead.h"
 #include <list>
 
 class Agent;
@@ -58,6 +59,12 @@ private:
    */
   ActiveBehavior Search(Agent &agent, int step);
 
+  /**
+   * 用 step 步的搜索重新评价第一步的传球和带球
+   */
+  void Lookahead(Agent &agent, int step,
+                 std::list<ActiveBehavior> &behavior_list);
+
   ActiveBehavior
   GetBestActiveBehavior(Agent &agent, std::list<ActiveBehavior> &behavior_list);
 
@@ -67,6 +74,8 @@ private:
     BehaviorDerived(agent).Plan(active_behavior_list);
     return !active_behavior_list.empty();
   }
+
+  DecisionLookahead mLookahead;
 };
 
 #endif /* DECISIONTREE_H_ */
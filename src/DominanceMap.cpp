@@ -0,0 +1,193 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#include "DominanceMap.h"
+#include "Dasher.h"
+#include "PlayerSnapshot.h"
+#include "WorldState.h"
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+namespace {
+const float UNREACHABLE = 1000.0f;
+}
+
+DominanceMap::DominanceMap(WorldState *pWorldState, InfoState *pInfoState)
+    : InfoStateBase(pWorldState, pInfoState) {
+  mStep = Max(PlayerParam::instance().DominanceGridStep(), 0.25);
+  mColumns = int(ceil(ServerParam::instance().PITCH_LENGTH / mStep));
+  mRows = int(ceil(ServerParam::instance().PITCH_WIDTH / mStep));
+  mLeft = -0.5 * mColumns * mStep;
+  mTop = -0.5 * mRows * mStep;
+
+  const int n = GetCellNum();
+  mCellX.resize(n);
+  mCellY.resize(n);
+  mDist.resize((n + 3) & ~3);
+  mOurCycle.assign(n, UNREACHABLE);
+  mOppCycle.assign(n, UNREACHABLE);
+  mOurFastest.assign(n, 0);
+  mOppFastest.assign(n, 0);
+
+  for (int j = 0; j < mRows; ++j) {
+    for (int i = 0; i < mColumns; ++i) {
+      mCellX[j * mColumns + i] = mLeft + (i + 0.5) * mStep;
+      mCellY[j * mColumns + i] = mTop + (j + 0.5) * mStep;
+    }
+  }
+}
+
+int DominanceMap::GetCellIndex(const Vector &pos) const {
+  const int i = MinMax(0, int(floor((pos.X() - mLeft) / mStep)), mColumns - 1);
+  const int j = MinMax(0, int(floor((pos.Y() - mTop) / mStep)), mRows - 1);
+  return j * mColumns + i;
+}
+
+void DominanceMap::UpdateRoutine() {
+  const PlayerSnapshot &snapshot = mpInfoState->GetPlayerSnapshot();
+
+  std::fill(mOurCycle.begin(), mOurCycle.end(), UNREACHABLE);
+  std::fill(mOppCycle.begin(), mOppCycle.end(), UNREACHABLE);
+  std::fill(mOurFastest.begin(), mOurFastest.end(), 0);
+  std::fill(mOppFastest.begin(), mOppFastest.end(), 0);
+
+  for (int index = 1; index < PlayerSnapshot::OBJECT_NUM; ++index) {
+    if (!snapshot.IsValid(index)) {
+      continue;
+    }
+    if (index <= TEAMSIZE) {
+      MergePlayer(snapshot, index, &mOurCycle[0], &mOurFastest[0]);
+    } else {
+      MergePlayer(snapshot, index, &mOppCycle[0], &mOppFastest[0]);
+    }
+  }
+}
+
+/**
+ * 从静止全力加速到接近最大速度的周期和距离折算成起跑落后的距离 lag，之后按最大速度
+ * 匀速跑，体力用完后按没体的速度跑，与 Dasher 的各阶段对应；身体方向与目标方向差超过
+ * 15 度加一个转身周期，超过一次最大转角再加一个
+ */
+void DominanceMap::MergePlayer(const PlayerSnapshot &snapshot, int index,
+                               float *cycle, Unum *fastest) {
+  const Unum unum = PlayerSnapshot::Index2Unum(index);
+  const PlayerState &player = mpWorldState->GetPlayer(unum);
+
+  const double decay = player.GetPlayerDecay();
+  const double speedmax = player.GetEffectiveSpeedMax();
+  const double accmax = player.GetDashPowerRate() * player.GetEffort() *
+                        ServerParam::instance().maxDashPower();
+
+  double speed = 0.0;
+  double dis = 0.0;
+  int acc_cyc = 0;
+  while (speed < speedmax * decay * 0.98 && acc_cyc < 100) {
+    speed = Min(speed + accmax, speedmax);
+    dis += speed;
+    speed *= decay;
+    ++acc_cyc;
+  }
+
+  //满体力阶段跑完后按没体时的速度跑，两段都是线性的，后段更慢，取两者的大值即可
+  const double stamina_recovery_thr = ServerParam::instance().recoverDecThr() *
+                                      ServerParam::instance().staminaMax();
+  const double full_cyc =
+      Max(int((player.GetStamina() - stamina_recovery_thr) /
+              (ServerParam::instance().maxDashPower() -
+               player.GetStaminaIncMax())),
+          0);
+  const double speed_tired = player.GetStaminaIncMax() * player.GetDashPowerRate() *
+                             player.GetEffort() / (1.0 - decay);
+
+  const float lag = float(acc_cyc * speedmax - dis);
+  const float inv_speed = float(1.0 / speedmax);
+  const float tired_cyc = float(full_cyc - full_cyc * speedmax / speed_tired);
+  const float inv_speed_tired = float(1.0 / speed_tired);
+  const float kick_area = float(
+      player.IsGoalie() ? ServerParam::instance().catchAreaLength()
+                        : player.GetKickableArea() - Dasher::GETBALL_BUFFER);
+  const float px = float(snapshot.GetX()[index] + snapshot.GetVelX()[index]);
+  const float py = float(snapshot.GetY()[index] + snapshot.GetVelY()[index]);
+
+  float bx = 0.0f, by = 0.0f;
+  float cos_one = -2.0f, cos_two = -2.0f; //身体方向不可信时认为不用转身
+  if (player.IsBodyDirValid()) {
+    bx = float(Cos(snapshot.GetBodyDir()[index]));
+    by = float(Sin(snapshot.GetBodyDir()[index]));
+    cos_one = float(Cos(15.0));
+    cos_two = float(Cos(Max(player.GetMaxTurnAngle(), 15.0)));
+  }
+
+  const int n = GetCellNum();
+  const float *cell_x = &mCellX[0];
+  const float *cell_y = &mCellY[0];
+  float *dist = &mDist[0];
+
+  for (int i = 0; i < n; ++i) {
+    const float dx = cell_x[i] - px;
+    const float dy = cell_y[i] - py;
+    dist[i] = dx * dx + dy * dy;
+  }
+
+  // sqrtf 要设 errno，编译器不会自动向量化，这里显式用 SSE
+#ifdef __SSE__
+  for (int i = 0; i < n; i += 4) { // mDist 已补齐到 4 的倍数
+    _mm_storeu_ps(dist + i, _mm_sqrt_ps(_mm_loadu_ps(dist + i)));
+  }
+#else
+  for (int i = 0; i < n; ++i) {
+    dist[i] = sqrtf(dist[i]);
+  }
+#endif
+
+  // 写成无分支的算术和选择，下面两个循环都能向量化
+  for (int i = 0; i < n; ++i) {
+    const float dx = cell_x[i] - px;
+    const float dy = cell_y[i] - py;
+    const float d = dist[i];
+    const float dot = dx * bx + dy * by;
+    const float far = float(d > kick_area);
+
+    const float run = Max(d - kick_area, 0.0f) + lag;
+    const float t = Max(run * inv_speed, tired_cyc + run * inv_speed_tired) +
+                    float(dot < cos_one * d) + float(dot < cos_two * d);
+    dist[i] = 1.0f + far * (t - 1.0f); //在可踢范围内为1周期
+  }
+
+  for (int i = 0; i < n; ++i) {
+    const bool faster = dist[i] < cycle[i];
+    cycle[i] = Min(dist[i], cycle[i]);
+    fastest[i] = faster ? unum : fastest[i];
+  }
+}
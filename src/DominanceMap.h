@@ -0,0 +1,110 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#ifndef __DominanceMap_H__
+#define __DominanceMap_H__
+
+#include "InfoState.h"
+#include <vector>
+
+/**
+ * 球场网格上双方最快到达各格子中心的周期数（控制区域）
+ * 每名球员用线性跑动模型：(距离 + 加速滞后) / 最大速度 + 转身周期，按格子连续存放以便向量化
+ * Dominance-region map: for every cell of a pitch grid, the minimum arrival
+ * cycle of each team. Each player uses a linear run model, distance plus the
+ * acceleration lag over the effective max speed, plus turn cycles, so the
+ * per-player loops over the contiguous cell arrays vectorize.
+ */
+class DominanceMap : public InfoStateBase {
+public:
+  DominanceMap(WorldState *pWorldState, InfoState *pInfoState);
+
+  int GetColumns() const { return mColumns; }
+  int GetRows() const { return mRows; }
+  int GetCellNum() const { return mColumns * mRows; }
+  double GetStep() const { return mStep; }
+
+  /** 点所在格子的下标，场外的点取最近的格子 */
+  int GetCellIndex(const Vector &pos) const;
+  Vector GetCellCenter(int index) const {
+    return Vector(mCellX[index], mCellY[index]);
+  }
+
+  /** 按格子下标排列的到达周期数组 */
+  const float *GetOurCycles() const { return &mOurCycle[0]; }
+  const float *GetOppCycles() const { return &mOppCycle[0]; }
+
+  double GetOurCycle(const Vector &pos) const {
+    return mOurCycle[GetCellIndex(pos)];
+  }
+  double GetOppCycle(const Vector &pos) const {
+    return mOppCycle[GetCellIndex(pos)];
+  }
+
+  /** 对手比我方晚到的周期数，正表示我方控制 */
+  double GetDominance(const Vector &pos) const {
+    const int index = GetCellIndex(pos);
+    return mOppCycle[index] - mOurCycle[index];
+  }
+  bool IsOurs(const Vector &pos) const { return GetDominance(pos) > 0.0; }
+
+  /** 最快到达的队友和对手（负号码），没有则为0 */
+  Unum GetOurFastest(const Vector &pos) const {
+    return mOurFastest[GetCellIndex(pos)];
+  }
+  Unum GetOppFastest(const Vector &pos) const {
+    return mOppFastest[GetCellIndex(pos)];
+  }
+
+private:
+  void UpdateRoutine();
+
+  /** 把快照中第 index 个球员的到达周期并入 cycle/fastest */
+  void MergePlayer(const PlayerSnapshot &snapshot, int index, float *cycle,
+                   Unum *fastest);
+
+private:
+  double mStep;
+  double mLeft;
+  double mTop;
+  int mColumns;
+  int mRows;
+
+  std::vector<float> mCellX;
+  std::vector<float> mCellY;
+  std::vector<float> mDist;
+  std::vector<float> mOurCycle;
+  std::vector<float> mOppCycle;
+  std::vector<Unum> mOurFastest;
+  std::vector<Unum> mOppFastest;
+};
+
+#endif
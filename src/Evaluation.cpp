@@ -33,12 +33,59 @@
 #include "Agent.h"
 #include "InfoState.h"
 #include "Net.h"
+#include "PlayerParam.h"
 #include "PositionInfo.h"
 #include "ServerParam.h"
 #include "Strategy.h"
 #include "WorldState.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#ifndef WIN32
+#include <unistd.h>
+#endif
 
-Evaluation::Evaluation() { mSensitivityNet = new Net("data/sensitivity.net"); }
+namespace {
+const char *SENSITIVITY_NET_FILE = "data/sensitivity.net";
+const char *LATTICE_FILE = "data/sensitivity.lattice";
+const char LATTICE_MAGIC[4] = {'W', 'E', 'P', 'L'};
+const int LATTICE_VERSION = 1;
+
+/** 网格在球场外留出的边缘 */
+const double LATTICE_MARGIN = 5.0;
+
+/** FNV-1a */
+unsigned Checksum(const void *data, size_t size,
+                  unsigned hash = 2166136261u) {
+  const unsigned char *p = (const unsigned char *)data;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ p[i]) * 16777619u;
+  }
+  return hash;
+}
+
+unsigned FileChecksum(const char *file_name) {
+  std::ifstream in_file(file_name, std::ios::binary);
+  std::ostringstream content;
+  content << in_file.rdbuf();
+  const std::string &data = content.str();
+  return Checksum(data.data(), data.size());
+}
+} // namespace
+
+Evaluation::Evaluation()
+    : mLatticeColumns(0), mLatticeRows(0), mLatticeLeft(0.0),
+      mLatticeStep(0.0), mLatticeScale(0.0) {
+  mSensitivityNet = new Net(SENSITIVITY_NET_FILE);
+
+  if (PlayerParam::instance().EvaluationLatticeStep() > FLOAT_EPS) {
+    BuildLattice(PlayerParam::instance().EvaluationLatticeStep());
+    if (PlayerParam::instance().EvaluationCheck()) {
+      CheckLattice();
+    }
+  }
+}
 
 Evaluation::~Evaluation() { delete mSensitivityNet; }
 
@@ -48,8 +95,41 @@ Evaluation &Evaluation::instance() {
 }
 
 double Evaluation::EvaluatePosition(const Vector &pos, bool ourside) {
-  static double input[2];
-  static double output[1];
+  const double gx =
+      ((ourside ? pos.X() : -pos.X()) - mLatticeLeft) * mLatticeScale;
+  const double gy = fabs(pos.Y()) * mLatticeScale;
+
+  if (gx >= 0.0 && gx < mLatticeColumns - 1 && gy < mLatticeRows - 1) {
+    const int ix = (int)gx;
+    const int iy = (int)gy;
+    const double fx = gx - ix;
+    const double fy = gy - iy;
+    const float *p = &mLattice[ix * mLatticeRows + iy];
+    const float *q = p + mLatticeRows;
+
+    const double a = p[0] + (p[1] - p[0]) * fy;
+    const double b = q[0] + (q[1] - q[0]) * fy;
+    return a + (b - a) * fx;
+  }
+
+  return RunSensitivityNet(pos, ourside);
+}
+
+/**
+ * 批量评价，供规划器一次评价所有候选
+ */
+void Evaluation::EvaluatePosition(int size, const Vector *pos, bool ourside,
+                                  double *evaluation) {
+  for (int i = 0; i < size; ++i) {
+    evaluation[i] = EvaluatePosition(pos[i], ourside);
+  }
+}
+
+double Evaluation::RunSensitivityNet(const Vector &pos, bool ourside) {
+  mNetMutex.Lock();
+
+  static real input[2];
+  static real output[1];
 
   input[0] = pos.X() / (ServerParam::instance().PITCH_LENGTH * 0.5);
   input[1] =
@@ -58,6 +138,155 @@ double Evaluation::EvaluatePosition(const Vector &pos, bool ourside) {
     input[0] *= -1.0;
   }
   mSensitivityNet->Run(input, output);
+  const double ret = output[0];
+  mNetMutex.UnLock();
+
+  return ret;
+}
+
+/**
+ * 读入或重新计算位置评价网格，网络文件或网格参数改变时重算
+ * Load the lattice from data/, or sample the net again if it is stale.
+ */
+void Evaluation::BuildLattice(double step) {
+  const double half_length =
+      ServerParam::instance().PITCH_LENGTH * 0.5 + LATTICE_MARGIN;
+  const double half_width =
+      ServerParam::instance().PITCH_WIDTH * 0.5 + LATTICE_MARGIN;
+
+  mLatticeStep = step;
+  mLatticeScale = 1.0 / step;
+  mLatticeLeft = -half_length;
+  mLatticeColumns = (int)ceil(2.0 * half_length / step) + 1;
+  mLatticeRows = (int)ceil(half_width / step) + 1;
+
+  const unsigned net_checksum = FileChecksum(SENSITIVITY_NET_FILE);
+  if (LoadLattice(LATTICE_FILE, net_checksum)) {
+    return;
+  }
+
+  //每次把一列送进网络批量计算
+  std::vector<real> input(2 * mLatticeRows), output(mLatticeRows);
+  std::vector<real *> inputs(mLatticeRows), outputs(mLatticeRows);
+  for (int iy = 0; iy < mLatticeRows; ++iy) {
+    inputs[iy] = &input[2 * iy];
+    outputs[iy] = &output[iy];
+  }
+
+  mLattice.resize(mLatticeColumns * mLatticeRows);
+  for (int ix = 0; ix < mLatticeColumns; ++ix) {
+    for (int iy = 0; iy < mLatticeRows; ++iy) {
+      input[2 * iy] = (mLatticeLeft + ix * step) /
+                      (ServerParam::instance().PITCH_LENGTH * 0.5);
+      input[2 * iy + 1] = (iy * step) /
+                              (ServerParam::instance().PITCH_WIDTH * 0.5) *
+                              2.0 -
+                          1.0;
+    }
+    mSensitivityNet->Run(mLatticeRows, &inputs[0], &outputs[0]);
+    for (int iy = 0; iy < mLatticeRows; ++iy) {
+      mLattice[ix * mLatticeRows + iy] = (float)output[iy];
+    }
+  }
+
+  SaveLattice(LATTICE_FILE, net_checksum);
+}
+
+bool Evaluation::LoadLattice(const std::string &file_name,
+                             unsigned net_checksum) {
+  std::ifstream in_file(file_name.c_str(), std::ios::binary);
+  LatticeHeader header;
+  if (!in_file || !in_file.read((char *)&header, sizeof(header))) {
+    return false;
+  }
+
+  if (memcmp(header.mMagic, LATTICE_MAGIC, 4) != 0 ||
+      header.mVersion != LATTICE_VERSION ||
+      header.mColumns != mLatticeColumns || header.mRows != mLatticeRows ||
+      header.mLeft != mLatticeLeft || header.mStep != mLatticeStep ||
+      header.mNetChecksum != net_checksum) {
+    return false;
+  }
+
+  std::vector<float> lattice(mLatticeColumns * mLatticeRows);
+  if (!in_file.read((char *)&lattice[0], lattice.size() * sizeof(float)) ||
+      header.mChecksum !=
+          Checksum(&lattice[0], lattice.size() * sizeof(float))) {
+    return false;
+  }
+
+  mLattice.swap(lattice);
+  return true;
+}
+
+void Evaluation::SaveLattice(const std::string &file_name,
+                             unsigned net_checksum) {
+  LatticeHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.mMagic, LATTICE_MAGIC, 4);
+  header.mVersion = LATTICE_VERSION;
+  header.mColumns = mLatticeColumns;
+  header.mRows = mLatticeRows;
+  header.mLeft = mLatticeLeft;
+  header.mStep = mLatticeStep;
+  header.mNetChecksum = net_checksum;
+  header.mChecksum = Checksum(&mLattice[0], mLattice.size() * sizeof(float));
+
+  //先写临时文件再改名，多个球员同时启动时不会读到写了一半的文件
+  std::ostringstream tmp_name;
+  tmp_name << file_name << ".";
+#ifndef WIN32
+  tmp_name << getpid();
+#endif
+  tmp_name << ".tmp";
+
+  std::ofstream out_file(tmp_name.str().c_str(), std::ios::binary);
+  out_file.write((char *)&header, sizeof(header));
+  out_file.write((char *)&mLattice[0], mLattice.size() * sizeof(float));
+  out_file.close();
+
+#ifdef WIN32
+  remove(file_name.c_str());
+#endif
+  if (!out_file || rename(tmp_name.str().c_str(), file_name.c_str()) != 0) {
+    PRINT_ERROR("write sensitivity lattice error");
+    remove(tmp_name.str().c_str());
+  }
+}
+
+/**
+ * 比较网格插值与网络的输出，取每个格子的中心（误差最大处）和四分点
+ * Report how far the interpolated lattice is from the net.
+ */
+void Evaluation::CheckLattice() {
+  static const double offset[2][2] = {{0.5, 0.5}, {0.25, 0.75}};
+
+  double max_error = 0.0;
+  double sum_error = 0.0;
+  int count = 0;
+  Vector worst;
+
+  for (int ix = 0; ix < mLatticeColumns - 1; ++ix) {
+    for (int iy = 0; iy < mLatticeRows - 1; ++iy) {
+      for (int k = 0; k < 2; ++k) {
+        const Vector pos(mLatticeLeft + (ix + offset[k][0]) * mLatticeStep,
+                         (iy + offset[k][1]) * mLatticeStep);
+
+        const double error =
+            fabs(EvaluatePosition(pos, true) - RunSensitivityNet(pos, true));
+        sum_error += error;
+        ++count;
+        if (error > max_error) {
+          max_error = error;
+          worst = pos;
+        }
+      }
+    }
+  }
 
-  return output[0];
+  std::cout << "sensitivity lattice " << mLatticeColumns << "x"
+            << mLatticeRows << " step " << mLatticeStep << ": max error "
+            << max_error << " at " << worst << ", mean error "
+            << sum_error / count << " over " << count << " points"
+            << std::endl;
 }
@@ -33,6 +33,9 @@
 #define __Evaluation_H__
 
 #include "Geometry.h"
+#include "Thread.h"
+#include <string>
+#include <vector>
 class Net;
 
 class Evaluation {
@@ -43,10 +46,47 @@ public:
 
   static Evaluation &instance();
 
+  /**
+   * 位置评价 -- 在网格内时对网格做双线性插值，否则直接运行网络
+   */
   double EvaluatePosition(const Vector &pos, bool ourside);
+  void EvaluatePosition(int size, const Vector *pos, bool ourside,
+                        double *evaluation);
+
+private:
+  double RunSensitivityNet(const Vector &pos, bool ourside);
+
+  /**
+   * sensitivity.net 在球场上的采样网格，x 为我方视角下的坐标，y 为 |y|
+   * Lattice of sensitivity.net over the pitch, cached in data/.
+   */
+  struct LatticeHeader {
+    char mMagic[4];        /** "WEPL" */
+    int mVersion;          /** LATTICE_VERSION */
+    int mColumns;          /** x 方向的点数 */
+    int mRows;             /** |y| 方向的点数 */
+    double mLeft;          /** 第一列的 x */
+    double mStep;          /** 网格间距 */
+    unsigned mNetChecksum; /** 网络文件的校验值 */
+    unsigned mChecksum;    /** 数据部分的校验值 */
+    int mReserved[6];      /** 保持头部为64字节 */
+  };
+
+  void BuildLattice(double step);
+  bool LoadLattice(const std::string &file_name, unsigned net_checksum);
+  void SaveLattice(const std::string &file_name, unsigned net_checksum);
+  void CheckLattice();
 
 private:
   Net *mSensitivityNet;
+  ThreadMutex mNetMutex; //网络的输入输出是共享的，并行规划时要加锁
+
+  std::vector<float> mLattice; //按列存放，mLattice[ix * mLatticeRows + iy]
+  int mLatticeColumns;
+  int mLatticeRows;
+  double mLatticeLeft;
+  double mLatticeStep;
+  double mLatticeScale; // 1.0 / mLatticeStep
 };
 
 #endif
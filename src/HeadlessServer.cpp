@@ -0,0 +1,461 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#include "HeadlessServer.h"
+#include "Dasher.h"
+#include "PlayerParam.h"
+#include "ServerParam.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+/**
+ * 左边球队的开球站位，右边球队取中心对称
+ */
+const double HOME_POS[TEAMSIZE + 1][2] = {
+    {0.0, 0.0},     {-50.0, 0.0},   {-36.0, -18.0}, {-38.0, -6.0},
+    {-38.0, 6.0},   {-36.0, 18.0},  {-22.0, -12.0}, {-24.0, 0.0},
+    {-22.0, 12.0},  {-10.0, -20.0}, {-10.0, 0.0},   {-10.0, 20.0}};
+
+const char *ViewWidthName(const ViewWidth view_width) {
+  switch (view_width) {
+  case VW_Narrow:
+    return "narrow";
+  case VW_Wide:
+    return "wide";
+  default:
+    return "normal";
+  }
+}
+
+bool IsCommand(const char *name, const int len, const char *cmd) {
+  return static_cast<int>(strlen(cmd)) == len && !strncmp(name, cmd, len);
+}
+
+/**
+ * 读取命令的下一个数值参数，没有则返回默认值，不会越过命令结尾的')'
+ */
+double GetArg(char **str_ptr, const double default_value = 0.0) {
+  while (**str_ptr == ' ')
+    ++(*str_ptr);
+  if (**str_ptr == ')' || **str_ptr == '\0') {
+    return default_value;
+  }
+  return parser::get_double(str_ptr);
+}
+
+void ClampBallVel(Vector &vel) {
+  if (vel.Mod() > ServerParam::instance().ballSpeedMax()) {
+    vel = Polar2Vector(ServerParam::instance().ballSpeedMax(), vel.Dir());
+  }
+}
+} // namespace
+
+HeadlessServer::PlayerInfo::PlayerInfo()
+    : mBody(Vector(0.0, 0.0), Vector(0.0, 0.0), 0.0, 0), mNeckDir(0.0),
+      mIsGoalie(false), mViewWidth(VW_Normal), mBodyCmd(CT_None),
+      mBodyArg1(0.0), mBodyArg2(0.0), mTurnNeck(0.0), mKicks(0), mDashes(0),
+      mTurns(0), mSays(0), mTurnNecks(0), mCatchs(0), mMoves(0),
+      mChangeViews(0), mPoints(0), mFocuses(0), mTackles(0) {}
+
+HeadlessServer::HeadlessServer(Unum self_unum)
+    : mSelfUnum(self_unum), mCycle(0), mBeforeKickOff(true),
+      mBall(Vector(0.0, 0.0), Vector(0.0, 0.0)) {
+  Assert(mSelfUnum >= 1 && mSelfUnum <= TEAMSIZE);
+
+  mScore[0] = mScore[1] = 0;
+
+  for (int side = 0; side < 2; ++side) {
+    const double sign = (side == 0) ? 1.0 : -1.0;
+    for (Unum i = 1; i <= TEAMSIZE; ++i) {
+      PlayerInfo &player = mPlayers[side][i];
+      player.mHome = Vector(HOME_POS[i][0] * sign, HOME_POS[i][1] * sign);
+      player.mIsGoalie =
+          (side == 0) ? i == PlayerParam::instance().ourGoalieUnum() : i == 1;
+      player.mBody.RecoverAll();
+    }
+  }
+
+  KickOff();
+}
+
+HeadlessServer::~HeadlessServer() {}
+
+void HeadlessServer::KickOff() {
+  mBall.mPos = Vector(0.0, 0.0);
+  mBall.mVel = Vector(0.0, 0.0);
+
+  for (int side = 0; side < 2; ++side) {
+    for (Unum i = 1; i <= TEAMSIZE; ++i) {
+      PlayerInfo &player = mPlayers[side][i];
+      player.mBody.mPos = player.mHome;
+      player.mBody.mVel = Vector(0.0, 0.0);
+      player.mBody.mBodyDir = (side == 0) ? 0.0 : 180.0;
+      player.mNeckDir = 0.0;
+    }
+  }
+
+  mBeforeKickOff = true;
+}
+
+void HeadlessServer::MakeInitMsg(char *msg) const {
+  sprintf(msg, "(init l %d before_kick_off)", mSelfUnum);
+}
+
+void HeadlessServer::MakeSenseBodyMsg(char *msg) const {
+  const PlayerInfo &self = Self();
+  const AngleDeg neck_global =
+      GetNormalizeAngleDeg(self.mBody.mBodyDir + self.mNeckDir);
+
+  sprintf(msg,
+          "(sense_body %d (view_mode high %s) (stamina %.4f %.6f %.1f) "
+          "(speed %.4f %.4f) (head_angle %.4f) (kick %d) (dash %d) (turn %d) "
+          "(say %d) (turn_neck %d) (catch %d) (move %d) (change_view %d) "
+          "(arm (movable 0) (expires 0) (target 0 0) (count %d)) "
+          "(focus (target none) (count %d)) (tackle (expires 0) (count %d)) "
+          "(collision none) (foul (charged 0) (card none)))",
+          mCycle, ViewWidthName(self.mViewWidth),
+          static_cast<double>(self.mBody.mStamina), self.mBody.mEffort,
+          ServerParam::instance().staminaCapacity(), self.mBody.mVel.Mod(),
+          GetNormalizeAngleDeg(self.mBody.mVel.Dir() - neck_global),
+          self.mNeckDir, self.mKicks, self.mDashes, self.mTurns, self.mSays,
+          self.mTurnNecks, self.mCatchs, self.mMoves, self.mChangeViews,
+          self.mPoints, self.mFocuses, self.mTackles);
+}
+
+void HeadlessServer::MakeFullstateMsg(char *msg) const {
+  const PlayerInfo &self = Self();
+  char *p = msg;
+
+  p += sprintf(p,
+               "(fullstate %d (pmode %s) (vmode high %s) "
+               "(count %d %d %d %d %d %d %d %d) "
+               "(arm (movable 0) (expires 0) (target 0 0) (count %d)) "
+               "(score %d %d) ((b) %.4f %.4f %.4f %.4f)",
+               mCycle, mBeforeKickOff ? "before_kick_off" : "play_on",
+               ViewWidthName(self.mViewWidth), self.mKicks, self.mDashes,
+               self.mTurns, self.mCatchs, self.mMoves, self.mTurnNecks,
+               self.mChangeViews, self.mSays, self.mPoints, mScore[0],
+               mScore[1], mBall.mPos.X(), mBall.mPos.Y(), mBall.mVel.X(),
+               mBall.mVel.Y());
+
+  for (int side = 0; side < 2; ++side) {
+    for (Unum i = 1; i <= TEAMSIZE; ++i) {
+      const PlayerInfo &player = mPlayers[side][i];
+      p += sprintf(p,
+                   " ((p %c %d%s %d) %.4f %.4f %.4f %.4f %.4f %.4f "
+                   "(stamina %.4f %.6f 1 %.1f))",
+                   (side == 0) ? 'l' : 'r', i, player.mIsGoalie ? " g" : "",
+                   player.mBody.mPlayerType, player.mBody.mPos.X(),
+                   player.mBody.mPos.Y(), player.mBody.mVel.X(),
+                   player.mBody.mVel.Y(),
+                   GetNormalizeAngleDeg(player.mBody.mBodyDir),
+                   player.mNeckDir, static_cast<double>(player.mBody.mStamina),
+                   player.mBody.mEffort,
+                   ServerParam::instance().staminaCapacity());
+    }
+  }
+
+  sprintf(p, ")");
+}
+
+void HeadlessServer::ExecuteCommands(char *msg) {
+  PlayerInfo &self = Self();
+  char *p = msg;
+
+  while ((p = strchr(p, '(')) != 0) {
+    const char *name = ++p;
+    while (isalpha(*p) || *p == '_')
+      ++p;
+    const int len = p - name;
+
+    if (IsCommand(name, len, "turn_neck")) {
+      self.mTurnNeck += GetArg(&p);
+      ++self.mTurnNecks;
+    } else if (IsCommand(name, len, "change_view")) {
+      while (*p == ' ')
+        ++p;
+      switch (p[1]) {
+      case 'a':
+        self.mViewWidth = VW_Narrow;
+        break;
+      case 'i':
+        self.mViewWidth = VW_Wide;
+        break;
+      default:
+        self.mViewWidth = VW_Normal;
+        break;
+      }
+      ++self.mChangeViews;
+    } else if (IsCommand(name, len, "say")) {
+      char *quote = strchr(p, '"');
+      if (quote != 0 && (quote = strchr(quote + 1, '"')) != 0) {
+        p = quote + 1; // 跳过引号里的内容，其中可能含有括号
+      }
+      ++self.mSays;
+    } else if (IsCommand(name, len, "pointto")) {
+      ++self.mPoints;
+    } else if (IsCommand(name, len, "attentionto")) {
+      ++self.mFocuses;
+    } else if (self.mBodyCmd == CT_None) { // 身体动作每周期只执行第一个
+      if (IsCommand(name, len, "dash")) {
+        self.mBodyCmd = CT_Dash;
+      } else if (IsCommand(name, len, "turn")) {
+        self.mBodyCmd = CT_Turn;
+      } else if (IsCommand(name, len, "kick")) {
+        self.mBodyCmd = CT_Kick;
+      } else if (IsCommand(name, len, "tackle")) {
+        self.mBodyCmd = CT_Tackle;
+      } else if (IsCommand(name, len, "catch")) {
+        self.mBodyCmd = CT_Catch;
+      } else if (IsCommand(name, len, "move")) {
+        self.mBodyCmd = CT_Move;
+      }
+
+      if (self.mBodyCmd != CT_None) {
+        self.mBodyArg1 = GetArg(&p);
+        self.mBodyArg2 = GetArg(&p);
+      }
+    }
+
+    p = strchr(p, ')');
+    if (p == 0) {
+      break;
+    }
+  }
+}
+
+void HeadlessServer::Step() {
+  for (int side = 0; side < 2; ++side) {
+    Unum chaser = 0;
+    double min_dist = 1000.0;
+    for (Unum i = 1; i <= TEAMSIZE; ++i) {
+      const PlayerInfo &player = mPlayers[side][i];
+      const double dist = player.mBody.mPos.Dist(mBall.mPos);
+      if (player.mIsGoalie && player.mHome.Dist(mBall.mPos) > 16.0) {
+        continue; // 守门员只在球靠近球门时出击
+      }
+      if (dist < min_dist) {
+        min_dist = dist;
+        chaser = i;
+      }
+    }
+
+    for (Unum i = 1; i <= TEAMSIZE; ++i) {
+      if (side == 0 && i == mSelfUnum) {
+        continue;
+      }
+      ScriptPlayer(side, i, i == chaser);
+    }
+  }
+
+  for (int side = 0; side < 2; ++side) {
+    for (Unum i = 1; i <= TEAMSIZE; ++i) {
+      ActPlayer(mPlayers[side][i], side);
+    }
+  }
+
+  if (!mBeforeKickOff) {
+    mBall.RandomizedStep();
+  }
+
+  Referee();
+
+  ++mCycle;
+}
+
+void HeadlessServer::ScriptPlayer(int side, Unum unum, bool is_chaser) {
+  PlayerInfo &player = mPlayers[side][unum];
+  const Simulator::Player &body = player.mBody;
+
+  if (mBeforeKickOff) {
+    return;
+  }
+
+  const double sign = (side == 0) ? 1.0 : -1.0; // 进攻方向
+  const double half_length = ServerParam::PITCH_LENGTH * 0.5;
+
+  if (body.mPos.Dist(mBall.mPos) <
+      PlayerParam::instance().HeteroPlayer(body.mPlayerType).kickableArea()) {
+    player.mBodyCmd = CT_Kick;
+    player.mBodyArg1 = ServerParam::instance().maxPower();
+    player.mBodyArg2 = GetNormalizeAngleDeg(
+        (Vector(sign * half_length, 0.0) - body.mPos).Dir() - body.mBodyDir);
+    return;
+  }
+
+  Vector target;
+  double power = 60.0;
+  if (is_chaser) {
+    target = mBall.mPos + mBall.mVel;
+    power = ServerParam::instance().maxDashPower();
+  } else if (player.mIsGoalie) {
+    const double half_goal = ServerParam::instance().goalWidth() * 0.5;
+    target =
+        Vector(player.mHome.X(), MinMax(-half_goal, mBall.mPos.Y(), half_goal));
+  } else {
+    target = player.mHome +
+             Vector(mBall.mPos.X() * 0.5 + sign * 10.0, mBall.mPos.Y() * 0.25);
+  }
+
+  if (body.mPos.Dist(target) < 1.0) {
+    return;
+  }
+
+  const AngleDeg angle =
+      GetNormalizeAngleDeg((target - body.mPos).Dir() - body.mBodyDir);
+  if (fabs(angle) > 15.0) {
+    player.mBodyCmd = CT_Turn;
+    player.mBodyArg1 =
+        angle * (1.0 + PlayerParam::instance()
+                               .HeteroPlayer(body.mPlayerType)
+                               .inertiaMoment() *
+                           body.mVel.Mod());
+  } else {
+    player.mBodyCmd = CT_Dash;
+    player.mBodyArg1 = power;
+    player.mBodyArg2 = 0.0;
+  }
+}
+
+void HeadlessServer::ActPlayer(PlayerInfo &player, const int side) {
+  Simulator::Player &body = player.mBody;
+  const int type = body.mPlayerType;
+
+  switch (player.mBodyCmd) {
+  case CT_Dash: {
+    const AngleDeg dir = GetNormalizeAngleDeg(player.mBodyArg2);
+    int idx = 0;
+    for (int i = 1; i < 8; ++i) {
+      if (GetAngleDegDiffer(dir, Dasher::DASH_DIR[i]) <
+          GetAngleDegDiffer(dir, Dasher::DASH_DIR[idx])) {
+        idx = i;
+      }
+    }
+    body.Dash(player.mBodyArg1, idx);
+    ++player.mDashes;
+  } break;
+  case CT_Turn:
+    body.Turn(player.mBodyArg1);
+    ++player.mTurns;
+    break;
+  case CT_Kick: {
+    const Vector ball_2_player =
+        (mBall.mPos - body.mPos).Rotate(-body.mBodyDir);
+    if (ball_2_player.Mod() <
+        PlayerParam::instance().HeteroPlayer(type).kickableArea()) {
+      const double power =
+          MinMax(0.0, player.mBodyArg1, ServerParam::instance().maxPower());
+      Vector accel =
+          Polar2Vector(power * GetKickRate(ball_2_player, type),
+                       GetNormalizeAngleDeg(body.mBodyDir + player.mBodyArg2));
+      if (accel.Mod() > ServerParam::instance().ballAccelMax()) {
+        accel = Polar2Vector(ServerParam::instance().ballAccelMax(),
+                             accel.Dir());
+      }
+      mBall.mVel += accel;
+      ClampBallVel(mBall.mVel);
+    }
+    body.Step();
+    ++player.mKicks;
+  } break;
+  case CT_Tackle: {
+    if (drand48() < GetTackleProb(mBall.mPos, body.mPos, body.mBodyDir, false)) {
+      const AngleDeg dir = GetNormalizeAngleDeg(player.mBodyArg1);
+      const double power =
+          ServerParam::instance().maxBackTacklePower() +
+          (ServerParam::instance().maxTacklePower() -
+           ServerParam::instance().maxBackTacklePower()) *
+              (1.0 - fabs(dir) / 180.0);
+      mBall.mVel += Polar2Vector(
+          power * ServerParam::instance().tacklePowerRate(),
+          GetNormalizeAngleDeg(body.mBodyDir + dir));
+      ClampBallVel(mBall.mVel);
+    }
+    body.Step();
+    ++player.mTackles;
+  } break;
+  case CT_Catch:
+    if (player.mIsGoalie &&
+        body.mPos.Dist(mBall.mPos) < ServerParam::instance().maxCatchableArea()) {
+      mBall.mVel = Vector(0.0, 0.0);
+    }
+    body.Step();
+    ++player.mCatchs;
+    break;
+  case CT_Move:
+    if (mBeforeKickOff) {
+      body.mPos = Vector(player.mBodyArg1, player.mBodyArg2) *
+                  ((side == 0) ? 1.0 : -1.0);
+      body.mVel = Vector(0.0, 0.0);
+    }
+    ++player.mMoves;
+    break;
+  default:
+    body.Step();
+    break;
+  }
+
+  if (player.mTurnNeck != 0.0) {
+    player.mNeckDir = MinMax(ServerParam::instance().minNeckAngle(),
+                             player.mNeckDir + player.mTurnNeck,
+                             ServerParam::instance().maxNeckAngle());
+    player.mTurnNeck = 0.0;
+  }
+
+  player.mBodyCmd = CT_None;
+}
+
+void HeadlessServer::Referee() {
+  if (mBeforeKickOff) {
+    mBeforeKickOff = false;
+    return;
+  }
+
+  const double half_length = ServerParam::PITCH_LENGTH * 0.5;
+  const double half_width = ServerParam::PITCH_WIDTH * 0.5;
+  const Vector &ball = mBall.mPos;
+
+  if (fabs(ball.X()) > half_length &&
+      fabs(ball.Y()) < ServerParam::instance().goalWidth() * 0.5) {
+    ++mScore[(ball.X() > 0.0) ? 0 : 1];
+    KickOff();
+  } else if (fabs(ball.X()) > half_length || fabs(ball.Y()) > half_width) {
+    // 出界后直接把球放回场内，保持play_on
+    mBall.mPos =
+        Vector(MinMax(-half_length + 1.0, ball.X(), half_length - 1.0),
+               MinMax(-half_width + 1.0, ball.Y(), half_width - 1.0));
+    mBall.mVel = Vector(0.0, 0.0);
+  }
+}
+
+// end of HeadlessServer.cpp
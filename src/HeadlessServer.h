@@ -0,0 +1,121 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#ifndef HEADLESSSERVER_H_
+#define HEADLESSSERVER_H_
+
+#include "BasicCommand.h"
+#include "Simulator.h"
+#include "Types.h"
+
+/**
+ * 离线无头模式下的本地server替身，在进程内模拟一场比赛，不需要rcssserver和网络。
+ * 物理模型复用Simulator和ServerParam，每周期为agent生成sense_body和fullstate信息，
+ * 并执行agent发出的命令，其余21名球员由简单的脚本控制。
+ * In-process stand-in for rcssserver used by the headless mode. Physics reuses
+ * Simulator and ServerParam; the agent is fed sense_body and fullstate
+ * messages each cycle, and the other 21 players are driven by a simple script.
+ */
+class HeadlessServer {
+public:
+  /**
+   * @param self_unum 被测agent的号码，agent总在左边
+   */
+  HeadlessServer(Unum self_unum);
+  ~HeadlessServer();
+
+  /**
+   * 生成各类server信息，格式与rcssserver一致，可直接交给Parser::Parse
+   */
+  void MakeInitMsg(char *msg) const;
+  void MakeSenseBodyMsg(char *msg) const;
+  void MakeFullstateMsg(char *msg) const;
+
+  /**
+   * 解析agent本周期发出的命令串，如"(dash 100 0)(turn_neck 10)"
+   */
+  void ExecuteCommands(char *msg);
+
+  /**
+   * 推进一个周期：脚本球员决策，执行所有动作，球运动，裁判
+   */
+  void Step();
+
+  int CurrentCycle() const { return mCycle; }
+  int OurScore() const { return mScore[0]; }
+  int OppScore() const { return mScore[1]; }
+
+private:
+  struct PlayerInfo {
+    Simulator::Player mBody;
+    AngleDeg mNeckDir; // 相对于身体
+    Vector mHome;
+    bool mIsGoalie;
+    ViewWidth mViewWidth;
+
+    CommandType mBodyCmd; // 本周期的身体动作，每周期最多一个
+    double mBodyArg1;
+    double mBodyArg2;
+    AngleDeg mTurnNeck;
+
+    int mKicks;
+    int mDashes;
+    int mTurns;
+    int mSays;
+    int mTurnNecks;
+    int mCatchs;
+    int mMoves;
+    int mChangeViews;
+    int mPoints;
+    int mFocuses;
+    int mTackles;
+
+    PlayerInfo();
+  };
+
+  void KickOff();
+  void ScriptPlayer(int side, Unum unum, bool is_chaser);
+  void ActPlayer(PlayerInfo &player, const int side);
+  void Referee();
+
+  PlayerInfo &Self() { return mPlayers[0][mSelfUnum]; }
+  const PlayerInfo &Self() const { return mPlayers[0][mSelfUnum]; }
+
+  Unum mSelfUnum;
+  int mCycle;
+  bool mBeforeKickOff;
+  int mScore[2];
+
+  Simulator::Ball mBall;
+  PlayerInfo mPlayers[2][TEAMSIZE + 1]; // [0]为左边，[1]为右边，下标为号码
+};
+
+#endif /* HEADLESSSERVER_H_ */
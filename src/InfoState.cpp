@@ -30,17 +30,28 @@
  ************************************************************************************/
 
 #include "InfoState.h"
+#include "DominanceMap.h"
 #include "InterceptInfo.h"
+#include "PlayerSnapshot.h"
 #include "PositionInfo.h"
 
 InfoState::InfoState(WorldState *world_state) {
+  mpPlayerSnapshot = new PlayerSnapshot(world_state, this);
   mpPositionInfo = new PositionInfo(world_state, this);
   mpInterceptInfo = new InterceptInfo(world_state, this);
+  mpDominanceMap = new DominanceMap(world_state, this);
 }
 
 InfoState::~InfoState() {
+  delete mpPlayerSnapshot;
   delete mpPositionInfo;
   delete mpInterceptInfo;
+  delete mpDominanceMap;
+}
+
+PlayerSnapshot &InfoState::GetPlayerSnapshot() const {
+  mpPlayerSnapshot->Update();
+  return *mpPlayerSnapshot;
 }
 
 PositionInfo &InfoState::GetPositionInfo() const {
@@ -52,3 +63,8 @@ InterceptInfo &InfoState::GetInterceptInfo() const {
   mpInterceptInfo->Update();
   return *mpInterceptInfo;
 }
+
+DominanceMap &InfoState::GetDominanceMap() const {
+  mpDominanceMap->Update();
+  return *mpDominanceMap;
+}
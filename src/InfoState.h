@@ -34,8 +34,10 @@
 
 #include "WorldState.h"
 
+class DominanceMap;
 class InfoState;
 class InterceptInfo;
+class PlayerSnapshot;
 class PositionInfo;
 
 /**
@@ -62,12 +64,16 @@ public:
   InfoState(WorldState *world_state);
   virtual ~InfoState();
 
+  PlayerSnapshot &GetPlayerSnapshot() const;
   PositionInfo &GetPositionInfo() const;
   InterceptInfo &GetInterceptInfo() const;
+  DominanceMap &GetDominanceMap() const;
 
 private:
+  PlayerSnapshot *mpPlayerSnapshot;
   PositionInfo *mpPositionInfo;
   InterceptInfo *mpInterceptInfo;
+  DominanceMap *mpDominanceMap;
 };
 
 #endif /* INFOSTATE_H_ */
@@ -33,27 +33,46 @@
 #include "Dasher.h"
 #include "InterceptModel.h"
 #include "Logger.h"
+#include "PlayerSnapshot.h"
+#include "TimeTest.h"
 #include <algorithm>
 #include <cstdlib>
 
 InterceptInfo::InterceptInfo(WorldState *pWorldState, InfoState *pInfoState)
     : InfoStateBase(pWorldState, pInfoState) {}
 
-void InterceptInfo::UpdateRoutine() { SortIntercerptInfo(); }
+void InterceptInfo::UpdateRoutine() {
+  TIMETEST("InterceptInfo");
+
+  SortIntercerptInfo();
+}
 
 void InterceptInfo::SortIntercerptInfo() {
   mOIT.clear();
 
+  const PlayerSnapshot &snapshot = mpInfoState->GetPlayerSnapshot();
+
+  PlayerInterceptInfo *outdated[2 * TEAMSIZE];
+  int outdated_count = 0;
+
   for (int i = -TEAMSIZE; i <= TEAMSIZE; i++) {
     if (i == 0)
       continue;
 
-    if (mpWorldState->GetPlayer(i).IsAlive()) {
-      mOIT.push_back(OrderedIT(VerifyIntInfo(i), i,
-                               mpWorldState->GetPlayer(i).GetPosDelay()));
+    const int index = PlayerSnapshot::Unum2Index(i);
+    if (snapshot.IsAlive(index)) {
+      PlayerInterceptInfo *pInfo = GetPlayerInterceptInfo(i);
+      if (pInfo && pInfo->mTime != mpWorldState->CurrentTime()) {
+        outdated[outdated_count++] = pInfo;
+        pInfo->mTime = mpWorldState->CurrentTime();
+      }
+      mOIT.push_back(OrderedIT(pInfo, i, snapshot.GetPosDelay()[index]));
     }
   }
 
+  //所有过期的球员对同一个球一起求解
+  CalcTightInterception(mpWorldState->GetBall(), outdated, outdated_count);
+
   std::sort(mOIT.begin(), mOIT.end());
 
   if (PlayerParam::instance().SaveTextLog()) {
@@ -93,20 +112,6 @@ void InterceptInfo::SortIntercerptInfo() {
   }
 }
 
-PlayerInterceptInfo *InterceptInfo::VerifyIntInfo(Unum unum) {
-  PlayerInterceptInfo *pInfo = GetPlayerInterceptInfo(unum);
-  if (!pInfo) {
-    return 0;
-  }
-
-  if (pInfo->mTime != mpWorldState->CurrentTime()) {
-    CalcTightInterception(mpWorldState->GetBall(), pInfo);
-    pInfo->mTime = mpWorldState->CurrentTime();
-  }
-
-  return pInfo;
-}
-
 void InterceptInfo::AnalyseInterceptSolution(const BallState &ball,
                                              PlayerInterceptInfo *pInfo) {
   pInfo->mIntervals = (pInfo->solution.interc == 1) ? 1 : 2;
@@ -134,6 +139,58 @@ void InterceptInfo::CalcIdealInterception(const BallState &ball,
       buffer, pInfo->mpPlayer, &(pInfo->solution));
 
   // step 2. 修正截球区间
+  RoundInterception(ball, pInfo, buffer, idle_cycle);
+}
+
+void InterceptInfo::CalcIdealInterception(const BallState &ball,
+                                          PlayerInterceptInfo **pInfo,
+                                          int size) {
+  if (size > InterceptModel::BATCH_SIZE) {
+    CalcIdealInterception(ball, pInfo, InterceptModel::BATCH_SIZE);
+    CalcIdealInterception(ball, pInfo + InterceptModel::BATCH_SIZE,
+                          size - InterceptModel::BATCH_SIZE);
+    return;
+  }
+
+  PlayerInterceptInfo *group[InterceptModel::BATCH_SIZE];
+  const PlayerState *players[InterceptModel::BATCH_SIZE];
+  double buffer[InterceptModel::BATCH_SIZE];
+  InterceptModel::InterceptSolution solution[InterceptModel::BATCH_SIZE];
+  bool solved[InterceptModel::BATCH_SIZE] = {false};
+
+  //idle_cycle 相同的球员共用同一个球的预测，一起求解
+  for (int i = 0; i < size; ++i) {
+    if (solved[i])
+      continue;
+
+    const int idle_cycle = pInfo[i]->mpPlayer->GetIdleCycle();
+    int n = 0;
+    for (int j = i; j < size; ++j) {
+      if (!solved[j] && pInfo[j]->mpPlayer->GetIdleCycle() == idle_cycle) {
+        group[n] = pInfo[j];
+        players[n] = pInfo[j]->mpPlayer;
+        buffer[n] = pInfo[j]->mpPlayer->GetKickableArea();
+        solution[n] = pInfo[j]->solution;
+        solved[j] = true;
+        ++n;
+      }
+    }
+
+    InterceptModel::instance().CalcInterception(
+        ball.GetPredictedPos(idle_cycle), ball.GetPredictedVel(idle_cycle),
+        buffer, players, n, solution);
+
+    for (int k = 0; k < n; ++k) {
+      group[k]->solution = solution[k];
+      RoundInterception(ball, group[k], buffer[k], idle_cycle);
+    }
+  }
+}
+
+void InterceptInfo::RoundInterception(const BallState &ball,
+                                      PlayerInterceptInfo *pInfo,
+                                      const double &buffer,
+                                      const int idle_cycle) {
   //	取整
   if (pInfo->solution.interc == 1) {
     pInfo->mInterCycle[0] = (int)floor(pInfo->solution.intert[0]);
@@ -185,6 +242,149 @@ void InterceptInfo::CalcTightInterception(const BallState &ball,
       ball, pInfo,
       pInfo->mpPlayer->GetKickableArea()); // TODO: 改成从外面传进来 buffer
 
+  CorrectInterception(ball, pInfo, can_inverse);
+}
+
+void InterceptInfo::CalcTightInterception(const BallState &ball,
+                                          PlayerInterceptInfo **pInfo,
+                                          int size, bool can_inverse) {
+  CalcIdealInterception(ball, pInfo, size);
+
+  for (int i = 0; i < size; ++i) {
+    CorrectInterception(ball, pInfo[i], can_inverse);
+  }
+
+  if (PlayerParam::instance().InterceptCheck()) {
+    for (int i = 0; i < size; ++i) {
+      PlayerInterceptInfo scalar = *pInfo[i];
+      CalcTightInterception(ball, &scalar, can_inverse);
+
+      if (!IsSameInterception(scalar, *pInfo[i])) {
+        PRINT_ERROR("batch interception differs for player "
+                    << pInfo[i]->mpPlayer->GetUnum() << ": " << *pInfo[i]
+                    << " vs " << scalar);
+      }
+    }
+  }
+}
+
+/**
+ * 先批量求出所有人的理想截球周期，修正只会让截球周期变大，所以它是修正后周期的
+ * 下界。双方所有人按下界从小到大依次修正，下界已经超过双方目前最快者时，剩下
+ * 的人都不可能改变结果，直接停止。没有修正的球员只有理想截球区间
+ * @return 最快的队友（周期相同时取靠前的）；没有队友或有对手不晚于它时返回 0
+ */
+PlayerInterceptInfo *InterceptInfo::CalcInterceptRace(
+    const BallState &ball, PlayerInterceptInfo **teammates, int tm_size,
+    PlayerInterceptInfo **opponents, int opp_size, bool can_inverse) {
+  if (tm_size <= 0)
+    return 0;
+
+  Assert(tm_size + opp_size <= InterceptModel::BATCH_SIZE);
+
+  PlayerInterceptInfo *all[InterceptModel::BATCH_SIZE];
+  const int size = tm_size + opp_size;
+  for (int i = 0; i < tm_size; ++i) {
+    all[i] = teammates[i];
+  }
+  for (int i = 0; i < opp_size; ++i) {
+    all[tm_size + i] = opponents[i];
+  }
+
+  CalcIdealInterception(ball, all, size);
+
+  //按下界排序，下标小于 tm_size 的是队友
+  int order[InterceptModel::BATCH_SIZE];
+  for (int i = 0; i < size; ++i) {
+    int j = i;
+    for (; j > 0 && all[order[j - 1]]->mInterCycle[0] > all[i]->mInterCycle[0];
+         --j) {
+      order[j] = order[j - 1];
+    }
+    order[j] = i;
+  }
+
+  int best_tm = -1;
+  int best_opp_cycle = HUGE_VALUE;
+  for (int k = 0; k < size; ++k) {
+    const int i = order[k];
+    const int best_cycle =
+        best_tm >= 0 ? Min(all[best_tm]->mMinCycle, best_opp_cycle)
+                     : best_opp_cycle;
+    if (all[i]->mInterCycle[0] > best_cycle)
+      break;
+
+    CorrectInterception(ball, all[i], can_inverse);
+    if (i < tm_size) {
+      if (best_tm < 0 || all[i]->mMinCycle < all[best_tm]->mMinCycle ||
+          (all[i]->mMinCycle == all[best_tm]->mMinCycle && i < best_tm)) {
+        best_tm = i;
+      }
+    } else {
+      best_opp_cycle = Min(best_opp_cycle, all[i]->mMinCycle);
+    }
+  }
+
+  PlayerInterceptInfo *winner = 0;
+  if (best_tm >= 0 && best_opp_cycle > all[best_tm]->mMinCycle) {
+    winner = all[best_tm];
+  }
+
+  if (PlayerParam::instance().InterceptCheck()) {
+    PlayerInterceptInfo full[InterceptModel::BATCH_SIZE];
+    int full_tm = -1;
+    int full_opp_cycle = HUGE_VALUE;
+    for (int i = 0; i < size; ++i) {
+      full[i] = *all[i];
+      CalcTightInterception(ball, &full[i], can_inverse);
+      if (i >= tm_size) {
+        full_opp_cycle = Min(full_opp_cycle, full[i].mMinCycle);
+      } else if (full_tm < 0 || full[i].mMinCycle < full[full_tm].mMinCycle) {
+        full_tm = i;
+      }
+    }
+
+    const bool full_win = full_opp_cycle > full[full_tm].mMinCycle;
+    if (full_win != (winner != 0) ||
+        (winner && !IsSameInterception(full[full_tm], *winner))) {
+      PRINT_ERROR("interception race differs: " << (winner != 0) << " vs "
+                                                << full_win);
+    }
+  }
+
+  return winner;
+}
+
+bool InterceptInfo::IsSameInterception(const PlayerInterceptInfo &a,
+                                       const PlayerInterceptInfo &b) {
+  if (a.solution.tangc != b.solution.tangc ||
+      a.solution.interc != b.solution.interc || a.mMinCycle != b.mMinCycle ||
+      a.mInterPos != b.mInterPos || a.mIntervals != b.mIntervals ||
+      a.mRes != b.mRes) {
+    return false;
+  }
+
+  for (int i = 0; i < a.solution.tangc; ++i) {
+    if (a.solution.tangp[i] != b.solution.tangp[i] ||
+        a.solution.tangv[i] != b.solution.tangv[i]) {
+      return false;
+    }
+  }
+
+  for (int i = 0; i < a.solution.interc; ++i) {
+    if (a.solution.interp[i] != b.solution.interp[i] ||
+        a.solution.intert[i] != b.solution.intert[i] ||
+        a.mInterCycle[i] != b.mInterCycle[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void InterceptInfo::CorrectInterception(const BallState &ball,
+                                        PlayerInterceptInfo *pInfo,
+                                        bool can_inverse) {
   const int idle_cycle = pInfo->mpPlayer->GetIdleCycle();
 
   //根据go_to_point模型修正
@@ -259,6 +459,8 @@ PlayerInterceptInfo *InterceptInfo::GetPlayerInterceptInfo(Unum unum) const {
   PlayerInterceptInfo *pInfo = const_cast<PlayerInterceptInfo *>(
       unum > 0 ? &(mTeammateInterceptInfo[unum])
                : &(mOpponentInterceptInfo[-unum]));
-  pInfo->mpPlayer = &(mpWorldState->GetPlayer(unum));
+  if (pInfo->mpPlayer != &(mpWorldState->GetPlayer(unum))) { //并行规划时不写
+    pInfo->mpPlayer = &(mpWorldState->GetPlayer(unum));
+  }
   return pInfo;
 }
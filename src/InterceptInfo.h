@@ -103,6 +103,13 @@ public:
       const BallState &ball, PlayerInterceptInfo *pInfo,
       bool can_inverse =
           true); //求解可踢即可截`紧'截球区间 -- 考虑gotopoint修正
+  static void CalcTightInterception(
+      const BallState &ball, PlayerInterceptInfo **pInfo, int size,
+      bool can_inverse = true); //批量求解多个球员对同一个球的`紧'截球区间
+  static PlayerInterceptInfo *CalcInterceptRace(
+      const BallState &ball, PlayerInterceptInfo **teammates, int tm_size,
+      PlayerInterceptInfo **opponents, int opp_size,
+      bool can_inverse = true); //队友和对手抢同一个球，返回能抢先的最快队友
   static void CalcLooseInterception(
       const BallState &ball, PlayerInterceptInfo *pInfo,
       const double
@@ -112,6 +119,16 @@ private:
   static void CalcIdealInterception(const BallState &ball,
                                     PlayerInterceptInfo *pInfo,
                                     const double &buffer);
+  static void CalcIdealInterception(const BallState &ball,
+                                    PlayerInterceptInfo **pInfo, int size);
+  static void RoundInterception(const BallState &ball,
+                                PlayerInterceptInfo *pInfo,
+                                const double &buffer, const int idle_cycle);
+  static void CorrectInterception(const BallState &ball,
+                                  PlayerInterceptInfo *pInfo,
+                                  bool can_inverse);
+  static bool IsSameInterception(const PlayerInterceptInfo &a,
+                                 const PlayerInterceptInfo &b);
   static void AnalyseInterceptSolution(const BallState &ball,
                                        PlayerInterceptInfo *pInfo);
 
@@ -119,7 +136,6 @@ private:
   void UpdateRoutine();
 
   void SortIntercerptInfo();
-  PlayerInterceptInfo *VerifyIntInfo(Unum unum);
 
 private:
   PlayerArray<PlayerInterceptInfo> mTeammateInterceptInfo;
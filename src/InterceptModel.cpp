@@ -51,6 +51,71 @@ InterceptModel &InterceptModel::instance() {
   return intercept_model;
 }
 
+namespace {
+
+const double NEWTON_MIN_ERROR = 0.01;
+const int NEWTON_MAX_ITERATION = 10;
+
+enum LaneState {
+  LS_Solved,      //特殊情况，已经得到解
+  LS_NoTangent,   //没有切点
+  LS_OuterTangent //已求得外切点，待求内切点
+};
+
+/**
+ * 切点方程 f(x) = 1 - α**pt(x) * (1 - x(x-x0)ln(α)/(s(x)vp))，同时给出 s(x) 和
+ * α**pt(x)
+ */
+inline double TangFunction(double x, double x0, double y0, double vp,
+                           double ka, double cd, double alpha, double ln_alpha,
+                           double &s, double &alpha_p) {
+  s = Sqrt((x - x0) * (x - x0) + y0 * y0);
+  double p = (s - ka) / vp - cd;
+  if (p < 0.0)
+    p = 0.0;
+  alpha_p = pow(alpha, p);
+  return 1.0 - alpha_p * (1 - x * (x - x0) * ln_alpha / (s * vp));
+}
+
+/**
+ * 切点方程的导数 f'(x)
+ */
+inline double TangDerivative(double x, double x0, double vp, double ln_alpha,
+                             double s, double f, double alpha_p) {
+  double dfdx =
+      ln_alpha / vp *
+      ((x - x0) * (f - 1.0) / s +
+       alpha_p * ((x + x - x0) / s - x * (x - x0) * (x - x0) / (s * s * s)));
+  return fabs(dfdx) < FLOAT_EPS ? (Sign(dfdx) * FLOAT_EPS) : dfdx;
+}
+
+/**
+ * 交点方程的一次牛顿迭代，返回迭代前的 f(x)
+ */
+inline double InterNewtonStep(double &x, double x0, double y0, double vb,
+                              double vp, double ka, double cd, double max_x,
+                              double alpha, double ln_alpha) {
+  x = Min(x, max_x);
+  const double s = Sqrt((x - x0) * (x - x0) + y0 * y0);
+  double p = (s - ka) / vp - cd;
+  if (p < 0.0)
+    p = 0.0;
+  const double f = p - log(1.0 - x * (1.0 - alpha) / vb) / ln_alpha;
+  double dfdx = (x - x0) / (s * vp) + (1.0 / ln_alpha) / (vb / (1.0 - alpha) - x);
+  dfdx = fabs(dfdx) < FLOAT_EPS ? (Sign(dfdx) * FLOAT_EPS) : dfdx;
+  x = x - f / dfdx;
+  return f;
+}
+
+/**
+ * 球运动 x 距离需要的周期数 bt(x)
+ */
+inline double BallCycle(double x, double vb, double alpha, double ln_alpha) {
+  return log(1.0 - x * (1.0 - alpha) / vb) / ln_alpha;
+}
+
+} // namespace
+
 void InterceptModel::CalcInterception(const Vector &ball_pos,
                                       const Vector &ball_vel,
                                       const double buffer,
@@ -104,67 +169,204 @@ void InterceptModel::CalcInterception(const Vector &ball_pos,
   //先判断切点个数 -- 根据切点个数得到解的个数，并依次选择迭代的初值
   int n = CalcTangPoint(x0, y0, player_spd, kick_area, cycle_delay, sol);
 
-  if (n < 1) { //没有切点
-    sol->interc = 1;
+  double x_init[3];
+  n = PlanInterPoint(n, x0, ball_spd, max_x, sol, x_init);
 
-    sol->interp[0] = CalcInterPoint(max_x - 1.0, x0, y0, ball_spd, player_spd,
+  for (int i = 0; i < n; ++i) {
+    sol->interp[i] = CalcInterPoint(x_init[i], x0, y0, ball_spd, player_spd,
                                     kick_area, cycle_delay);
-    sol->intert[0] =
-        log(1.0 - sol->interp[0] * (1.0 - alpha) / ball_spd) / ln_alpha;
-  } else if (n == 1) {
-    /**
-     * n = 1的情况对应只有一个切点，即外切的时候同时内切
-     **/
-    sol->interc = 1;
+    sol->intert[i] = BallCycle(sol->interp[i], ball_spd, alpha, ln_alpha);
+  }
+}
 
-    if (x0 < 0.0) {
-      sol->interp[0] = CalcInterPoint(max_x - 1.0, x0, y0, ball_spd, player_spd,
-                                      kick_area, cycle_delay);
+/**
+ * 批量求解理想截球模型，所有球员共用同一个球的预测
+ * 输入按道（lane）存成数组，牛顿迭代按道并行推进，每一道的运算与逐个求解完全相同，
+ * 所以结果与 CalcInterception 逐个调用逐位一致
+ *
+ * @param ball_pos
+ * @param ball_vel
+ * @param buffer 每个球员的可踢范围
+ * @param players
+ * @param size 球员个数
+ * @param sol 每个球员的解
+ */
+void InterceptModel::CalcInterception(const Vector &ball_pos,
+                                      const Vector &ball_vel,
+                                      const double *buffer,
+                                      const PlayerState *const *players,
+                                      int size, InterceptSolution *sol) {
+  if (size > BATCH_SIZE) {
+    CalcInterception(ball_pos, ball_vel, buffer, players, BATCH_SIZE, sol);
+    CalcInterception(ball_pos, ball_vel, buffer + BATCH_SIZE,
+                     players + BATCH_SIZE, size - BATCH_SIZE,
+                     sol + BATCH_SIZE);
+    return;
+  }
+
+  const double &alpha = ServerParam::instance().ballDecay();
+  const double &ln_alpha = ServerParam::instance().logBallDecay();
+
+  //球的信息对所有球员共享
+  const SinCosT rotation = SinCos(-ball_vel.Dir());
+  const double ball_spd = ball_vel.Mod();
+  const double max_x = ball_spd / (1.0 - alpha);
+  const double inter_max_x = ball_spd / (1.0 - alpha) - 0.1;
+
+  double x0[BATCH_SIZE], y0[BATCH_SIZE], vp[BATCH_SIZE], ka[BATCH_SIZE],
+      cd[BATCH_SIZE];
+  double x[BATCH_SIZE], last_f[BATCH_SIZE];
+  LaneState state[BATCH_SIZE];
+  int lane[BATCH_SIZE];
+  int lanes = 0;
+
+  // step 1. 模型输入和特殊情况
+  for (int i = 0; i < size; ++i) {
+    const Vector start_pt = (players[i]->GetPos() - ball_pos).Rotate(rotation);
+
+    x0[i] = start_pt.X();
+    y0[i] = start_pt.Y();
+    vp[i] = players[i]->GetEffectiveSpeedMax();
+    ka[i] = buffer[i];
+    cd[i] = double(players[i]->GetPosDelay());
+
+    const double s = Sqrt(x0[i] * x0[i] + y0[i] * y0[i]);
+    const double self_fix = ka[i] + cd[i] * vp[i];
+
+    if (s < self_fix) { //最好的情况已经可踢
+      sol[i].tangc = 0;
+      sol[i].interc = 1;
+      sol[i].interp[0] = 0;
+      sol[i].intert[0] = 0;
+      state[i] = LS_Solved;
+    } else if (ball_spd < 0.1) {
+      sol[i].tangc = 0;
+      sol[i].interc = 1;
+      sol[i].interp[0] = 0;
+
+      double p = (s - ka[i]) / vp[i] - cd[i];
+      if (p < 0.0)
+        p = 0.0;
+      sol[i].intert[0] = p;
+      state[i] = LS_Solved;
+    } else if (fabs(y0[i]) < FLOAT_EPS) {
+      state[i] = LS_NoTangent;
     } else {
-      sol->interp[0] = CalcInterPoint(x0, x0, y0, ball_spd, player_spd,
-                                      kick_area, cycle_delay);
+      state[i] = LS_OuterTangent;
+      x[i] = x0[i];
+      last_f[i] = 1000.0;
+      lane[lanes++] = i;
     }
+  }
 
-    sol->intert[0] =
-        log(1.0 - sol->interp[0] * (1.0 - alpha) / ball_spd) / ln_alpha;
-  } else {
-    if (ball_spd < sol->tangv[1]) { //没有最佳截球区间，早期就可截
-      sol->interc = 1;
-
-      sol->interp[0] = CalcInterPoint(x0, x0, y0, ball_spd, player_spd,
-                                      kick_area, cycle_delay);
-      sol->intert[0] =
-          log(1.0 - sol->interp[0] * (1.0 - alpha) / ball_spd) / ln_alpha;
-    } else if (ball_spd < sol->tangv[0]) { //有最佳截球区间
-      sol->interc = 3;
-
-      sol->interp[0] = CalcInterPoint(x0, x0, y0, ball_spd, player_spd,
-                                      kick_area, cycle_delay);
-      sol->intert[0] =
-          log(1.0 - sol->interp[0] * (1.0 - alpha) / ball_spd) / ln_alpha;
-
-      sol->interp[1] =
-          CalcInterPoint((sol->tangp[0] + sol->tangp[1]) * 0.5, x0, y0,
-                         ball_spd, player_spd, kick_area, cycle_delay);
-      sol->intert[1] =
-          log(1.0 - sol->interp[1] * (1.0 - alpha) / ball_spd) / ln_alpha;
-
-      sol->interp[2] =
-          CalcInterPoint((sol->tangp[1] + max_x) * 0.5, x0, y0, ball_spd,
-                         player_spd, kick_area, cycle_delay);
-      sol->intert[2] =
-          log(1.0 - sol->interp[2] * (1.0 - alpha) / ball_spd) / ln_alpha;
-    } else { //没有最佳截球区间，只有后期才可截
-      sol->interc = 1;
-
-      sol->interp[0] = CalcInterPoint(max_x - 1.0, x0, y0, ball_spd, player_spd,
-                                      kick_area, cycle_delay);
-      sol->intert[0] =
-          log(1.0 - sol->interp[0] * (1.0 - alpha) / ball_spd) / ln_alpha;
+  // step 2. 外切点 -- 各道同时迭代，收敛或发散的道退出
+  for (int iteration = 1; iteration <= NEWTON_MAX_ITERATION && lanes > 0;
+       ++iteration) {
+    int running = 0;
+    for (int k = 0; k < lanes; ++k) {
+      const int i = lane[k];
+      double s, alpha_p;
+      const double f = TangFunction(x[i], x0[i], y0[i], vp[i], ka[i], cd[i],
+                                    alpha, ln_alpha, s, alpha_p);
+      if (fabs(f) > fabs(last_f[i])) {
+        state[i] = LS_NoTangent;
+        continue;
+      }
+      last_f[i] = f;
+      x[i] = x[i] - f / TangDerivative(x[i], x0[i], vp[i], ln_alpha, s, f,
+                                       alpha_p);
+      if (fabs(f) > NEWTON_MIN_ERROR) {
+        lane[running++] = i;
+      }
+    }
+    lanes = running;
+  }
+
+  // step 3. 内切点，并确定交点的个数和迭代初值
+  int job_lane[3 * BATCH_SIZE], job_slot[3 * BATCH_SIZE], job[3 * BATCH_SIZE];
+  double job_x[3 * BATCH_SIZE];
+  int jobs = 0;
+
+  for (int i = 0; i < size; ++i) {
+    if (state[i] == LS_Solved)
+      continue;
+
+    int n = 0;
+    if (state[i] == LS_NoTangent) {
+      sol[i].tangc = 0;
+    } else {
+      n = CalcInnerTangPoint(x[i], x0[i], y0[i], vp[i], ka[i], cd[i], &sol[i]);
+    }
+
+    double x_init[3];
+    n = PlanInterPoint(n, x0[i], ball_spd, max_x, &sol[i], x_init);
+    for (int j = 0; j < n; ++j) {
+      job_lane[jobs] = i;
+      job_slot[jobs] = j;
+      job_x[jobs] = x_init[j];
+      job[jobs] = jobs;
+      ++jobs;
+    }
+  }
+
+  // step 4. 交点 -- 同样各道同时迭代
+  int running_jobs = jobs;
+  for (int iteration = 1;
+       iteration <= NEWTON_MAX_ITERATION && running_jobs > 0; ++iteration) {
+    int running = 0;
+    for (int k = 0; k < running_jobs; ++k) {
+      const int j = job[k];
+      const int i = job_lane[j];
+      const double f =
+          InterNewtonStep(job_x[j], x0[i], y0[i], ball_spd, vp[i], ka[i],
+                          cd[i], inter_max_x, alpha, ln_alpha);
+      if (fabs(f) > NEWTON_MIN_ERROR) {
+        job[running++] = j;
+      }
     }
+    running_jobs = running;
+  }
+
+  for (int j = 0; j < jobs; ++j) {
+    InterceptSolution &s = sol[job_lane[j]];
+    s.interp[job_slot[j]] = MinMax(0.0, job_x[j], inter_max_x);
+    s.intert[job_slot[j]] =
+        BallCycle(s.interp[job_slot[j]], ball_spd, alpha, ln_alpha);
   }
 }
 
+/**
+ * 根据切点个数确定交点个数，并给出每个交点的迭代初值
+ * @return 交点个数
+ */
+int InterceptModel::PlanInterPoint(int tangc, double x0, double vb,
+                                   double max_x, InterceptSolution *sol,
+                                   double *x_init) {
+  if (tangc < 1) { //没有切点
+    sol->interc = 1;
+    x_init[0] = max_x - 1.0;
+  } else if (tangc == 1) {
+    /**
+     * n = 1的情况对应只有一个切点，即外切的时候同时内切
+     **/
+    sol->interc = 1;
+    x_init[0] = (x0 < 0.0) ? max_x - 1.0 : x0;
+  } else if (vb < sol->tangv[1]) { //没有最佳截球区间，早期就可截
+    sol->interc = 1;
+    x_init[0] = x0;
+  } else if (vb < sol->tangv[0]) { //有最佳截球区间
+    sol->interc = 3;
+    x_init[0] = x0;
+    x_init[1] = (sol->tangp[0] + sol->tangp[1]) * 0.5;
+    x_init[2] = (sol->tangp[1] + max_x) * 0.5;
+  } else { //没有最佳截球区间，只有后期才可截
+    sol->interc = 1;
+    x_init[0] = max_x - 1.0;
+  }
+
+  return sol->interc;
+}
+
 /**
  * 计算切点的个数和位置
  *
@@ -187,12 +389,10 @@ void InterceptModel::CalcInterception(const Vector &ball_pos,
  */
 int InterceptModel::CalcTangPoint(double x0, double y0, double vp, double ka,
                                   double cd, InterceptSolution *sol) {
-  static const double MINERROR = 0.01;
-
   const double &alpha = ServerParam::instance().ballDecay();
   const double &ln_alpha = ServerParam::instance().logBallDecay();
 
-  double s, p, alpha_p, f, dfdx, last_f = 1000.0, x;
+  double s, alpha_p, f, last_f = 1000.0, x;
   int iteration_cycle = 0;
 
   if (fabs(y0) < FLOAT_EPS) {
@@ -203,15 +403,10 @@ int InterceptModel::CalcTangPoint(double x0, double y0, double vp, double ka,
   x = x0;
   do {
     iteration_cycle += 1;
-    if (iteration_cycle > 10) {
+    if (iteration_cycle > NEWTON_MAX_ITERATION) {
       break;
     }
-    s = Sqrt((x - x0) * (x - x0) + y0 * y0);
-    p = (s - ka) / vp - cd;
-    if (p < 0.0)
-      p = 0.0;
-    alpha_p = pow(alpha, (p));
-    f = 1.0 - alpha_p * (1 - x * (x - x0) * ln_alpha / (s * vp));
+    f = TangFunction(x, x0, y0, vp, ka, cd, alpha, ln_alpha, s, alpha_p);
 
     if (fabs(f) > fabs(last_f)) {
       sol->tangc = 0;
@@ -220,21 +415,28 @@ int InterceptModel::CalcTangPoint(double x0, double y0, double vp, double ka,
       last_f = f;
     }
 
-    dfdx =
-        ln_alpha / vp *
-        ((x - x0) * (f - 1.0) / s +
-         alpha_p * ((x + x - x0) / s - x * (x - x0) * (x - x0) / (s * s * s)));
-    dfdx = fabs(dfdx) < FLOAT_EPS ? (Sign(dfdx) * FLOAT_EPS) : dfdx;
-    x = x - f / dfdx;
-  } while (fabs(f) > MINERROR);
+    x = x - f / TangDerivative(x, x0, vp, ln_alpha, s, f, alpha_p);
+  } while (fabs(f) > NEWTON_MIN_ERROR);
+
+  return CalcInnerTangPoint(x, x0, y0, vp, ka, cd, sol);
+}
+
+/**
+ * 已求得外切点 x，检测是否还有内切点
+ * @return 切点个数
+ */
+int InterceptModel::CalcInnerTangPoint(double x, double x0, double y0,
+                                       double vp, double ka, double cd,
+                                       InterceptSolution *sol) {
+  const double &alpha = ServerParam::instance().ballDecay();
+  const double &ln_alpha = ServerParam::instance().logBallDecay();
+
+  double s, alpha_p, f;
+  int iteration_cycle = 0;
 
   sol->tangp[0] = x;
 
-  s = Sqrt((x - x0) * (x - x0) + y0 * y0);
-  p = (s - ka) / vp - cd;
-  if (p < 0.0)
-    p = 0.0;
-  alpha_p = pow(alpha, (p));
+  TangFunction(x, x0, y0, vp, ka, cd, alpha, ln_alpha, s, alpha_p);
   if (1.0 - alpha_p < FLOAT_EPS) { //表示自己到那里几乎不花时间
     sol->tangv[0] = 1000.0;
     sol->tangc = 1;
@@ -244,58 +446,29 @@ int InterceptModel::CalcTangPoint(double x0, double y0, double vp, double ka,
   }
 
   x += 0.5; //检测是否只有一个切点
-  s = Sqrt((x - x0) * (x - x0) + y0 * y0);
-  p = (s - ka) / vp - cd;
-  if (p < 0.0)
-    p = 0.0;
-  alpha_p = pow(alpha, p);
-  f = 1.0 - alpha_p * (1 - x * (x - x0) * ln_alpha / (s * vp));
+  f = TangFunction(x, x0, y0, vp, ka, cd, alpha, ln_alpha, s, alpha_p);
   if (f > 0.0) {
     sol->tangc = 1;
     return 1; //只有一个切点
   } else {
     do {
       x += 15.0;
-      s = Sqrt((x - x0) * (x - x0) + y0 * y0);
-      p = (s - ka) / vp - cd;
-      if (p < 0.0)
-        p = 0.0;
-      alpha_p = pow(alpha, p);
-      f = 1.0 - alpha_p * (1 - x * (x - x0) * ln_alpha / (s * vp));
+      f = TangFunction(x, x0, y0, vp, ka, cd, alpha, ln_alpha, s, alpha_p);
     } while (f < 0.0);
-    dfdx =
-        ln_alpha / vp *
-        ((x - x0) * (f - 1.0) / s +
-         alpha_p * ((x + x - x0) / s - x * (x - x0) * (x - x0) / (s * s * s)));
-    dfdx = fabs(dfdx) < FLOAT_EPS ? (Sign(dfdx) * FLOAT_EPS) : dfdx;
-    x = x - f / dfdx;
+    x = x - f / TangDerivative(x, x0, vp, ln_alpha, s, f, alpha_p);
 
     iteration_cycle = 0;
-    while (fabs(f) > MINERROR) {
+    while (fabs(f) > NEWTON_MIN_ERROR) {
       iteration_cycle += 1;
-      if (iteration_cycle > 10) {
+      if (iteration_cycle > NEWTON_MAX_ITERATION) {
         break;
       }
-      s = Sqrt((x - x0) * (x - x0) + y0 * y0);
-      p = (s - ka) / vp - cd;
-      if (p < 0.0)
-        p = 0.0;
-      alpha_p = pow(alpha, p);
-      f = 1.0 - alpha_p * (1 - x * (x - x0) * ln_alpha / (s * vp));
-      dfdx = ln_alpha / vp *
-             ((x - x0) * (f - 1.0) / s +
-              alpha_p *
-                  ((x + x - x0) / s - x * (x - x0) * (x - x0) / (s * s * s)));
-      dfdx = fabs(dfdx) < FLOAT_EPS ? (Sign(dfdx) * FLOAT_EPS) : dfdx;
-      x = x - f / dfdx;
+      f = TangFunction(x, x0, y0, vp, ka, cd, alpha, ln_alpha, s, alpha_p);
+      x = x - f / TangDerivative(x, x0, vp, ln_alpha, s, f, alpha_p);
     }
 
     sol->tangp[1] = x;
-    s = Sqrt((x - x0) * (x - x0) + y0 * y0);
-    p = (s - ka) / vp - cd;
-    if (p < 0.0)
-      p = 0.0;
-    alpha_p = pow(alpha, p);
+    TangFunction(x, x0, y0, vp, ka, cd, alpha, ln_alpha, s, alpha_p);
     if (1.0 - alpha_p < FLOAT_EPS) {
       sol->tangv[1] = 1000.0;
     } else {
@@ -326,32 +499,22 @@ int InterceptModel::CalcTangPoint(double x0, double y0, double vp, double ka,
 double InterceptModel::CalcInterPoint(double x_init, double x0, double y0,
                                       double vb, double vp, double ka,
                                       double cd) {
-  static const double MINERROR = 0.01;
-
   const double &alpha = ServerParam::instance().ballDecay();
   const double &ln_alpha = ServerParam::instance().logBallDecay();
 
   const double max_x = vb / (1.0 - alpha) - 0.1;
 
-  double s, p, f, dfdx, x;
+  double f, x;
   int iteration_cycle = 0;
 
   x = x_init;
   do {
     iteration_cycle += 1;
-    if (iteration_cycle > 10) {
+    if (iteration_cycle > NEWTON_MAX_ITERATION) {
       break;
     }
-    x = Min(x, max_x);
-    s = Sqrt((x - x0) * (x - x0) + y0 * y0);
-    p = (s - ka) / vp - cd;
-    if (p < 0.0)
-      p = 0.0;
-    f = p - log(1.0 - x * (1.0 - alpha) / vb) / ln_alpha;
-    dfdx = (x - x0) / (s * vp) + (1.0 / ln_alpha) / (vb / (1.0 - alpha) - x);
-    dfdx = fabs(dfdx) < FLOAT_EPS ? (Sign(dfdx) * FLOAT_EPS) : dfdx;
-    x = x - f / dfdx;
-  } while (fabs(f) > MINERROR);
+    f = InterNewtonStep(x, x0, y0, vb, vp, ka, cd, max_x, alpha, ln_alpha);
+  } while (fabs(f) > NEWTON_MIN_ERROR);
 
   return MinMax(0.0, x, max_x);
 }
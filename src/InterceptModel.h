@@ -47,6 +47,10 @@ public:
 
   static const double IMPOSSIBLE_BALL_SPEED;
 
+  enum {
+    BATCH_SIZE = 2 * TEAMSIZE //批量求解时一次处理的球员数
+  };
+
 public:
   struct InterceptSolution {
     InterceptSolution() : tangc(0), interc(1) {}
@@ -67,6 +71,9 @@ public:
   void CalcInterception(const Vector &ball_pos, const Vector &ball_vel,
                         const double buffer, const PlayerState *player,
                         InterceptSolution *sol);
+  void CalcInterception(const Vector &ball_pos, const Vector &ball_vel,
+                        const double *buffer, const PlayerState *const *players,
+                        int size, InterceptSolution *sol);
   int CalcTangPoint(double x0, double y0, double vp, double ka, double cd,
                     InterceptSolution *sol);
   double CalcInterPoint(double x_init, double x0, double y0, double vb,
@@ -82,6 +89,11 @@ public:
                                const double &distance, const double fix = 1.5);
 
 private:
+  int CalcInnerTangPoint(double x, double x0, double y0, double vp, double ka,
+                         double cd, InterceptSolution *sol);
+  int PlanInterPoint(int tangc, double x0, double vb, double max_x,
+                     InterceptSolution *sol, double *x_init);
+
   /**
    * 画出理想截球曲线
    * @param x0
@@ -32,14 +32,85 @@
 #include "Kicker.h"
 #include "Logger.h"
 #include "Parser.h"
+#include "Thread.h"
 #include "Utilities.h"
+#include <cstdio>
 #include <cstdlib>
 #include <fstream>
+#include <sstream>
 
 #include <cstring>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
+namespace {
+const char *UTILITY_TABLE_FILE = "data/kicker_value";
+const char UTILITY_TABLE_MAGIC[4] = {'W', 'E', 'K', 'V'};
+
+/** FNV-1a */
+inline unsigned HashWord(unsigned hash, unsigned word) {
+  return (hash ^ word) * 16777619u;
+}
+
+/** 参数按1e-6取整后再参与校验，避免浮点解析的细微差异 */
+inline unsigned HashValue(unsigned hash, double value) {
+  long long v = (long long)floor(value * 1.0e6 + 0.5);
+  hash = HashWord(hash, (unsigned)(v & 0xffffffff));
+  return HashWord(hash, (unsigned)((unsigned long long)v >> 32));
+}
+
+unsigned TableChecksum(const float *data, size_t count) {
+  unsigned hash = 2166136261u;
+  for (size_t i = 0; i < count; ++i) {
+    unsigned word;
+    memcpy(&word, data + i, sizeof(word));
+    hash = HashWord(hash, word);
+  }
+  return hash;
+}
+} // namespace
+
+/**
+ * 按请求的先后在后台准备各类型的表，没有请求时睡眠
+ */
+class Kicker::UtilityTablePreparer : public Thread {
+public:
+  UtilityTablePreparer(Kicker &kicker) : mKicker(kicker) {}
+  virtual ~UtilityTablePreparer() {}
+
+private:
+  void StartRoutine() {
+    for (;;) {
+      mKicker.mPreparerWake.Wait();
+
+      int type = -1;
+      mKicker.mUtilityTableMutex.Lock();
+      const bool quit = mKicker.mPreparerQuit;
+      if (!quit && !mKicker.mRequestQueue.empty()) {
+        type = mKicker.mRequestQueue.front();
+        mKicker.mRequestQueue.erase(mKicker.mRequestQueue.begin());
+      }
+      mKicker.mUtilityTableMutex.UnLock();
+
+      if (quit) {
+        break;
+      }
+      if (type >= 0) {
+        mKicker.PrepareUtilityTable(type);
+      }
+    }
+  }
+
+  Kicker &mKicker;
+};
+
 /**
  * Constructor
  */
@@ -97,18 +168,53 @@ Kicker::Kicker() {
     }
   }
 
-  /** 将要读取或计算mKickerValue表 */
-  memset(mKickerValue, 0, sizeof(mKickerValue));
-
-  if (PlayerParam::instance().KickerMode() == 0) {
-    ReadUtilityTable();
+  /** mKickerValue表在UpdateKickData中按球员类型读取或计算 */
+  mUtilityTable.resize(PlayerParam::instance().playerTypes());
+  mPreparing.resize(mUtilityTable.size(), 0);
+  mRequested.resize(mUtilityTable.size(), 0);
+  mUtilityTableGeneration = 0;
+  mPreparerQuit = false;
+  mpPreparer = 0;
+  mKickerValue = 0;
+  mKickerValueOwn = false;
+  mKickerValueGeneration = -1;
+
+  if (PlayerParam::instance().KickerMode() != 0) {
+    /** 离线计算，kicker_type为-1时算所有已知的球员类型 */
+    int type = PlayerParam::instance().KickerType();
+    if (type >= 0) {
+      ComputeUtilityTable(type);
+    } else {
+      int type_num = Parser::IsPlayerTypesReady()
+                         ? PlayerParam::instance().playerTypes()
+                         : 1;
+      for (int t = 0; t < type_num; ++t) {
+        ComputeUtilityTable(t);
+      }
+    }
   }
 }
 
 /**
  * Destructor.
  */
-Kicker::~Kicker() {}
+Kicker::~Kicker() {
+  if (mpPreparer) {
+    mUtilityTableMutex.Lock();
+    mPreparerQuit = true;
+    mUtilityTableMutex.UnLock();
+    mPreparerWake.Post();
+    mpPreparer->Join();
+    delete mpPreparer;
+  }
+
+  for (size_t i = 0; i < mUtilityTable.size(); ++i) {
+    FreeUtilityTable(mUtilityTable[i]);
+  }
+  for (size_t i = 0; i < mRetiredTable.size(); ++i) {
+    FreeUtilityTable(mRetiredTable[i]);
+  }
+}
 
 /**
  * Instrance.
@@ -430,85 +536,446 @@ void Kicker::Execute(Agent &agent, const ActionPlan &plan) {
 }
 
 /**
- * 读取mKickerValue表
+ * Queue a player type's table for the background thread. Called by the parser
+ * thread for its own type once all player_type messages have arrived and on a
+ * change_player_type, and by the decision thread for any other type it uses.
  */
-void Kicker::ReadUtilityTable() {
-  std::ifstream in_file("data/kicker_value", std::ios::binary);
-  if (!in_file) {
-    PRINT_ERROR("open file error");
+void Kicker::RequestUtilityTable(int player_type) {
+  if (player_type < 0 || player_type >= (int)mUtilityTable.size() ||
+      !Parser::IsPlayerTypesReady()) {
     return;
   }
-  in_file.read((char *)mKickerValue, sizeof(mKickerValue));
-  in_file.close();
+
+  mUtilityTableMutex.Lock();
+  const bool requested = mRequested[player_type] != 0;
+  const bool started = mpPreparer != 0;
+  if (!requested) {
+    mRequested[player_type] = 1;
+    mRequestQueue.push_back(player_type);
+    if (!started) {
+      mpPreparer = new UtilityTablePreparer(*this);
+    }
+  }
+  mUtilityTableMutex.UnLock();
+
+  if (!requested) {
+    if (!started) {
+      mpPreparer->Start();
+    }
+    mPreparerWake.Post();
+  }
 }
 
 /**
- * Compute kicker value table.
+ * 读取mKickerValue表，文件以只读方式映射，同一台机器上的球员共享物理页
  */
-void Kicker::ComputeUtilityTable() {
-  Assert(Parser::IsPlayerTypesReady());
+const Kicker::UtilitySlice *Kicker::ReadUtilityTable(int player_type,
+                                                     bool *own) {
+  if (player_type < 0 || player_type >= (int)mUtilityTable.size()) {
+    player_type = 0;
+  }
 
-  mInput.mPlayerType = 0; //离线计算只考虑0号类型
-  for (int k = 0; k < POINTS_NUM; ++k) {
-    mKickRate[k] = GetKickRate(mPoint[k], mInput.mPlayerType);
-    mMaxAccel[k] = ServerParam::instance().maxPower() * mKickRate[k];
+  if (!Parser::IsPlayerTypesReady()) {
+    //没有收到球员类型（离线、无头模式），只能按当前参数用0号类型的表
+    PrepareUtilityTable(0);
+  } else {
+    RequestUtilityTable(player_type);
+  }
+
+  mUtilityTableMutex.Lock();
+  const UtilitySlice *value = mUtilityTable[player_type].mValue;
+  *own = value != 0;
+  if (value == 0) {
+    value = mUtilityTable[0].mValue; //该类型还没准备好，可能为0，这时只用前向搜索
+  }
+  mKickerValueGeneration = mUtilityTableGeneration;
+  mUtilityTableMutex.UnLock();
+
+  return value;
+}
+
+/**
+ * Check the table of a player type against the current params, and map or
+ * recompute it when it is missing or stale.
+ */
+void Kicker::PrepareUtilityTable(int player_type) {
+  if (player_type > 0 && !Parser::IsPlayerTypesReady()) {
+    return;
+  }
+
+  const unsigned hash = GetUtilityTableHash(player_type);
+
+  mUtilityTableMutex.Lock();
+  for (;;) {
+    if (mUtilityTable[player_type].mValue != 0 &&
+        mUtilityTable[player_type].mParamHash == hash) {
+      mUtilityTableMutex.UnLock();
+      return;
+    }
+    if (!mPreparing[player_type]) {
+      break;
+    }
+    mUtilityTableMutex.UnLock(); //另一个线程正在准备这张表，等它做完
+    WaitFor(1);
+    mUtilityTableMutex.Lock();
+  }
+  mPreparing[player_type] = 1;
+  mUtilityTableMutex.UnLock();
+
+  UtilityTable table;
+  bool ok = LoadUtilityTable(player_type, table);
+  if (!ok) {
+    std::cerr << "kicker value table of type " << player_type
+              << " missing or out of date, recomputing ..." << std::endl;
+    ok = BuildUtilityTable(player_type, table);
+  }
+
+  if (ok) {
+    SetUtilityTable(player_type, table);
+  }
+
+  mUtilityTableMutex.Lock();
+  mPreparing[player_type] = 0;
+  mUtilityTableMutex.UnLock();
+}
+
+/**
+ * Install a table for a player type. The replaced one may still be in use by
+ * the decision thread, so it is kept until destruction.
+ */
+void Kicker::SetUtilityTable(int player_type, const UtilityTable &table) {
+  mUtilityTableMutex.Lock();
+  if (mUtilityTable[player_type].mValue != 0) {
+    mRetiredTable.push_back(mUtilityTable[player_type]);
+  }
+  mUtilityTable[player_type] = table;
+  ++mUtilityTableGeneration;
+  mUtilityTableMutex.UnLock();
+}
+
+/**
+ * File the kicker value table of a player type is saved to.
+ */
+std::string Kicker::GetUtilityTableFile(int player_type) {
+  std::ostringstream file_name;
+  file_name << UTILITY_TABLE_FILE;
+  if (player_type > 0) {
+    file_name << "_" << player_type;
   }
+  return file_name.str();
+}
 
-  AngleDeg kick_angle = 0.0; //踢球角度
+/**
+ * Hash of all parameters the kicker value table of a player type depends on.
+ */
+unsigned Kicker::GetUtilityTableHash(int player_type) const {
+  const ServerParam &sp = ServerParam::instance();
+  const HeteroParam &hp = PlayerParam::instance().HeteroPlayer(player_type);
+
+  unsigned hash = 2166136261u;
+  for (int i = 0; i < 3; ++i) {
+    hash = HashValue(hash, mDlayer[i]);
+  }
+  hash = HashValue(hash, sp.ballDecay());
+  hash = HashValue(hash, sp.ballSize());
+  hash = HashValue(hash, sp.ballSpeedMax());
+  hash = HashValue(hash, sp.maxPower());
+  hash = HashValue(hash, hp.playerSize());
+  hash = HashValue(hash, hp.kickPowerRate());
+  hash = HashValue(hash, hp.kickableMargin());
+  return hash;
+}
+
+/**
+ * Map (or read on WIN32) the kicker value table file of a player type.
+ * \return false if the file is missing, legacy or built for other parameters.
+ */
+bool Kicker::LoadUtilityTable(int player_type, UtilityTable &table) {
+  const unsigned hash = GetUtilityTableHash(player_type);
+  const std::string file_name = GetUtilityTableFile(player_type);
+  const size_t table_count = 3 * sizeof(UtilitySlice) / sizeof(float);
+  const size_t file_size =
+      sizeof(UtilityTableHeader) + table_count * sizeof(float);
+
+  UtilityTableHeader header;
+  const float *data = 0;
+  void *addr = 0;
+
+#ifndef WIN32
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && (size_t)st.st_size == file_size) {
+    addr = mmap(0, file_size, PROT_READ, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (addr == 0 || addr == MAP_FAILED) {
+    return false;
+  }
+  memcpy(&header, addr, sizeof(header));
+  data = (const float *)((const char *)addr + sizeof(header));
+#else
+  std::ifstream in_file(file_name.c_str(), std::ios::binary);
+  if (!in_file || !in_file.read((char *)&header, sizeof(header))) {
+    return false;
+  }
+  UtilitySlice *buffer = new UtilitySlice[3];
+  if (!in_file.read((char *)buffer, table_count * sizeof(float))) {
+    delete[] buffer;
+    return false;
+  }
+  data = (const float *)buffer;
+#endif
+
+  bool valid = memcmp(header.mMagic, UTILITY_TABLE_MAGIC, 4) == 0 &&
+               header.mVersion == UTILITY_TABLE_VERSION &&
+               header.mPointsNum == POINTS_NUM &&
+               header.mAngleNum == KICK_ANGLE_NUM &&
+               header.mNlayer[0] == mNlayer[0] &&
+               header.mNlayer[1] == mNlayer[1] &&
+               header.mNlayer[2] == mNlayer[2] &&
+               header.mParamHash == hash &&
+               header.mChecksum == TableChecksum(data, table_count);
+
+#ifndef WIN32
+  if (!valid) {
+    munmap(addr, file_size);
+    return false;
+  }
+  table.mMap = addr;
+  table.mMapSize = file_size;
+#else
+  if (!valid) {
+    delete[] buffer;
+    return false;
+  }
+#endif
+
+  table.mValue = (const UtilitySlice *)data;
+  table.mParamHash = hash;
+  return true;
+}
+
+/**
+ * Release the kicker value table of a player type.
+ */
+void Kicker::FreeUtilityTable(UtilityTable &table) {
+#ifndef WIN32
+  if (table.mMap != 0) {
+    munmap(table.mMap, table.mMapSize);
+  } else
+#endif
+  {
+    delete[] table.mValue;
+  }
+
+  table = UtilityTable();
+}
+
+/**
+ * 计算一种球员类型的值函数时各线程共享的数据
+ * Data shared by all threads computing the table of one player type.
+ */
+struct Kicker::UtilityTableTask {
+  UtilitySlice *mTable;
+  double mBallDecay;
+  Array<double, POINTS_NUM> mMaxAccel; /** 在每个点球员能产生的最大加速度 */
+
+  /** 从j踢到k后，理论上还能踢到的点l，与踢球角度无关，只算一次 */
+  std::vector<unsigned char> mReach;
+  std::vector<int> mReachBegin; /** [j * POINTS_NUM + k]在mReach中的起点 */
+
+  int mNextAngle; /** 下一个待计算的角度 */
+  ThreadMutex mMutex;
+
+  int NextAngle() {
+    mMutex.Lock();
+    int angle = mNextAngle < KICK_ANGLE_NUM ? mNextAngle++ : -1;
+    mMutex.UnLock();
+    return angle;
+  }
+};
+
+/**
+ * 每个线程从共享的任务中取角度计算，先算完的线程自动多取
+ */
+class Kicker::UtilityTableWorker : public Thread {
+public:
+  UtilityTableWorker(Kicker &kicker, UtilityTableTask &task)
+      : mKicker(kicker), mTask(task) {}
+  virtual ~UtilityTableWorker() {}
+
+  void Run() {
+    for (int i = mTask.NextAngle(); i >= 0; i = mTask.NextAngle()) {
+      mKicker.ComputeUtilitySlice(mTask, i);
+    }
+  }
+
+private:
+  void StartRoutine() { Run(); }
+
+  Kicker &mKicker;
+  UtilityTableTask &mTask;
+};
+
+/**
+ * Compute 2, 3 and 4 kick values of one kick angle. Different angles are
+ * independent, so they can be computed in parallel.
+ */
+void Kicker::ComputeUtilitySlice(UtilityTableTask &task, int i) {
+  AngleDeg kick_angle = STEP_KICK_ANGLE * i; //踢球角度
   Vector ball_vel = Vector(0.0, 0.0);
-  Vector ball_next = Vector(0.0, 0.0);
-  double max_speed = 0.0;
 
   for (int v = 0; v < 3; ++v) // 3次迭代，分别算v[0], v[1], v[2]
   {
-    for (int i = 0; i < 36; ++i) //踢球角度
+    for (int j = 0; j < POINTS_NUM; ++j) //初始位置，即第1脚kick前的位置
     {
-      kick_angle = STEP_KICK_ANGLE * i;
-
-      for (int j = 0; j < POINTS_NUM; ++j) //初始位置，即第1脚kick前的位置
+      for (int k = 0; k < POINTS_NUM; ++k) //第1脚kick后的位置
       {
-        for (int k = 0; k < POINTS_NUM; ++k) //第1脚kick后的位置
+        if (v == 0) // v[0]直接算即可
+        {
+          ball_vel = (mPoint[k] - mPoint[j]) * task.mBallDecay;
+          task.mTable[v][i][j][k] = (float)GetOneKickMaxSpeed(
+              ball_vel, kick_angle, task.mMaxAccel[k]);
+        } else // v[1]和v[2]要迭代，从j踢到k，再踢到l
         {
-          ball_vel =
-              (mPoint[k] - mPoint[j]) * ServerParam::instance().ballDecay();
+          const float *prev = task.mTable[v - 1][i][k];
+          const int begin = task.mReachBegin[j * POINTS_NUM + k];
+          const int end = task.mReachBegin[j * POINTS_NUM + k + 1];
 
-          if (v == 0) // v[0]直接算即可
-          {
-            mKickerValue[v][i][j][k] =
-                (float)GetOneKickMaxSpeed(ball_vel, kick_angle, mMaxAccel[k]);
-          } else // v[1]和v[2]要迭代
-          {
-            max_speed = 0.0;
-            ball_next = mPoint[k] + ball_vel;
+          float max_speed = 0.0f;
+          for (int l = begin; l < end; ++l) {
+            max_speed = Max(max_speed, prev[task.mReach[l]]);
+          }
 
-            for (int l = 0; l < POINTS_NUM; ++l) //从j踢到k，再踢到l
-            {
-              if (mPoint[l].Dist(ball_next) <
-                  mMaxAccel[k]) //保证理论上可以从k踢到l
-              {
-                max_speed =
-                    Max(max_speed, (double)mKickerValue[v - 1][i][k][l]);
-              }
-            }
+          task.mTable[v][i][j][k] = max_speed;
+        }
+      }
+    }
+  }
+}
 
-            mKickerValue[v][i][j][k] = (float)max_speed;
-          }
+/**
+ * Compute kicker value table of a player type, save it to file and keep it
+ * for later use.
+ */
+void Kicker::ComputeUtilityTable(int player_type) {
+  UtilityTable table;
+  if (BuildUtilityTable(player_type, table)) {
+    SetUtilityTable(player_type, table);
+  }
+}
+
+/**
+ * Compute the table of a player type and save it, then map the saved file.
+ * \return false if the player type is not available.
+ */
+bool Kicker::BuildUtilityTable(int player_type, UtilityTable &table) {
+  if (player_type < 0 ||
+      player_type >= (int)mUtilityTable.size() ||
+      (player_type > 0 && !Parser::IsPlayerTypesReady())) {
+    PRINT_ERROR("player type " << player_type << " not available");
+    return false;
+  }
+
+  UtilityTableTask task;
+  task.mTable = new UtilitySlice[3];
+  task.mBallDecay = ServerParam::instance().ballDecay();
+  for (int k = 0; k < POINTS_NUM; ++k) {
+    task.mMaxAccel[k] = ServerParam::instance().maxPower() *
+                        GetKickRate(mPoint[k], player_type);
+  }
+
+  task.mReach.reserve(POINTS_NUM * POINTS_NUM * POINTS_NUM / 4);
+  task.mReachBegin.resize(POINTS_NUM * POINTS_NUM + 1);
+  for (int j = 0; j < POINTS_NUM; ++j) {
+    for (int k = 0; k < POINTS_NUM; ++k) {
+      task.mReachBegin[j * POINTS_NUM + k] = task.mReach.size();
+      Vector ball_next =
+          mPoint[k] + (mPoint[k] - mPoint[j]) * task.mBallDecay;
+      for (int l = 0; l < POINTS_NUM; ++l) {
+        if (mPoint[l].Dist(ball_next) <
+            task.mMaxAccel[k]) //保证理论上可以从k踢到l
+        {
+          task.mReach.push_back((unsigned char)l);
         }
       }
     }
   }
+  task.mReachBegin[POINTS_NUM * POINTS_NUM] = task.mReach.size();
+  task.mNextAngle = 0;
 
-  //写文件
-  std::ofstream out_file("kicker_value", std::ios::binary);
-  if (!out_file) {
-    PRINT_ERROR("open file error");
-    return;
+  int threads = PlayerParam::instance().KickerThreads();
+#ifndef WIN32
+  if (threads <= 0) {
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+#endif
+  threads = MinMax(1, threads, (int)KICK_ANGLE_NUM);
+
+  std::vector<UtilityTableWorker *> workers;
+  for (int t = 1; t < threads; ++t) {
+    workers.push_back(new UtilityTableWorker(*this, task));
+    workers.back()->Start();
+  }
+  UtilityTableWorker(*this, task).Run();
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t]->Join();
+    delete workers[t];
+  }
+
+  UtilitySlice *value = task.mTable;
+
+  UtilityTableHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.mMagic, UTILITY_TABLE_MAGIC, 4);
+  header.mVersion = UTILITY_TABLE_VERSION;
+  header.mPointsNum = POINTS_NUM;
+  header.mAngleNum = KICK_ANGLE_NUM;
+  for (int i = 0; i < 3; ++i) {
+    header.mNlayer[i] = mNlayer[i];
   }
-  out_file.write((char *)mKickerValue, sizeof(mKickerValue));
+  header.mParamHash = GetUtilityTableHash(player_type);
+  header.mChecksum = TableChecksum((const float *)value,
+                                   3 * sizeof(UtilitySlice) / sizeof(float));
+
+  //先写临时文件再改名，多个球员同时重算时不会读到写了一半的文件
+  const std::string file_name = GetUtilityTableFile(player_type);
+  std::ostringstream tmp_name;
+  tmp_name << file_name << ".";
+#ifndef WIN32
+  tmp_name << getpid();
+#endif
+  tmp_name << ".tmp";
+
+  std::ofstream out_file(tmp_name.str().c_str(), std::ios::binary);
+  out_file.write((char *)&header, sizeof(header));
+  out_file.write((char *)value, 3 * sizeof(UtilitySlice));
   out_file.close();
 
-  std::cerr << "compute kicker value over ..." << std::endl;
-  exit(0);
+#ifdef WIN32
+  remove(file_name.c_str());
+#endif
+  bool saved =
+      out_file && rename(tmp_name.str().c_str(), file_name.c_str()) == 0;
+  if (!saved) {
+    PRINT_ERROR("write kicker value error");
+    remove(tmp_name.str().c_str());
+  }
+
+  if (saved && LoadUtilityTable(player_type, table)) {
+    delete[] value;
+  } else {
+    FreeUtilityTable(table);
+    table.mValue = value; //写不了文件时直接使用内存中的表
+    table.mParamHash = header.mParamHash;
+  }
+
+  std::cerr << "compute kicker value of type " << player_type << " over ..."
+            << std::endl;
+  return true;
 }
 
 /**
@@ -540,6 +1007,7 @@ void Kicker::UpdateKickData(const Agent &agent) {
   /** player type is changed */
   if (mInput.mPlayerType != player_state.GetPlayerType()) {
     mInput.mPlayerType = player_state.GetPlayerType();
+    mKickerValueOwn = false;
 
     for (int k = 0; k < POINTS_NUM; ++k) {
       mKickRate[k] = GetKickRate(mPoint[k], mInput.mPlayerType);
@@ -565,6 +1033,11 @@ void Kicker::UpdateKickData(const Agent &agent) {
     }
   }
 
+  //自己类型的表在后台准备好之前先用0号类型的；换过表后重新取
+  if (!mKickerValueOwn || mKickerValueGeneration != mUtilityTableGeneration) {
+    mKickerValue = ReadUtilityTable(mInput.mPlayerType, &mKickerValueOwn);
+  }
+
   /** initial */
   for (int i = 0; i < POINTS_NUM; i++) {
     mPointEva[i] = mRandEva[i];
@@ -920,7 +1393,7 @@ ActionPlan Kicker::MultiCycleKick(const Agent &agent, int cycle) {
     }
   }
 
-  if (poss < 0.001) {
+  if (poss < 0.001 && mKickerValue != 0) { //表还没准备好时只用前向搜索
     // std::cerr << agent.GetSelfUnum() << "@" <<
     // agent.GetWorldState().CurrentTime() << ": no good" << std::endl;
 
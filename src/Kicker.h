@@ -33,6 +33,7 @@
 #define __Kicker_H__
 
 #include "Agent.h"
+#include "Thread.h"
 
 enum KickMode { KM_Null, KM_Hard, KM_Quick };
 
@@ -45,10 +46,20 @@ public:
   static Kicker &instance();
 
   /**
-   * 计算mKickerValue表
-   * Compute kicker value table.
+   * 多线程计算某个球员类型的mKickerValue表并写入文件
+   * Compute kicker value table of a player type in parallel and save it.
    */
-  void ComputeUtilityTable();
+  void ComputeUtilityTable(int player_type = 0);
+
+  /**
+   * 请求在后台线程中按真实参数准备某个球员类型的表，不符或缺失的重新计算。
+   * 收到所有player_type后先请求自己的类型，之后看到换人或用到别的类型时再请求，
+   * 每种类型只准备一次，决策线程不会在比赛中途算表
+   * Queue the table of a player type to be checked against the real params,
+   * and recomputed if missing or stale, on a background thread. Each type is
+   * prepared at most once, and only when it is actually needed.
+   */
+  void RequestUtilityTable(int player_type);
 
   /**
    * 通过kick的误差模型计算踢球后的max_rand
@@ -94,6 +105,39 @@ public:
   void Execute(Agent &agent, const ActionPlan &plan);
 
 private:
+  enum {
+    STEP_KICK_ANGLE = 10, // Kicker类中搜索角度的步长，共有360 / 10 = 36个角度
+    POINTS_NUM = 81, // Kicker类中搜索的总点数，POINTS_NUM = nlayer[0] +
+                     // nlayer[1] + nlayer[2]
+    KICK_ANGLE_NUM = 360 / STEP_KICK_ANGLE,
+    UTILITY_TABLE_VERSION = 1
+  };
+
+  typedef float UtilitySlice[KICK_ANGLE_NUM][POINTS_NUM][POINTS_NUM];
+
+  struct UtilityTableTask;
+  class UtilityTableWorker;
+  class UtilityTablePreparer;
+  struct UtilityTable;
+
+  /** 计算某个踢球角度下的值函数，供多线程调用 */
+  void ComputeUtilitySlice(UtilityTableTask &task, int angle);
+
+  /**
+   * kicker_value文件头，后面紧跟3个UtilitySlice
+   * Header of kicker_value file, followed by 3 UtilitySlice.
+   */
+  struct UtilityTableHeader {
+    char mMagic[4];      /** "WEKV" */
+    int mVersion;        /** UTILITY_TABLE_VERSION */
+    int mPointsNum;      /** POINTS_NUM */
+    int mAngleNum;       /** KICK_ANGLE_NUM */
+    int mNlayer[3];      /** 每层的离散点数 */
+    unsigned mParamHash; /** ServerParam及对应球员类型的参数校验值 */
+    unsigned mChecksum;  /** 数据部分的校验值 */
+    int mReserved[7];    /** 保持头部为64字节 */
+  };
+
   /** 在离散点钟寻找最近的一个点 */
   inline int NearestPoint(const Vector &p) {
     double ang = 0.0;
@@ -120,8 +164,37 @@ private:
     }
   }
 
-  /** 读取mKickerValue表 */
-  void ReadUtilityTable();
+  /**
+   * 得到某个球员类型的值函数表，还没准备好时用0号类型的表，own表示是否为该类型自己的表。
+   * 没有收到球员类型时（离线、无头模式）第一次用到时读取0号类型的表
+   * Get the kicker value table of a player type, or the type-0 table while the
+   * type's own table is not ready yet.
+   */
+  const UtilitySlice *ReadUtilityTable(int player_type, bool *own);
+
+  /**
+   * 校验并（必要时）重算一种球员类型的表，已是当前参数下的表则什么都不做。
+   * 同一类型同时只有一个线程在准备，另一个线程会等它做完
+   */
+  void PrepareUtilityTable(int player_type);
+
+  /** 计算表并存入文件，再映射回来；写不了文件时用内存中的表 */
+  bool BuildUtilityTable(int player_type, UtilityTable &table);
+
+  /** 换上新表，旧表可能正被决策线程使用，留到析构时再释放 */
+  void SetUtilityTable(int player_type, const UtilityTable &table);
+
+  /** 球员类型对应的kicker value文件 */
+  static std::string GetUtilityTableFile(int player_type);
+
+  /** 计算当前参数下kicker value表的校验值 */
+  unsigned GetUtilityTableHash(int player_type) const;
+
+  /** 映射或读取文件中的kicker value表，成功返回true */
+  bool LoadUtilityTable(int player_type, UtilityTable &table);
+
+  /** 释放kicker value表所占的内存或映射 */
+  static void FreeUtilityTable(UtilityTable &table);
 
   /** 更新kick的数据，里面有时间控制 */
   void UpdateKickData(const Agent &agent);
@@ -169,12 +242,6 @@ private:
   AtomicAction TurnPlan(const Agent &agent, int index, double turn_max_speed);
 
 private:
-  enum {
-    STEP_KICK_ANGLE = 10, // Kicker类中搜索角度的步长，共有360 / 10 = 36个角度
-    POINTS_NUM = 81 // Kicker类中搜索的总点数，POINTS_NUM = nlayer[0] +
-                    // nlayer[1] + nlayer[2]
-  };
-
   AgentID mAgentID;
 
   Array<int, 3> mNlayer;            /** 每层的离散点数 */
@@ -183,8 +250,30 @@ private:
   Array<double, 3> mDlayer;         /** 每层的半径 */
   Array<Vector, POINTS_NUM> mPoint; /** 存储所有点 */
 
-  float mKickerValue[3][36][POINTS_NUM][POINTS_NUM];
-      /** 2,3,4脚踢球，36个角度，POINTS_NUM个点 */ // float即可，节省所占空间
+  /** 一种球员类型的值函数表 */
+  struct UtilityTable {
+    const UtilitySlice *mValue;
+        /** 2,3,4脚踢球，36个角度，POINTS_NUM个点 */ // float即可，节省所占空间
+    void *mMap;         /** mmap得到的整个文件，为0时mValue在堆上 */
+    size_t mMapSize;    /** 映射的长度 */
+    unsigned mParamHash; /** 表对应的参数校验值 */
+
+    UtilityTable() : mValue(0), mMap(0), mMapSize(0), mParamHash(0) {}
+  };
+
+  std::vector<UtilityTable> mUtilityTable; /** 每种球员类型一张表 */
+  std::vector<UtilityTable> mRetiredTable; /** 被换下的表，析构时释放 */
+  std::vector<char> mPreparing; /** 正在准备的类型 */
+  std::vector<char> mRequested; /** 已经请求过后台准备的类型 */
+  std::vector<int> mRequestQueue; /** 等待后台准备的类型 */
+  int mUtilityTableGeneration; /** 每换一次表加一 */
+  ThreadMutex mUtilityTableMutex; /** 保护以上各项，后台线程换表，决策线程取表 */
+  ThreadSemaphore mPreparerWake; /** 有新请求或要退出时唤醒后台线程 */
+  bool mPreparerQuit;
+  UtilityTablePreparer *mpPreparer; /** 第一次请求时启动的后台线程 */
+  const UtilitySlice *mKickerValue; /** 当前球员类型的表，在UpdateKickData中选择 */
+  bool mKickerValueOwn; /** mKickerValue是否为当前类型自己的表 */
+  int mKickerValueGeneration; /** 取mKickerValue时的mUtilityTableGeneration */
 
   ReciprocalCurve mOppCurve;   /** 对手的影响 */
   ReciprocalCurve mRandCurve;  /** 误差的影响 */
@@ -60,19 +60,61 @@ SightLogger::SightLogger(Observer *observer, WorldState *world_state) {
   mTeamState_dirty = true;
 
   char file_name[256];
-  sprintf(file_name, "%s/%s-%d-sight.log",
-          PlayerParam::instance().logDir().c_str(),
-          PlayerParam::instance().teamName().c_str(), mpObserver->SelfUnum());
-  os.open(file_name);
-  if (!os.good()) {
-    PRINT_ERROR("open sight log file error");
+  if (PlayerParam::instance().SightLogBinary()) {
+    sprintf(file_name, "%s/%s-%d-sight.wml",
+            PlayerParam::instance().logDir().c_str(),
+            PlayerParam::instance().teamName().c_str(),
+            mpObserver->SelfUnum());
+    if (!mMatchLog.Open(file_name)) {
+      PRINT_ERROR("open sight log file error");
+    }
+  } else {
+    sprintf(file_name, "%s/%s-%d-sight.log",
+            PlayerParam::instance().logDir().c_str(),
+            PlayerParam::instance().teamName().c_str(),
+            mpObserver->SelfUnum());
+    os.open(file_name);
+    if (!os.good()) {
+      PRINT_ERROR("open sight log file error");
+    }
   }
 }
 
 /**
  * SightLogger's destructor
  */
-SightLogger::~SightLogger() { os.close(); }
+SightLogger::~SightLogger() {
+  mMatchLog.Close();
+  os.close();
+}
+
+const char *SightLogger::ColorName(Color color) {
+  switch (color) {
+  case Red:
+    return "red";
+  case Blue:
+    return "blue";
+  case Green:
+    return "green";
+  case Navy:
+    return "navy";
+  case Orange:
+    return "orange";
+  case Cyan:
+    return "cyan";
+  case Purple:
+    return "purple";
+  case White:
+    return "white";
+  case Black:
+    return "black";
+  case Yellow:
+    return "yellow";
+  case Olive:
+    return "olive";
+  }
+  return "black";
+}
 
 /**
  * Set sever param message of the sight log
@@ -103,6 +145,17 @@ void SightLogger::SetPlayerTypeMsg(const char *msg) {
   }
 }
 
+/**
+ * Write one show record, to the binary match log or as rcg text.
+ */
+void SightLogger::LogShow(const MatchLogShow &show) {
+  if (mMatchLog.IsOpen()) {
+    mMatchLog.AddShow(show);
+  } else {
+    os << show << '\n';
+  }
+}
+
 /**
  * Flush sight log to file.
  */
@@ -110,28 +163,37 @@ void SightLogger::Flush() {
   static const double prec = 0.0001;
 
   if (mHeaderReady && PlayerParam::instance().SaveSightLog()) {
+    MatchLogShow show;
+
     if (!mHeaderLogged) {
       mHeaderLogged = true;
-      os << mHeader << mServerParamMsg << mPlayerParamMsg << mPlayerTypeMsg;
+      if (mMatchLog.IsOpen()) {
+        mMatchLog.SetHeader(mHeader + mServerParamMsg + mPlayerParamMsg +
+                            mPlayerTypeMsg);
+      } else {
+        os << mHeader << mServerParamMsg << mPlayerParamMsg << mPlayerTypeMsg;
+      }
+
+      show.mTime = 0;
+      show.mBall[0] = Quantize(mpBall->GetPos().X(), prec);
+      show.mBall[1] = Quantize(mpBall->GetPos().Y(), prec);
+      show.mBall[2] = Quantize(mpBall->GetVel().X(), prec);
+      show.mBall[3] = Quantize(mpBall->GetVel().Y(), prec);
+
+      for (int i = 0; i < TEAMSIZE * 2; ++i) {
+        MatchLogShow::Player &player = show.mPlayers[i];
+        player.mType = 0;
+        player.mState = 0;
+        player.mPos[0] = (i % TEAMSIZE + 1) * 4.0 * (i < TEAMSIZE ? -1 : 1);
+        player.mPos[1] = -37.0;
+        player.mVel[0] = player.mVel[1] = 0.0;
+        player.mBodyDir = player.mNeckDir = 0.0;
+        player.mViewAngle = 60.0;
+        player.mStamina = player.mEffort = 0.0;
+      }
 
       for (int i = 0; i < mTime.S(); ++i) {
-        os << "(show " << 0 << " ((b)" << ' '
-           << Quantize(mpBall->GetPos().X(), prec) << ' '
-           << Quantize(mpBall->GetPos().Y(), prec) << ' '
-           << Quantize(mpBall->GetVel().X(), prec) << ' '
-           << Quantize(mpBall->GetVel().Y(), prec) << ')';
-
-        for (char side = 'l'; side <= 'r'; side += 'r' - 'l') {
-          for (Unum i = 1; i <= TEAMSIZE; ++i) {
-            os << " ((" << side << ' ' << i << ')' << ' ' << 0 << ' ' << "0x0"
-               << ' ' << i * 4.0 * (side == 'l' ? -1 : 1) << ' ' << -37.0 << ' '
-               << 0 << ' ' << 0 << ' ' << 0 << ' ' << 0 << " (v h " << 60 << ')'
-               << " (s " << 0 << ' ' << 0 << ' ' << '1' << ')'
-               << " (c 0 0 0 0 0 0 0 0 0 0 0))";
-            // end of player
-          }
-        }
-        os << ")\n";
+        LogShow(show);
       }
     }
 
@@ -139,56 +201,64 @@ void SightLogger::Flush() {
 
     if (mServerPlayMode_dirty) {
       mServerPlayMode_dirty = false;
-      os << "(playmode " << mTime.T() << ' '
-         << ServerPlayModeMap::instance().GetPlayModeString(mServerPlayMode)
-         << ")\n";
+      if (mMatchLog.IsOpen()) {
+        mMatchLog.AddPlayMode(mTime.T(), mServerPlayMode);
+      } else {
+        os << "(playmode " << mTime.T() << ' '
+           << ServerPlayModeMap::instance().GetPlayModeString(mServerPlayMode)
+           << ")\n";
+      }
     }
 
     if (mTeamState_dirty) {
       mTeamState_dirty = false;
-      os << "(team " << mTime.T() << ' '
-         << (mLeftName.empty() ? "null" : mLeftName.c_str()) << ' '
-         << (mRightName.empty() ? "null" : mRightName.c_str()) << ' '
-         << mLeftScore << ' ' << mRightScore << ")\n";
+      const std::string left_name = mLeftName.empty() ? "null" : mLeftName;
+      const std::string right_name = mRightName.empty() ? "null" : mRightName;
+      if (mMatchLog.IsOpen()) {
+        mMatchLog.AddTeam(mTime.T(), left_name, right_name, mLeftScore,
+                          mRightScore);
+      } else {
+        os << "(team " << mTime.T() << ' ' << left_name << ' ' << right_name
+           << ' ' << mLeftScore << ' ' << mRightScore << ")\n";
+      }
     }
 
-    os << "(show " << mTime.T() << " ((b)" << ' '
-       << Quantize(mpBall->GetPos().X(), prec) << ' '
-       << Quantize(mpBall->GetPos().Y(), prec) << ' '
-       << Quantize(mpBall->GetVel().X(), prec) << ' '
-       << Quantize(mpBall->GetVel().Y(), prec) << ')';
+    show.mTime = mTime.T();
+    show.mBall[0] = Quantize(mpBall->GetPos().X(), prec);
+    show.mBall[1] = Quantize(mpBall->GetPos().Y(), prec);
+    show.mBall[2] = Quantize(mpBall->GetVel().X(), prec);
+    show.mBall[3] = Quantize(mpBall->GetVel().Y(), prec);
 
     LogBallInfo(*mpBall);
 
     const PlayerState *p;
-    for (char side = 'l'; side <= 'r'; side += 'r' - 'l') {
-      for (Unum i = 1; i <= TEAMSIZE; ++i) {
-        p = (side == 'l') ? mpLeftTeam[i] : mpRightTeam[i];
-
-        if (p->IsAlive()) {
-          LogPlayerInfo(*p);
-        }
+    for (int i = 0; i < TEAMSIZE * 2; ++i) {
+      const bool left = i < TEAMSIZE;
+      const Unum unum = i % TEAMSIZE + 1;
+      p = left ? mpLeftTeam[unum] : mpRightTeam[unum];
 
-        os << " ((" << side << ' ' << i << ')' << ' ' << p->GetPlayerType()
-           << ' ' << (p->IsAlive() ? (p->IsGoalie() ? "0x9" : "0x1") : "0x0")
-           << ' '
-           << (p->IsAlive() ? Quantize(p->GetPos().X(), prec)
-                            : i * 4.0 * (side == 'l' ? -1 : 1))
-           << ' ' << (p->IsAlive() ? Quantize(p->GetPos().Y(), prec) : -37.0)
-           << ' ' << Quantize(p->GetVel().X(), prec) << ' '
-           << Quantize(p->GetVel().Y(), prec) << ' '
-           << Quantize(p->GetBodyDir(), prec) << ' '
-           << Quantize(p->GetNeckDir(), prec) << " (v h "
-           << sight::ViewAngle(p->GetViewWidth()) << ')' << " (s "
-           << p->GetStamina() << ' ' << p->GetEffort() << ' ' << '1' << ')'
-           << " (c 0 0 0 0 0 0 0 0 0 0 0))";
-        // end of player
+      if (p->IsAlive()) {
+        LogPlayerInfo(*p);
       }
+
+      MatchLogShow::Player &player = show.mPlayers[i];
+      player.mType = p->GetPlayerType();
+      player.mState = p->IsAlive() ? (p->IsGoalie() ? 0x9 : 0x1) : 0x0;
+      player.mPos[0] = p->IsAlive() ? Quantize(p->GetPos().X(), prec)
+                                    : unum * 4.0 * (left ? -1 : 1);
+      player.mPos[1] = p->IsAlive() ? Quantize(p->GetPos().Y(), prec) : -37.0;
+      player.mVel[0] = Quantize(p->GetVel().X(), prec);
+      player.mVel[1] = Quantize(p->GetVel().Y(), prec);
+      player.mBodyDir = Quantize(p->GetBodyDir(), prec);
+      player.mNeckDir = Quantize(p->GetNeckDir(), prec);
+      player.mViewAngle = sight::ViewAngle(p->GetViewWidth());
+      player.mStamina = p->GetStamina();
+      player.mEffort = p->GetEffort();
     }
 
     mSightMutex.UnLock();
 
-    os << ")\n";
+    LogShow(show);
     os.flush();
   }
 
@@ -198,21 +268,34 @@ void SightLogger::Flush() {
     if (!points.empty()) {
       for (std::vector<PointShape>::iterator it = points.begin();
            it != points.end(); it++) {
-        os << "(draw " << time << ' ' << *it << ")\n";
+        if (mMatchLog.IsOpen()) {
+          mMatchLog.AddPoint(time, it->line_color, it->x, it->y, it->comment);
+        } else {
+          os << "(draw " << time << ' ' << *it << ")\n";
+        }
       }
       points.clear();
     }
     if (!lines.empty()) {
       for (std::vector<LineShape>::iterator it = lines.begin();
            it != lines.end(); it++) {
-        os << "(draw " << time << ' ' << *it << ")\n";
+        if (mMatchLog.IsOpen()) {
+          mMatchLog.AddLine(time, it->line_color, it->x1, it->y1, it->x2,
+                            it->y2);
+        } else {
+          os << "(draw " << time << ' ' << *it << ")\n";
+        }
       }
       lines.clear();
     }
     if (!circles.empty()) {
       for (std::vector<CircleShape>::iterator it = circles.begin();
            it != circles.end(); it++) {
-        os << "(draw " << time << ' ' << *it << ")\n";
+        if (mMatchLog.IsOpen()) {
+          mMatchLog.AddCircle(time, it->line_color, it->x, it->y, it->radius);
+        } else {
+          os << "(draw " << time << ' ' << *it << ")\n";
+        }
       }
       circles.clear();
     }
@@ -33,6 +33,7 @@
 #define __Logger_H__
 
 #include "Geometry.h"
+#include "MatchLog.h"
 #include "Thread.h"
 #include "Types.h"
 #include "WorldState.h"
@@ -67,6 +68,8 @@ public:
     Olive
   };
 
+  static const char *ColorName(Color color);
+
   /** Constructor & destructor */
   SightLogger(Observer *observer, WorldState *world_state);
   ~SightLogger();
@@ -104,8 +107,13 @@ public:
   void LogPlayerInfo(const PlayerState &player);
   void LogBallInfo(const BallState &ball);
 
+private:
+  /** 写一个周期的show，二进制或rcg文本 */
+  void LogShow(const MatchLogShow &show);
+
 private:
   std::ofstream os;
+  MatchLogWriter mMatchLog; // sight_log_binary时代替os
   ThreadMutex mSightMutex;
   ThreadMutex mDecMutex;
 
@@ -137,33 +145,7 @@ private:
   struct ItemShape {
     Color line_color;
 
-    const char *color() const {
-      switch (line_color) {
-      case Red:
-        return "red";
-      case Blue:
-        return "blue";
-      case Green:
-        return "green";
-      case Navy:
-        return "navy";
-      case Orange:
-        return "orange";
-      case Cyan:
-        return "cyan";
-      case Purple:
-        return "purple";
-      case White:
-        return "white";
-      case Black:
-        return "black";
-      case Yellow:
-        return "yellow";
-      case Olive:
-        return "olive";
-      }
-      return "black";
-    }
+    const char *color() const { return ColorName(line_color); }
 
     ItemShape(Color color) { line_color = color; }
   };
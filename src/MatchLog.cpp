@@ -0,0 +1,734 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#include "MatchLog.h"
+#include "Logger.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+const char MATCH_LOG_MAGIC[4] = {'W', 'E', 'M', 'L'};
+const char BLOCK_MAGIC[4] = {'W', 'E', 'M', 'B'};
+const char INDEX_MAGIC[4] = {'W', 'E', 'M', 'I'};
+const int MATCH_LOG_VERSION = 1;
+
+/** 每块的周期数，随机访问时最多多解码这么多周期 */
+const int BLOCK_CYCLES = 100;
+
+const int PLAYERS = TEAMSIZE * 2;
+
+/** 每名球员的列 */
+enum PlayerColumn {
+  PC_Type,
+  PC_State,
+  PC_PosX,
+  PC_PosY,
+  PC_VelX,
+  PC_VelY,
+  PC_BodyDir,
+  PC_NeckDir,
+  PC_ViewAngle,
+  PC_Stamina,
+  PC_Effort,
+
+  PC_Max
+};
+
+/** 各列的量化精度，位置、速度和角度与rcg文本一致 */
+const double BALL_PREC = 0.0001;
+const double PLAYER_PREC[PC_Max] = {1.0,    1.0,    0.0001, 0.0001,
+                                    0.0001, 0.0001, 0.0001, 0.0001,
+                                    0.0001, 0.001,  0.000001};
+
+/** 时间、球的4列，然后按字段排列22名球员 */
+const int BALL_COLUMN = 1;
+const int PLAYER_COLUMN = BALL_COLUMN + 4;
+const int COLUMNS = PLAYER_COLUMN + PC_Max * PLAYERS;
+
+inline int PlayerColumnIndex(int column, int player) {
+  return PLAYER_COLUMN + column * PLAYERS + player;
+}
+
+enum EventKind { EK_PlayMode, EK_Team, EK_Point, EK_Line, EK_Circle };
+
+struct FileHeader {
+  char mMagic[4]; /// "WEML"
+  int mVersion;
+  int mBlockCycles;
+  int mHeaderSize; /// 之后是这么长的rcg文件头
+};
+
+struct BlockHeader {
+  char mMagic[4]; /// "WEMB"
+  int mCycles;
+  int mEvents;
+  int mFirstTime; /// 块内第一个周期的时间，没有周期时为上一个周期的时间
+  int mPlayMode;  /// 块开始时的playmode
+  int mSize;      /// 之后编码数据的字节数
+};
+
+struct IndexEntry {
+  long long mOffset;
+  int mFirstTime;
+  int mReserved;
+};
+
+struct IndexTrailer {
+  long long mOffset; /// 索引的文件偏移
+  int mBlocks;
+  char mMagic[4]; /// "WEMI"
+};
+
+inline int QuantizeToInt(const double v, const double prec) {
+  return static_cast<int>(Rint(v / prec));
+}
+
+void PutVarint(std::string &buf, unsigned value) {
+  while (value >= 0x80) {
+    buf += static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  buf += static_cast<char>(value);
+}
+
+/** zigzag编码，绝对值小的负数也只占1字节 */
+inline void PutInt(std::string &buf, int value) {
+  PutVarint(buf, (static_cast<unsigned>(value) << 1) ^
+                     static_cast<unsigned>(value >> 31));
+}
+
+inline void PutDouble(std::string &buf, double value) {
+  buf.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+inline void PutString(std::string &buf, const std::string &str) {
+  PutVarint(buf, str.size());
+  buf += str;
+}
+
+/** 按顺序解码一个块的数据，越界后mOk为false */
+struct BlockDecoder {
+  const unsigned char *mpData;
+  const unsigned char *mpEnd;
+  bool mOk;
+
+  BlockDecoder(const char *data, int size)
+      : mpData(reinterpret_cast<const unsigned char *>(data)),
+        mpEnd(mpData + size), mOk(true) {}
+
+  unsigned GetVarint() {
+    unsigned value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+      if (mpData >= mpEnd) {
+        mOk = false;
+        return 0;
+      }
+      const unsigned byte = *mpData++;
+      value |= (byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+    mOk = false;
+    return 0;
+  }
+
+  int GetInt() {
+    const unsigned value = GetVarint();
+    return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+  }
+
+  double GetDouble() {
+    double value = 0.0;
+    if (mpEnd - mpData < (int)sizeof(value)) {
+      mOk = false;
+      return value;
+    }
+    memcpy(&value, mpData, sizeof(value));
+    mpData += sizeof(value);
+    return value;
+  }
+
+  std::string GetString() {
+    const unsigned size = GetVarint();
+    if (!mOk || (unsigned)(mpEnd - mpData) < size) {
+      mOk = false;
+      return std::string();
+    }
+    std::string str(reinterpret_cast<const char *>(mpData), size);
+    mpData += size;
+    return str;
+  }
+};
+} // namespace
+
+std::ostream &operator<<(std::ostream &os, const MatchLogShow &show) {
+  os << "(show " << show.mTime << " ((b)" << ' ' << show.mBall[0] << ' '
+     << show.mBall[1] << ' ' << show.mBall[2] << ' ' << show.mBall[3] << ')';
+
+  for (int i = 0; i < PLAYERS; ++i) {
+    const MatchLogShow::Player &p = show.mPlayers[i];
+
+    os << " ((" << (i < TEAMSIZE ? 'l' : 'r') << ' ' << i % TEAMSIZE + 1
+       << ')' << ' ' << p.mType << ' ' << "0x" << std::hex << p.mState
+       << std::dec << ' ' << p.mPos[0] << ' ' << p.mPos[1] << ' '
+       << p.mVel[0] << ' ' << p.mVel[1] << ' ' << p.mBodyDir << ' '
+       << p.mNeckDir << " (v h " << p.mViewAngle << ')' << " (s "
+       << p.mStamina << ' ' << p.mEffort << ' ' << '1' << ')'
+       << " (c 0 0 0 0 0 0 0 0 0 0 0))";
+    // end of player
+  }
+
+  return os << ')';
+}
+
+MatchLogWriter::MatchLogWriter()
+    : mpFile(0), mHeaderWritten(false), mPlayMode(SPM_Null),
+      mLastPlayMode(SPM_Null), mLastTime(0), mCycles(0), mEventCount(0) {}
+
+MatchLogWriter::~MatchLogWriter() { Close(); }
+
+bool MatchLogWriter::Open(const char *file_name) {
+  Close();
+  mpFile = fopen(file_name, "wb");
+  return mpFile != 0;
+}
+
+void MatchLogWriter::Close() {
+  if (!mpFile) {
+    return;
+  }
+
+  WriteBlock(); // 没有任何记录时也会写出文件头，保证是合法的空记录
+
+  IndexTrailer trailer;
+  memset(&trailer, 0, sizeof(trailer));
+  trailer.mOffset = ftell(mpFile);
+  trailer.mBlocks = mIndexTime.size();
+  memcpy(trailer.mMagic, INDEX_MAGIC, 4);
+
+  for (unsigned i = 0; i < mIndexTime.size(); ++i) {
+    IndexEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.mOffset = mIndexOffset[i];
+    entry.mFirstTime = mIndexTime[i];
+    fwrite(&entry, sizeof(entry), 1, mpFile);
+  }
+  fwrite(&trailer, sizeof(trailer), 1, mpFile);
+
+  fclose(mpFile);
+  mpFile = 0;
+}
+
+void MatchLogWriter::AddShow(const MatchLogShow &show) {
+  mRows.resize((mCycles + 1) * COLUMNS);
+  int *row = &mRows[mCycles * COLUMNS];
+
+  row[0] = show.mTime;
+  for (int i = 0; i < 4; ++i) {
+    row[BALL_COLUMN + i] = QuantizeToInt(show.mBall[i], BALL_PREC);
+  }
+
+  for (int i = 0; i < PLAYERS; ++i) {
+    const MatchLogShow::Player &p = show.mPlayers[i];
+    const double values[PC_Max] = {
+        double(p.mType), double(p.mState), p.mPos[0],    p.mPos[1],
+        p.mVel[0],       p.mVel[1],        p.mBodyDir,   p.mNeckDir,
+        p.mViewAngle,    p.mStamina,       p.mEffort};
+
+    for (int column = 0; column < PC_Max; ++column) {
+      row[PlayerColumnIndex(column, i)] =
+          QuantizeToInt(values[column], PLAYER_PREC[column]);
+    }
+  }
+
+  mLastTime = show.mTime;
+  if (++mCycles >= BLOCK_CYCLES) {
+    WriteBlock();
+  }
+}
+
+void MatchLogWriter::AddEventHead(int kind, int time, int color) {
+  PutVarint(mEvents, kind);
+  PutVarint(mEvents, mCycles);
+  PutInt(mEvents, time);
+  PutVarint(mEvents, color);
+  ++mEventCount;
+}
+
+void MatchLogWriter::AddPlayMode(int time, ServerPlayMode play_mode) {
+  AddEventHead(EK_PlayMode, time, 0);
+  PutVarint(mEvents, play_mode);
+  mLastPlayMode = play_mode;
+}
+
+void MatchLogWriter::AddTeam(int time, const std::string &left_name,
+                             const std::string &right_name, int left_score,
+                             int right_score) {
+  AddEventHead(EK_Team, time, 0);
+  PutString(mEvents, left_name);
+  PutString(mEvents, right_name);
+  PutInt(mEvents, left_score);
+  PutInt(mEvents, right_score);
+}
+
+void MatchLogWriter::AddPoint(int time, int color, double x, double y,
+                              const std::string &comment) {
+  AddEventHead(EK_Point, time, color);
+  PutDouble(mEvents, x);
+  PutDouble(mEvents, y);
+  PutString(mEvents, comment);
+}
+
+void MatchLogWriter::AddLine(int time, int color, double x1, double y1,
+                             double x2, double y2) {
+  AddEventHead(EK_Line, time, color);
+  PutDouble(mEvents, x1);
+  PutDouble(mEvents, y1);
+  PutDouble(mEvents, x2);
+  PutDouble(mEvents, y2);
+}
+
+void MatchLogWriter::AddCircle(int time, int color, double x, double y,
+                               double radius) {
+  AddEventHead(EK_Circle, time, color);
+  PutDouble(mEvents, x);
+  PutDouble(mEvents, y);
+  PutDouble(mEvents, radius);
+}
+
+/**
+ * 把当前块按列编码后写出，每块写完都刷新到磁盘，进程被杀最多丢一块
+ */
+void MatchLogWriter::WriteBlock() {
+  if (!mpFile || (mHeaderWritten && mCycles == 0 && mEventCount == 0)) {
+    return;
+  }
+
+  if (!mHeaderWritten) {
+    mHeaderWritten = true;
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.mMagic, MATCH_LOG_MAGIC, 4);
+    header.mVersion = MATCH_LOG_VERSION;
+    header.mBlockCycles = BLOCK_CYCLES;
+    header.mHeaderSize = mHeader.size();
+    fwrite(&header, sizeof(header), 1, mpFile);
+    fwrite(mHeader.data(), 1, mHeader.size(), mpFile);
+
+    if (mCycles == 0 && mEventCount == 0) {
+      return;
+    }
+  }
+
+  std::string data;
+  data.reserve(mCycles * COLUMNS * 2 + mEvents.size());
+  for (int column = 0; column < COLUMNS; ++column) {
+    int last = 0;
+    for (int i = 0; i < mCycles; ++i) {
+      const int value = mRows[i * COLUMNS + column];
+      PutInt(data, value - last);
+      last = value;
+    }
+  }
+  data += mEvents;
+
+  BlockHeader block;
+  memset(&block, 0, sizeof(block));
+  memcpy(block.mMagic, BLOCK_MAGIC, 4);
+  block.mCycles = mCycles;
+  block.mEvents = mEventCount;
+  block.mFirstTime = mCycles > 0 ? mRows[0] : mLastTime;
+  block.mPlayMode = mPlayMode;
+  block.mSize = data.size();
+
+  mIndexTime.push_back(block.mFirstTime);
+  mIndexOffset.push_back(ftell(mpFile));
+
+  fwrite(&block, sizeof(block), 1, mpFile);
+  fwrite(data.data(), 1, data.size(), mpFile);
+  fflush(mpFile);
+
+  mRows.clear();
+  mCycles = 0;
+  mEvents.clear();
+  mEventCount = 0;
+  mPlayMode = mLastPlayMode;
+}
+
+MatchLogReader::MatchLogReader()
+    : mpFile(0), mBlock(-1), mCycles(0), mCycle(0), mNextEvent(0),
+      mPlayMode(SPM_Null) {}
+
+MatchLogReader::~MatchLogReader() { Close(); }
+
+bool MatchLogReader::IsMatchLog(const char *file_name) {
+  FILE *fp = fopen(file_name, "rb");
+  if (!fp) {
+    return false;
+  }
+
+  char magic[4];
+  const bool valid =
+      fread(magic, 4, 1, fp) == 1 && memcmp(magic, MATCH_LOG_MAGIC, 4) == 0;
+  fclose(fp);
+  return valid;
+}
+
+bool MatchLogReader::Open(const char *file_name) {
+  Close();
+
+  if ((mpFile = fopen(file_name, "rb")) == 0) {
+    perror("MatchLogReader::Open");
+    return false;
+  }
+
+  FileHeader header;
+  if (fread(&header, sizeof(header), 1, mpFile) != 1 ||
+      memcmp(header.mMagic, MATCH_LOG_MAGIC, 4) != 0 ||
+      header.mVersion != MATCH_LOG_VERSION || header.mHeaderSize < 0) {
+    PRINT_ERROR("bad match log " << file_name);
+    Close();
+    return false;
+  }
+
+  mHeader.resize(header.mHeaderSize);
+  if (header.mHeaderSize > 0 &&
+      fread(&mHeader[0], 1, header.mHeaderSize, mpFile) !=
+          (size_t)header.mHeaderSize) {
+    PRINT_ERROR("bad match log header " << file_name);
+    Close();
+    return false;
+  }
+
+  if (!BuildIndex()) {
+    Close();
+    return false;
+  }
+  return true;
+}
+
+void MatchLogReader::Close() {
+  if (mpFile) {
+    fclose(mpFile);
+    mpFile = 0;
+  }
+  mHeader.clear();
+  mIndexTime.clear();
+  mIndexOffset.clear();
+  mBlock = -1;
+  mCycles = 0;
+  mCycle = 0;
+  mColumns.clear();
+  mEvents.clear();
+  mNextEvent = 0;
+  mPlayMode = SPM_Null;
+}
+
+/**
+ * 读末尾的索引；没有索引时（进程被杀）从头扫描各块，截断的最后一块丢掉
+ */
+bool MatchLogReader::BuildIndex() {
+  const long data_begin = ftell(mpFile);
+  fseek(mpFile, 0, SEEK_END);
+  const long file_size = ftell(mpFile);
+
+  IndexTrailer trailer;
+  if (file_size >= data_begin + (long)sizeof(trailer) &&
+      fseek(mpFile, file_size - sizeof(trailer), SEEK_SET) == 0 &&
+      fread(&trailer, sizeof(trailer), 1, mpFile) == 1 &&
+      memcmp(trailer.mMagic, INDEX_MAGIC, 4) == 0 && trailer.mBlocks >= 0 &&
+      trailer.mOffset + trailer.mBlocks * (long long)sizeof(IndexEntry) +
+              (long long)sizeof(trailer) ==
+          file_size) {
+    std::vector<IndexEntry> entries(trailer.mBlocks);
+    fseek(mpFile, trailer.mOffset, SEEK_SET);
+    if (entries.empty() || fread(&entries[0], sizeof(IndexEntry),
+                                 entries.size(), mpFile) == entries.size()) {
+      for (unsigned i = 0; i < entries.size(); ++i) {
+        mIndexTime.push_back(entries[i].mFirstTime);
+        mIndexOffset.push_back(entries[i].mOffset);
+      }
+      return true;
+    }
+  }
+
+  long offset = data_begin;
+  BlockHeader block;
+  while (fseek(mpFile, offset, SEEK_SET) == 0 &&
+         fread(&block, sizeof(block), 1, mpFile) == 1 &&
+         memcmp(block.mMagic, BLOCK_MAGIC, 4) == 0 && block.mSize >= 0 &&
+         offset + (long)sizeof(block) + block.mSize <= file_size) {
+    mIndexTime.push_back(block.mFirstTime);
+    mIndexOffset.push_back(offset);
+    offset += sizeof(block) + block.mSize;
+  }
+  return true;
+}
+
+bool MatchLogReader::LoadBlock(int block) {
+  BlockHeader header;
+  if (block < 0 || block >= GetBlockNum() ||
+      fseek(mpFile, mIndexOffset[block], SEEK_SET) != 0 ||
+      fread(&header, sizeof(header), 1, mpFile) != 1 ||
+      memcmp(header.mMagic, BLOCK_MAGIC, 4) != 0 || header.mCycles < 0 ||
+      header.mEvents < 0 || header.mSize < 0) {
+    return false;
+  }
+
+  std::vector<char> data(header.mSize + 1); // 多一字节，空块也能取地址
+  if (fread(&data[0], 1, header.mSize, mpFile) != (size_t)header.mSize) {
+    return false;
+  }
+
+  BlockDecoder decoder(&data[0], header.mSize);
+
+  mColumns.resize(header.mCycles * COLUMNS);
+  for (int column = 0; column < COLUMNS && header.mCycles > 0; ++column) {
+    int *values = &mColumns[column * header.mCycles];
+    int last = 0;
+    for (int i = 0; i < header.mCycles; ++i) {
+      last += decoder.GetInt();
+      values[i] = last;
+    }
+  }
+
+  mEvents.resize(header.mEvents);
+  for (int i = 0; i < header.mEvents; ++i) {
+    Event &event = mEvents[i];
+    event.mKind = decoder.GetVarint();
+    event.mCycle = decoder.GetVarint();
+    event.mTime = decoder.GetInt();
+    event.mColor = decoder.GetVarint();
+
+    switch (event.mKind) {
+    case EK_PlayMode:
+      event.mValue[0] = decoder.GetVarint();
+      break;
+    case EK_Team:
+      event.mText[0] = decoder.GetString();
+      event.mText[1] = decoder.GetString();
+      event.mValue[0] = decoder.GetInt();
+      event.mValue[1] = decoder.GetInt();
+      break;
+    case EK_Point:
+      event.mCoord[0] = decoder.GetDouble();
+      event.mCoord[1] = decoder.GetDouble();
+      event.mText[0] = decoder.GetString();
+      break;
+    case EK_Line:
+      for (int j = 0; j < 4; ++j) {
+        event.mCoord[j] = decoder.GetDouble();
+      }
+      break;
+    case EK_Circle:
+      for (int j = 0; j < 3; ++j) {
+        event.mCoord[j] = decoder.GetDouble();
+      }
+      break;
+    default:
+      decoder.mOk = false;
+      break;
+    }
+
+    if (!decoder.mOk) {
+      break;
+    }
+  }
+
+  if (!decoder.mOk) {
+    PRINT_ERROR("bad match log block " << block);
+    mBlock = -1;
+    mCycles = 0;
+    return false;
+  }
+
+  mBlock = block;
+  mCycles = header.mCycles;
+  mCycle = 0;
+  mNextEvent = 0;
+  mPlayMode = static_cast<ServerPlayMode>(header.mPlayMode);
+  return true;
+}
+
+void MatchLogReader::GetShow(int cycle, MatchLogShow &show) const {
+  const int *values = &mColumns[0] + cycle;
+
+  show.mTime = values[0];
+  for (int i = 0; i < 4; ++i) {
+    show.mBall[i] = values[(BALL_COLUMN + i) * mCycles] * BALL_PREC;
+  }
+
+  for (int i = 0; i < PLAYERS; ++i) {
+    MatchLogShow::Player &p = show.mPlayers[i];
+    double *fields[PC_Max] = {0,           0,           &p.mPos[0],
+                              &p.mPos[1],  &p.mVel[0],  &p.mVel[1],
+                              &p.mBodyDir, &p.mNeckDir, &p.mViewAngle,
+                              &p.mStamina, &p.mEffort};
+
+    p.mType = values[PlayerColumnIndex(PC_Type, i) * mCycles];
+    p.mState = values[PlayerColumnIndex(PC_State, i) * mCycles];
+    for (int column = PC_PosX; column < PC_Max; ++column) {
+      *fields[column] = values[PlayerColumnIndex(column, i) * mCycles] *
+                        PLAYER_PREC[column];
+    }
+  }
+}
+
+/**
+ * 处理块内在第cycle个周期之前（含）的事件
+ */
+void MatchLogReader::ApplyEvents(int cycle) {
+  for (; mNextEvent < (int)mEvents.size() &&
+         mEvents[mNextEvent].mCycle <= cycle;
+       ++mNextEvent) {
+    if (mEvents[mNextEvent].mKind == EK_PlayMode) {
+      mPlayMode = static_cast<ServerPlayMode>(mEvents[mNextEvent].mValue[0]);
+    }
+  }
+}
+
+bool MatchLogReader::Seek(int time) {
+  if (!mpFile) {
+    return false;
+  }
+
+  // 第一个起始时间不小于time的块之前那块里可能就有
+  int block = std::lower_bound(mIndexTime.begin(), mIndexTime.end(), time) -
+              mIndexTime.begin();
+  block = std::max(block - 1, 0);
+
+  for (; block < GetBlockNum(); ++block) {
+    if (!LoadBlock(block)) {
+      return false;
+    }
+    for (int i = 0; i < mCycles; ++i) {
+      if (mColumns[i] >= time) {
+        mCycle = i;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool MatchLogReader::Next(MatchLogShow &show) {
+  if (!mpFile) {
+    return false;
+  }
+
+  while (mCycle >= mCycles) {
+    if (!LoadBlock(mBlock + 1)) {
+      return false;
+    }
+  }
+
+  ApplyEvents(mCycle);
+  GetShow(mCycle++, show);
+  return true;
+}
+
+void MatchLogReader::WriteEvent(std::ostream &os, const Event &event) {
+  const char *color =
+      SightLogger::ColorName(static_cast<SightLogger::Color>(event.mColor));
+
+  switch (event.mKind) {
+  case EK_PlayMode:
+    os << "(playmode " << event.mTime << ' '
+       << ServerPlayModeMap::instance().GetPlayModeString(
+              static_cast<ServerPlayMode>(event.mValue[0]))
+       << ")\n";
+    break;
+  case EK_Team:
+    os << "(team " << event.mTime << ' ' << event.mText[0] << ' '
+       << event.mText[1] << ' ' << event.mValue[0] << ' ' << event.mValue[1]
+       << ")\n";
+    break;
+  case EK_Point:
+    os << "(draw " << event.mTime << ' ' << "(point " << event.mCoord[0] << ' '
+       << event.mCoord[1] << ' ' << "\"" << color << "\" " << event.mText[0]
+       << ")" << ")\n";
+    break;
+  case EK_Line:
+    os << "(draw " << event.mTime << ' ' << "(line " << event.mCoord[0] << ' '
+       << event.mCoord[1] << ' ' << event.mCoord[2] << ' ' << event.mCoord[3]
+       << " \"" << color << "\")" << ")\n";
+    break;
+  case EK_Circle:
+    os << "(draw " << event.mTime << ' ' << "(circle " << event.mCoord[0]
+       << ' ' << event.mCoord[1] << ' ' << event.mCoord[2] << " \"" << color
+       << "\")" << ")\n";
+    break;
+  }
+}
+
+/**
+ * 按写入顺序输出文件头、事件和show，得到与文本sight_log相同的rcg
+ */
+bool MatchLogReader::ConvertToRcg(const char *rcg_file) {
+  if (!mpFile) {
+    return false;
+  }
+
+  std::ofstream os(rcg_file);
+  if (!os.good()) {
+    PRINT_ERROR("open rcg file error " << rcg_file);
+    return false;
+  }
+
+  os << mHeader;
+
+  MatchLogShow show;
+  for (int block = 0; block < GetBlockNum(); ++block) {
+    if (!LoadBlock(block)) {
+      return false;
+    }
+
+    unsigned event = 0;
+    for (int i = 0; i <= mCycles; ++i) {
+      for (; event < mEvents.size() && mEvents[event].mCycle <= i; ++event) {
+        WriteEvent(os, mEvents[event]);
+      }
+      if (i < mCycles) {
+        GetShow(i, show);
+        os << show << '\n';
+      }
+    }
+  }
+
+  mBlock = -1;
+  mCycles = 0;
+  mCycle = 0;
+  return os.good();
+}
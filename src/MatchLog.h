@@ -0,0 +1,186 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#ifndef __MatchLog_H__
+#define __MatchLog_H__
+
+#include "Types.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * 一个周期的show记录，数值与rcg中打印出来的一致（已量化）
+ */
+struct MatchLogShow {
+  struct Player {
+    int mType;
+    int mState; // 0x0 不在场，0x1 在场，0x9 守门员
+    double mPos[2];
+    double mVel[2];
+    double mBodyDir;
+    double mNeckDir;
+    double mViewAngle;
+    double mStamina;
+    double mEffort;
+  };
+
+  int mTime;
+  double mBall[4]; // x, y, vx, vy
+  Player mPlayers[TEAMSIZE * 2]; // 左方1~11，右方1~11
+
+  /** 输出rcg中的 (show ...)，不含换行 */
+  friend std::ostream &operator<<(std::ostream &os, const MatchLogShow &show);
+};
+
+/**
+ * 二进制分列格式的比赛记录，代替rcg文本的sight_log
+ * 文件由头部、数据块和末尾的索引组成。每块最多 BLOCK_CYCLES 个周期，块内按列存放：
+ * 先是所有周期的时间，再是球的各分量，再是22名球员的各个字段，每列存相邻周期的差分，
+ * 用zigzag变长整数编码，不变的量每周期只占1字节。playmode、team和draw作为事件
+ * 按写入顺序跟在列后面，记下它们在第几个周期之前。
+ * 索引是每块的起始时间和文件偏移，可以直接跳到任意周期；进程被杀没有写索引时，
+ * 读的时候顺序扫描各块重建
+ * Binary columnar match log: a header, blocks of up to BLOCK_CYCLES cycles
+ * stored column by column as zigzag varint deltas, interleaved events, and a
+ * trailing block index for random access by cycle.
+ */
+class MatchLogWriter {
+public:
+  MatchLogWriter();
+  ~MatchLogWriter();
+
+  bool Open(const char *file_name);
+  bool IsOpen() const { return mpFile != 0; }
+
+  /** 写入尚未写出的块和索引，关闭文件 */
+  void Close();
+
+  /** rcg文件头（ULG4和各种参数信息），在第一个块写出前设置 */
+  void SetHeader(const std::string &header) { mHeader = header; }
+
+  void AddShow(const MatchLogShow &show);
+  void AddPlayMode(int time, ServerPlayMode play_mode);
+  void AddTeam(int time, const std::string &left_name,
+               const std::string &right_name, int left_score,
+               int right_score);
+  void AddPoint(int time, int color, double x, double y,
+                const std::string &comment);
+  void AddLine(int time, int color, double x1, double y1, double x2,
+               double y2);
+  void AddCircle(int time, int color, double x, double y, double radius);
+
+private:
+  void AddEventHead(int kind, int time, int color);
+  void WriteBlock();
+
+private:
+  FILE *mpFile;
+  std::string mHeader;
+  bool mHeaderWritten;
+
+  ServerPlayMode mPlayMode; // 当前块开始时的playmode
+  ServerPlayMode mLastPlayMode;
+  int mLastTime;
+
+  std::vector<int> mRows; // 当前块按行存放的量化值
+  int mCycles;
+  std::string mEvents; // 当前块编码好的事件
+  int mEventCount;
+
+  std::vector<int> mIndexTime;
+  std::vector<long long> mIndexOffset;
+};
+
+/**
+ * 读二进制比赛记录，可按时间定位，也可整个转成rcg文本
+ */
+class MatchLogReader {
+public:
+  MatchLogReader();
+  ~MatchLogReader();
+
+  /** 文件是否以二进制比赛记录的标识开头 */
+  static bool IsMatchLog(const char *file_name);
+
+  bool Open(const char *file_name);
+  void Close();
+
+  const std::string &GetHeader() const { return mHeader; }
+  int GetBlockNum() const { return mIndexTime.size(); }
+
+  /** 定位到第一个时间不小于time的周期，之后由Next读出 */
+  bool Seek(int time);
+
+  /** 读出下一个周期，没有了返回false */
+  bool Next(MatchLogShow &show);
+
+  /** 最近一次Next读出的周期所处的playmode */
+  ServerPlayMode GetPlayMode() const { return mPlayMode; }
+
+  /** 整个转成rcg文本，与文本格式的sight_log相同 */
+  bool ConvertToRcg(const char *rcg_file);
+
+private:
+  struct Event {
+    int mCycle; // 在块内第几个周期之前
+    int mKind;
+    int mTime;
+    int mColor;
+    int mValue[3];
+    double mCoord[4];
+    std::string mText[2];
+  };
+
+  bool BuildIndex();
+  bool LoadBlock(int block);
+  void GetShow(int cycle, MatchLogShow &show) const;
+  void ApplyEvents(int cycle);
+  static void WriteEvent(std::ostream &os, const Event &event);
+
+private:
+  FILE *mpFile;
+  std::string mHeader;
+
+  std::vector<int> mIndexTime;
+  std::vector<long long> mIndexOffset;
+
+  int mBlock;  // 已载入的块
+  int mCycles; // 块内周期数
+  int mCycle;  // 下一个要读的周期
+  std::vector<int> mColumns; // 按列存放的量化值
+  std::vector<Event> mEvents;
+  int mNextEvent;
+  ServerPlayMode mPlayMode;
+};
+
+#endif
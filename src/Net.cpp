@@ -32,41 +32,41 @@
 #include "Net.h"
 #include "Types.h"
 #include "Utilities.h"
+#include "Thread.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <math.h>
+#ifdef WIN32
+#include <malloc.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-#define BINARY
+namespace {
+const char PATTERN_MAGIC[4] = {'W', 'E', 'N', 'P'};
+const int PATTERN_VERSION = 1;
 
-#define SCAN_PARAMS(p, i, d)                                                   \
-  if (fscanf(fp, "%d %d %d", &p, &i, &d) < 1) {                                \
-    Assert(0);                                                                 \
-  }
-#define SCAN_TRAIN(patterns, input_size, desire_size, input, desire)           \
-  for (int i = 0; i < patterns; ++i) {                                         \
-    for (int j = 0; j < input_size; ++j) {                                     \
-      if (fscanf(fp, "%lf", &input[i][j]) < 1) {                               \
-        Assert(0);                                                             \
-      }                                                                        \
-    }                                                                          \
-    for (int j = 0; j < desire_size; ++j) {                                    \
-      if (fscanf(fp, "%lf", &desire[i][j]) < 1) {                              \
-        Assert(0);                                                             \
-      }                                                                        \
-    }                                                                          \
-  }
+/** 每个梯度块的样本数，块内按顺序累加，块之间按编号归约，结果与线程数无关 */
+const int PATTERN_CHUNK = 16;
+} // namespace
 
 Net::Net(int layers, int *units) {
   mUnits = 0;
   mLogName = 0;
+  SetTrainDefaultValue();
   Construct(layers, units);
 }
 
 Net::Net(const char *fname) {
   mUnits = 0;
   mLogName = 0;
+  SetTrainDefaultValue();
   Construct(fname);
 }
 
@@ -87,20 +87,48 @@ void Net::Construct(int layers, int *units) {
   SetDefaultValue();
 }
 
+real *Net::AlignedAlloc(int size) {
+  const size_t bytes = (size_t)size * sizeof(real);
+#ifdef WIN32
+  return (real *)_aligned_malloc(bytes, ALIGN_UNITS * sizeof(real));
+#else
+  void *p = 0;
+  if (posix_memalign(&p, ALIGN_UNITS * sizeof(real), bytes) != 0) {
+    perror("Net::AlignedAlloc");
+    exit(1);
+  }
+  return (real *)p;
+#endif
+}
+
+void Net::AlignedFree(real *p) {
+#ifdef WIN32
+  _aligned_free(p);
+#else
+  free(p);
+#endif
+}
+
 void Net::Memaloc() {
-  mWeight = new real **[mLayers];
-  mDeltaWeight = new real **[mLayers];
+  mStride = new int[mLayers];
+  mWeight = new real *[mLayers];
+  mDeltaWeight = new real *[mLayers];
   for (int i = 1; i < mLayers; ++i) {
-    mWeight[i] = new real *[mUnits[i]];
-    mDeltaWeight[i] = new real *[mUnits[i]];
-    for (int j = 0; j < mUnits[i]; ++j) {
-      mWeight[i][j] = new real[mUnits[i - 1] + 1];      // one bias
-      mDeltaWeight[i][j] = new real[mUnits[i - 1] + 1]; // one bias
-    }
+    // one bias
+    mStride[i] = (mUnits[i - 1] + 1 + ALIGN_UNITS - 1) / ALIGN_UNITS *
+                 ALIGN_UNITS;
+    mWeight[i] = AlignedAlloc(mUnits[i] * mStride[i]);
+    mDeltaWeight[i] = AlignedAlloc(mUnits[i] * mStride[i]);
+    memset(mWeight[i], 0, mUnits[i] * mStride[i] * sizeof(real));
+    memset(mDeltaWeight[i], 0, mUnits[i] * mStride[i] * sizeof(real));
   }
 
   mOutput = new real *[mLayers];
   mDelta = new real *[mLayers];
+  mBatchOutput = new real *[mLayers];
+  for (int i = 0; i < mLayers; ++i) {
+    mBatchOutput[i] = AlignedAlloc(mUnits[i] * BATCH_SIZE);
+  }
   for (int i = 1; i < mLayers; ++i) {
     mOutput[i] = new real[mUnits[i]];
     mDelta[i] = new real[mUnits[i]];
@@ -111,8 +139,8 @@ void Net::InitWeight() {
   for (int i = 1; i < mLayers; ++i) {
     for (int j = 0; j < mUnits[i]; ++j) {
       for (int k = 0; k < mUnits[i - 1] + 1; ++k) {
-        mWeight[i][j][k] = small_rand();
-        mDeltaWeight[i][j][k] = 0.0;
+        Weight(i, j)[k] = small_rand();
+        DeltaWeight(i, j)[k] = 0.0;
       }
     }
   }
@@ -122,15 +150,17 @@ void Net::Destroy() {
   if (mUnits == 0)
     return;
   for (int i = 1; i < mLayers; ++i) {
-    for (int j = 0; j < mUnits[i]; ++j) {
-      delete[] mWeight[i][j];
-      delete[] mDeltaWeight[i][j];
-    }
-    delete[] mWeight[i];
-    delete[] mDeltaWeight[i];
+    AlignedFree(mWeight[i]);
+    AlignedFree(mDeltaWeight[i]);
   }
   delete[] mWeight;
   delete[] mDeltaWeight;
+  delete[] mStride;
+
+  for (int i = 0; i < mLayers; ++i) {
+    AlignedFree(mBatchOutput[i]);
+  }
+  delete[] mBatchOutput;
 
   for (int i = 1; i < mLayers; ++i) {
     delete[] mOutput[i];
@@ -144,101 +174,170 @@ void Net::Destroy() {
     delete[] mLogName;
 }
 
-void Net::Save(const char *fname) {
+/**
+ * 二进制格式：mLayers, mUnits[], mEta, mAlpha，然后逐层逐单元的权值（含偏置），
+ * 实数一律存为 double；文本格式以 "#mLayers" 开头
+ */
+void Net::Save(const char *fname, bool binary) {
   if (mUnits == 0)
     return;
   FILE *fp;
-  if ((fp = fopen(fname, "w")) == 0) {
+  if ((fp = fopen(fname, binary ? "wb" : "w")) == 0) {
     perror("BPN::Save(char *fname)");
     exit(1);
   }
-#ifdef BINARY
-  fwrite(&mLayers, sizeof(mLayers), 1, fp);
-  fwrite(mUnits, sizeof(*mUnits), mLayers, fp);
-  fwrite(&mEta, sizeof(mEta), 1, fp);
-  fwrite(&mAlpha, sizeof(mAlpha), 1, fp);
-  for (int i = 1; i < mLayers; ++i) {
-    for (int j = 0; j < mUnits[i]; ++j) {
-      fwrite(mWeight[i][j], sizeof(*mWeight[i][j]), mUnits[i - 1] + 1, fp);
+  if (binary) {
+    double value;
+    fwrite(&mLayers, sizeof(mLayers), 1, fp);
+    fwrite(mUnits, sizeof(*mUnits), mLayers, fp);
+    value = mEta;
+    fwrite(&value, sizeof(value), 1, fp);
+    value = mAlpha;
+    fwrite(&value, sizeof(value), 1, fp);
+    for (int i = 1; i < mLayers; ++i) {
+      for (int j = 0; j < mUnits[i]; ++j) {
+        for (int k = 0; k < mUnits[i - 1] + 1; ++k) {
+          value = Weight(i, j)[k];
+          fwrite(&value, sizeof(value), 1, fp);
+        }
+      }
     }
-  }
-#else
-  fprintf(fp, "#mLayers\n%d\n#mUnits\n", mLayers);
-  for (int i = 0; i < mLayers; ++i) {
-    fprintf(fp, "%d ", mUnits[i]);
-  }
-  fprintf(fp, "\n#mEta\n%lf\n#mAlpha\n%lf\n#mWeight\n", mEta, mAlpha);
-  for (int i = 1; i < mLayers; ++i) {
-    fprintf(fp, "#Layer %d\n", i);
-    for (int j = 0; j < mUnits[i]; ++j) {
-      for (int k = 0; k < mUnits[i - 1] + 1; ++k) {
-        fprintf(fp, "%lf ", mWeight[i][j][k]);
+  } else {
+    fprintf(fp, "#mLayers\n%d\n#mUnits\n", mLayers);
+    for (int i = 0; i < mLayers; ++i) {
+      fprintf(fp, "%d ", mUnits[i]);
+    }
+    fprintf(fp, "\n#mEta\n%lf\n#mAlpha\n%lf\n#mWeight\n", (double)mEta,
+            (double)mAlpha);
+    for (int i = 1; i < mLayers; ++i) {
+      fprintf(fp, "#Layer %d\n", i);
+      for (int j = 0; j < mUnits[i]; ++j) {
+        for (int k = 0; k < mUnits[i - 1] + 1; ++k) {
+          fprintf(fp, "%.17g ", (double)Weight(i, j)[k]);
+        }
+        fprintf(fp, "\n");
       }
       fprintf(fp, "\n");
     }
-    fprintf(fp, "\n");
   }
-#endif
   fclose(fp);
 }
 
 void Net::Construct(const char *fname) {
   FILE *fp;
-  if ((fp = fopen(fname, "r")) == 0) {
+  if ((fp = fopen(fname, "rb")) == 0) {
     perror("BPN::Construct(char *fname)");
     exit(1);
   }
-#ifdef BINARY
-  if (fread(&mLayers, sizeof(mLayers), 1, fp) < 1) {
-    Assert(0);
-  }
-  mUnits = new int[mLayers];
-  if (fread(mUnits, sizeof(*mUnits), mLayers, fp) < 1) {
-    Assert(0);
-  }
-  if (fread(&mEta, sizeof(mEta), 1, fp) < 1) {
-    Assert(0);
-  }
-  if (fread(&mAlpha, sizeof(mAlpha), 1, fp) < 1) {
-    Assert(0);
-  }
-  Memaloc();
-  InitWeight();
 
-  for (int i = 1; i < mLayers; ++i) {
-    for (int j = 0; j < mUnits[i]; ++j) {
-      if (fread(mWeight[i][j], sizeof(*mWeight[i][j]), mUnits[i - 1] + 1, fp) <
-          1) {
+  const int first = fgetc(fp);
+  ungetc(first, fp);
+
+  double value;
+  if (first != '#') { // binary
+    if (fread(&mLayers, sizeof(mLayers), 1, fp) < 1) {
+      Assert(0);
+    }
+    mUnits = new int[mLayers];
+    if (fread(mUnits, sizeof(*mUnits), mLayers, fp) < 1) {
+      Assert(0);
+    }
+    if (fread(&value, sizeof(value), 1, fp) < 1) {
+      Assert(0);
+    }
+    mEta = value;
+    if (fread(&value, sizeof(value), 1, fp) < 1) {
+      Assert(0);
+    }
+    mAlpha = value;
+    Memaloc();
+    InitWeight();
+
+    for (int i = 1; i < mLayers; ++i) {
+      for (int j = 0; j < mUnits[i]; ++j) {
+        for (int k = 0; k < mUnits[i - 1] + 1; ++k) {
+          if (fread(&value, sizeof(value), 1, fp) < 1) {
+            Assert(0);
+          }
+          Weight(i, j)[k] = value;
+        }
+      }
+    }
+  } else {
+    double eta, alpha;
+    if (fscanf(fp, "#mLayers\n%d\n#mUnits\n", &mLayers) < 1) {
+      Assert(0);
+    }
+    mUnits = new int[mLayers];
+    for (int i = 0; i < mLayers; ++i) {
+      if (fscanf(fp, "%d ", &mUnits[i]) < 1) {
         Assert(0);
       }
     }
-  }
-#else
-  fscanf(fp, "#mLayers\n%d\n#mUnits\n", &mLayers);
-  mUnits = new int[mLayers];
-  for (int i = 0; i < mLayers; ++i) {
-    fscanf(fp, "%d ", &mUnits[i]);
-  }
-  fscanf(fp, "\n#mEta\n%lf\n#mAlpha\n%lf\n#mWeight\n", &mEta, &mAlpha);
-  int tmp;
-  Memaloc();
-  InitWeight();
-
-  for (int i = 1; i < mLayers; ++i) {
-    fscanf(fp, "#Layer %d\n", &tmp);
-    for (int j = 0; j < mUnits[i]; ++j) {
-      for (int k = 0; k < mUnits[i - 1] + 1; ++k) {
-        fscanf(fp, "%lf ", &mWeight[i][j][k]);
+    if (fscanf(fp, "\n#mEta\n%lf\n#mAlpha\n%lf\n#mWeight\n", &eta, &alpha) <
+        2) {
+      Assert(0);
+    }
+    mEta = eta;
+    mAlpha = alpha;
+    int tmp;
+    Memaloc();
+    InitWeight();
+
+    for (int i = 1; i < mLayers; ++i) {
+      if (fscanf(fp, "#Layer %d\n", &tmp) < 1) {
+        Assert(0);
+      }
+      for (int j = 0; j < mUnits[i]; ++j) {
+        for (int k = 0; k < mUnits[i - 1] + 1; ++k) {
+          if (fscanf(fp, "%lf ", &value) < 1) {
+            Assert(0);
+          }
+          Weight(i, j)[k] = value;
+        }
+        fscanf(fp, "\n");
       }
       fscanf(fp, "\n");
     }
-    fscanf(fp, "\n");
   }
-#endif
   fclose(fp);
 }
 
+#ifdef NET_FAST_SIGMOID
+namespace {
+/**
+ * exp 的近似：x = (n + f) ln2，|f| <= 0.5，2**f 用7阶泰勒展开，相对误差约 1e-7，
+ * 不调用 libm，循环可以向量化
+ */
+inline real FastExp(real x) {
+  static const double LOG2E = 1.4426950408889634;
+  static const double LN2 = 0.6931471805599453;
+
+  double t = x * LOG2E;
+  t = t < -1000.0 ? -1000.0 : (t > 1000.0 ? 1000.0 : t);
+  const double n = floor(t + 0.5);
+  const double f = (t - n) * LN2;
+  const double p =
+      1.0 +
+      f * (1.0 +
+           f * (1.0 / 2 +
+                f * (1.0 / 6 +
+                     f * (1.0 / 24 +
+                          f * (1.0 / 120 + f * (1.0 / 720 + f / 5040.0))))));
+
+  union {
+    double d;
+    long long i;
+  } scale;
+  scale.i = (long long)(n + 1023.0) << 52;
+  return p * scale.d;
+}
+} // namespace
+
+inline real Net::sigmoid(real s) { return 1.0 / (1.0 + FastExp(-s)); }
+#else
 inline real Net::sigmoid(real s) { return 1.0 / (1.0 + exp(-s)); }
+#endif
 
 inline real Net::small_rand() //[-1.0, 1.0]
 {
@@ -248,15 +347,44 @@ inline real Net::small_rand() //[-1.0, 1.0]
 inline void Net::FeedForward() {
   for (int i = 1; i < mLayers; ++i) {
     for (int j = 0; j < mUnits[i]; ++j) {
-      mOutput[i][j] = mWeight[i][j][mUnits[i - 1]]; // bias
+      const real *w = Weight(i, j);
+      mOutput[i][j] = w[mUnits[i - 1]]; // bias
       for (int k = 0; k < mUnits[i - 1]; ++k) {
-        mOutput[i][j] += mOutput[i - 1][k] * mWeight[i][j][k];
+        mOutput[i][j] += mOutput[i - 1][k] * w[k];
       }
       mOutput[i][j] = sigmoid(mOutput[i][j]);
     }
   }
 }
 
+/**
+ * 批量前向计算，输出按 [单元][样本] 存放，最内层循环沿样本方向，
+ * 累加的顺序与 FeedForward 相同，编译器可以直接向量化
+ */
+inline void Net::BatchFeedForward(int size) {
+  for (int i = 1; i < mLayers; ++i) {
+    for (int j = 0; j < mUnits[i]; ++j) {
+      const real *w = Weight(i, j);
+      real *out = mBatchOutput[i] + j * BATCH_SIZE;
+
+      const real bias = w[mUnits[i - 1]];
+      for (int n = 0; n < size; ++n) {
+        out[n] = bias;
+      }
+      for (int k = 0; k < mUnits[i - 1]; ++k) {
+        const real *in = mBatchOutput[i - 1] + k * BATCH_SIZE;
+        const real weight = w[k];
+        for (int n = 0; n < size; ++n) {
+          out[n] += in[n] * weight;
+        }
+      }
+      for (int n = 0; n < size; ++n) {
+        out[n] = sigmoid(out[n]);
+      }
+    }
+  }
+}
+
 inline void Net::BackProp() {
   for (int i = 0; i < mUnits[mLayers - 1]; ++i) {
     mDelta[mLayers - 1][i] = (mDesire[i] - mOutput[mLayers - 1][i]) *
@@ -268,7 +396,7 @@ inline void Net::BackProp() {
     for (int j = 0; j < mUnits[i]; ++j) {
       mDelta[i][j] = 0.0;
       for (int k = 0; k < mUnits[i + 1]; ++k) {
-        mDelta[i][j] += mDelta[i + 1][k] * mWeight[i + 1][k][j];
+        mDelta[i][j] += mDelta[i + 1][k] * Weight(i + 1, k)[j];
       }
       mDelta[i][j] *= mOutput[i][j] * (1.0 - mOutput[i][j]);
     }
@@ -278,14 +406,14 @@ inline void Net::BackProp() {
 inline void Net::UpdateWeight() {
   for (int i = 1; i < mLayers; ++i) {
     for (int j = 0; j < mUnits[i]; ++j) {
+      real *w = Weight(i, j);
+      real *dw = DeltaWeight(i, j);
       for (int k = 0; k < mUnits[i - 1]; ++k) {
-        mDeltaWeight[i][j][k] = mEta * mDelta[i][j] * mOutput[i - 1][k] +
-                                mAlpha * mDeltaWeight[i][j][k];
-        mWeight[i][j][k] += mDeltaWeight[i][j][k];
+        dw[k] = mEta * mDelta[i][j] * mOutput[i - 1][k] + mAlpha * dw[k];
+        w[k] += dw[k];
       }
-      mDeltaWeight[i][j][mUnits[i - 1]] =
-          mEta * mDelta[i][j] + mAlpha * mDeltaWeight[i][j][mUnits[i - 1]];
-      mWeight[i][j][mUnits[i - 1]] += mDeltaWeight[i][j][mUnits[i - 1]];
+      dw[mUnits[i - 1]] = mEta * mDelta[i][j] + mAlpha * dw[mUnits[i - 1]];
+      w[mUnits[i - 1]] += dw[mUnits[i - 1]];
     }
   }
 }
@@ -307,6 +435,23 @@ void Net::SetLogName(const char *s) {
 
 void Net::SetMaxEpochs(int m) { mMaxEpochs = m; }
 
+void Net::SetBatchSize(int n) { mBatchSize = n; }
+
+void Net::SetThreads(int n) { mThreads = n; }
+
+void Net::SetValidation(real ratio, int patience) {
+  mValidationRatio = ratio;
+  mPatience = patience;
+}
+
+void Net::SetTrainDefaultValue() {
+  SetDesiredError(0.01);
+  SetMaxEpochs(1000);
+  SetBatchSize(0);
+  SetThreads(0);
+  SetValidation(0.0, 0);
+}
+
 void Net::SetDefaultValue() {
   SetLearningRate(0.7);
   SetAlpha(0.0);
@@ -327,6 +472,29 @@ void Net::Run(real *input, real *output) {
   }
 }
 
+void Net::Run(int size, real *const *input, real *const *output) {
+  if (mUnits == 0)
+    return;
+  for (int begin = 0; begin < size; begin += BATCH_SIZE) {
+    const int n = Min(size - begin, (int)BATCH_SIZE);
+
+    for (int k = 0; k < mUnits[0]; ++k) {
+      for (int p = 0; p < n; ++p) {
+        mBatchOutput[0][k * BATCH_SIZE + p] = input[begin + p][k];
+      }
+    }
+
+    BatchFeedForward(n);
+
+    const real *out = mBatchOutput[mLayers - 1];
+    for (int j = 0; j < mUnits[mLayers - 1]; ++j) {
+      for (int p = 0; p < n; ++p) {
+        output[begin + p][j] = out[j * BATCH_SIZE + p];
+      }
+    }
+  }
+}
+
 real Net::Error() {
   real error = 0.0;
   for (int i = 0; i < mUnits[mLayers - 1]; ++i) {
@@ -348,31 +516,157 @@ real Net::Train(real *input, real *desire) {
   return Error();
 }
 
-void Net::TrainOnFile(const char *fname) {
-  if (mUnits == 0)
-    return;
+/**
+ * 训练样本。二进制文件直接映射，文本文件读入内存（第一行为样本数、输入维数、输出维数）
+ */
+struct Net::PatternSet {
+  PatternSet()
+      : mPatterns(0), mInputSize(0), mDesireSize(0), mData(0), mMap(0),
+        mMapSize(0) {}
+  ~PatternSet() {
+#ifndef WIN32
+    if (mMap != 0) {
+      munmap(mMap, mMapSize);
+    }
+#endif
+  }
+
+  const double *Input(int p) const {
+    return mData + (size_t)p * (mInputSize + mDesireSize);
+  }
+  const double *Desire(int p) const { return Input(p) + mInputSize; }
+
+  int mPatterns;
+  int mInputSize;
+  int mDesireSize;
+  const double *mData;
+  std::vector<double> mBuffer;
+  void *mMap;
+  size_t mMapSize;
+};
+
+bool Net::LoadPatterns(const char *fname, PatternSet &set) {
   FILE *fp;
-  if ((fp = fopen(fname, "r")) == 0) {
-    perror("BPN::TrainOnFile(char *fname)");
-    exit(1);
+  if ((fp = fopen(fname, "rb")) == 0) {
+    perror("BPN::LoadPatterns(char *fname)");
+    return false;
   }
-  int patterns;
-  int input_size;
-  int desire_size;
-  real **input;
-  real **desire;
 
-  SCAN_PARAMS(patterns, input_size, desire_size)
+  PatternHeader header;
+  if (fread(&header, sizeof(header), 1, fp) == 1 &&
+      memcmp(header.mMagic, PATTERN_MAGIC, 4) == 0) {
+    fclose(fp);
+    if (header.mVersion != PATTERN_VERSION) {
+      return false;
+    }
+    set.mPatterns = header.mPatterns;
+    set.mInputSize = header.mInputSize;
+    set.mDesireSize = header.mDesireSize;
+    const size_t count =
+        (size_t)set.mPatterns * (set.mInputSize + set.mDesireSize);
+
+#ifndef WIN32
+    int fd = open(fname, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    set.mMapSize = sizeof(header) + count * sizeof(double);
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size == set.mMapSize) {
+      set.mMap = mmap(0, set.mMapSize, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (set.mMap == 0 || set.mMap == MAP_FAILED) {
+      set.mMap = 0;
+      return false;
+    }
+    set.mData = (const double *)((const char *)set.mMap + sizeof(header));
+#else
+    set.mBuffer.resize(count);
+    fp = fopen(fname, "rb");
+    fseek(fp, sizeof(header), SEEK_SET);
+    bool ok = fread(&set.mBuffer[0], sizeof(double), count, fp) == count;
+    fclose(fp);
+    if (!ok) {
+      return false;
+    }
+    set.mData = &set.mBuffer[0];
+#endif
+    return true;
+  }
 
-  input = new real *[patterns];
-  desire = new real *[patterns];
-  for (int i = 0; i < patterns; ++i) {
-    input[i] = new real[input_size];
-    desire[i] = new real[desire_size];
+  rewind(fp);
+  if (fscanf(fp, "%d %d %d", &set.mPatterns, &set.mInputSize,
+             &set.mDesireSize) < 3) {
+    fclose(fp);
+    return false;
+  }
+  set.mBuffer.resize((size_t)set.mPatterns *
+                     (set.mInputSize + set.mDesireSize));
+  for (size_t i = 0; i < set.mBuffer.size(); ++i) {
+    if (fscanf(fp, "%lf", &set.mBuffer[i]) < 1) {
+      fclose(fp);
+      return false;
+    }
   }
+  fclose(fp);
+  set.mData = set.mBuffer.empty() ? 0 : &set.mBuffer[0];
+  return true;
+}
+
+/**
+ * 把文本样本文件转成可以直接映射的二进制格式
+ */
+bool Net::ConvertTrainFile(const char *text_file, const char *binary_file) {
+  PatternSet set;
+  if (!LoadPatterns(text_file, set)) {
+    return false;
+  }
+
+  PatternHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.mMagic, PATTERN_MAGIC, 4);
+  header.mVersion = PATTERN_VERSION;
+  header.mPatterns = set.mPatterns;
+  header.mInputSize = set.mInputSize;
+  header.mDesireSize = set.mDesireSize;
 
-  SCAN_TRAIN(patterns, input_size, desire_size, input, desire)
+  FILE *fp;
+  if ((fp = fopen(binary_file, "wb")) == 0) {
+    perror("BPN::ConvertTrainFile(char *binary_file)");
+    return false;
+  }
+  const size_t count =
+      (size_t)set.mPatterns * (set.mInputSize + set.mDesireSize);
+  bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+            fwrite(set.mData, sizeof(double), count, fp) == count;
+  fclose(fp);
+  return ok;
+}
 
+bool Net::TrainOnFile(const char *fname) {
+  if (mUnits == 0)
+    return false;
+
+  PatternSet set;
+  if (!LoadPatterns(fname, set) || set.mInputSize != mUnits[0] ||
+      set.mDesireSize != mUnits[mLayers - 1]) {
+    fprintf(stderr, "BPN::TrainOnFile: bad pattern file %s\n", fname);
+    return false;
+  }
+
+  if (mBatchSize > 0) {
+    TrainMiniBatch(set);
+  } else {
+    TrainOnline(set);
+  }
+  return true;
+}
+
+/**
+ * 逐个样本在线训练
+ */
+void Net::TrainOnline(const PatternSet &set) {
   FILE *log_file = 0;
   if (mLogName != 0) {
     log_file = fopen(mLogName, "w");
@@ -382,12 +676,17 @@ void Net::TrainOnFile(const char *fname) {
     }
   }
 
+  std::vector<real> input(set.mInputSize), desire(set.mDesireSize);
+
   int epochs = 0;
   while (epochs <= mMaxEpochs) {
     ++epochs;
     real error = 0.0;
-    for (int p = 0; p < patterns; ++p) {
-      error += Train(input[p], desire[p]);
+    for (int p = 0; p < set.mPatterns; ++p) {
+      std::copy(set.Input(p), set.Input(p) + set.mInputSize, input.begin());
+      std::copy(set.Desire(p), set.Desire(p) + set.mDesireSize,
+                desire.begin());
+      error += Train(&input[0], &desire[0]);
     }
     if (mLogName) {
       fprintf(log_file, "%d %f\n", epochs, error);
@@ -399,54 +698,316 @@ void Net::TrainOnFile(const char *fname) {
   if (mLogName != 0) {
     fclose(log_file);
   }
+}
 
-  fclose(fp);
-  for (int i = 0; i < patterns; ++i) {
-    delete[] input[i];
-    delete[] desire[i];
+/**
+ * 一个小批量的梯度计算任务，按 PATTERN_CHUNK 分块，每块有自己的梯度缓存
+ */
+struct Net::TrainTask {
+  const PatternSet *mSet;
+  const int *mIndex; /// 本批样本的编号
+  int mSize;
+  int mChunks;
+  int mThreads;
+  int mWeightSize;                           /// 所有层权值的总数
+  std::vector<int> mWeightOffset;            /// 每层权值在梯度缓存中的偏移
+  std::vector<std::vector<real> > mGradient; /// 每块的梯度
+  std::vector<real> mError;                  /// 每块的误差平方和
+  ThreadSemaphore mDone;                     /// 工作线程每算完一批发一次
+  bool mQuit;
+};
+
+/**
+ * 计算梯度的工作线程，整个训练过程中一直存在，每个小批量由 mStart 唤醒一次
+ */
+class Net::TrainWorker : public Thread {
+public:
+  TrainWorker(Net &net, TrainTask &task, int first)
+      : mNet(net), mTask(task), mFirst(first) {}
+  virtual ~TrainWorker() {}
+
+  void Run() {
+    for (int c = mFirst; c < mTask.mChunks; c += mTask.mThreads) {
+      mNet.ComputeGradient(mTask, c);
+    }
+  }
+
+  ThreadSemaphore mStart;
+
+private:
+  void StartRoutine() {
+    for (;;) {
+      mStart.Wait();
+      if (mTask.mQuit) {
+        break;
+      }
+      Run();
+      mTask.mDone.Post();
+    }
+  }
+
+  Net &mNet;
+  TrainTask &mTask;
+  int mFirst;
+};
+
+/**
+ * 计算一块样本的梯度（已乘上误差方向，直接加到权值上即为下降方向）
+ */
+void Net::ComputeGradient(TrainTask &task, int chunk) {
+  std::vector<real> &gradient = task.mGradient[chunk];
+  std::fill(gradient.begin(), gradient.end(), real(0.0));
+
+  std::vector<real *> output(mLayers), delta(mLayers);
+  std::vector<real> buffer;
+  int units = 0;
+  for (int i = 0; i < mLayers; ++i) {
+    units += mUnits[i];
+  }
+  buffer.resize(2 * units);
+  for (int i = 0, offset = 0; i < mLayers; ++i) {
+    output[i] = &buffer[offset];
+    delta[i] = &buffer[units + offset];
+    offset += mUnits[i];
   }
-  delete[] input;
-  delete[] desire;
+
+  real error = 0.0;
+  const int end = Min(task.mSize, (chunk + 1) * PATTERN_CHUNK);
+  for (int n = chunk * PATTERN_CHUNK; n < end; ++n) {
+    const int p = task.mIndex[n];
+    const double *input = task.mSet->Input(p);
+    const double *desire = task.mSet->Desire(p);
+
+    for (int k = 0; k < mUnits[0]; ++k) {
+      output[0][k] = input[k];
+    }
+    for (int i = 1; i < mLayers; ++i) {
+      for (int j = 0; j < mUnits[i]; ++j) {
+        const real *w = Weight(i, j);
+        real sum = w[mUnits[i - 1]]; // bias
+        for (int k = 0; k < mUnits[i - 1]; ++k) {
+          sum += output[i - 1][k] * w[k];
+        }
+        output[i][j] = sigmoid(sum);
+      }
+    }
+
+    const int last = mLayers - 1;
+    for (int j = 0; j < mUnits[last]; ++j) {
+      const real diff = desire[j] - output[last][j];
+      error += diff * diff;
+      delta[last][j] = diff * output[last][j] * (1.0 - output[last][j]);
+    }
+    for (int i = last - 1; i >= 1; --i) {
+      for (int j = 0; j < mUnits[i]; ++j) {
+        real sum = 0.0;
+        for (int k = 0; k < mUnits[i + 1]; ++k) {
+          sum += delta[i + 1][k] * Weight(i + 1, k)[j];
+        }
+        delta[i][j] = sum * output[i][j] * (1.0 - output[i][j]);
+      }
+    }
+
+    for (int i = 1; i < mLayers; ++i) {
+      for (int j = 0; j < mUnits[i]; ++j) {
+        real *g = &gradient[task.mWeightOffset[i] + j * mStride[i]];
+        for (int k = 0; k < mUnits[i - 1]; ++k) {
+          g[k] += delta[i][j] * output[i - 1][k];
+        }
+        g[mUnits[i - 1]] += delta[i][j];
+      }
+    }
+  }
+  task.mError[chunk] = error;
 }
 
-real Net::TestOnFile(const char *fname) {
-  if (mUnits == 0)
-    return -1.0;
-  FILE *fp;
-  if ((fp = fopen(fname, "r")) == 0) {
-    perror("BPN::TrainOnFile(char *fname)");
-    exit(1);
+real Net::ValidationError(const PatternSet &set,
+                          const std::vector<int> &index) {
+  std::vector<real> input(set.mInputSize), output(set.mDesireSize);
+  real error = 0.0;
+  for (size_t n = 0; n < index.size(); ++n) {
+    const int p = index[n];
+    std::copy(set.Input(p), set.Input(p) + set.mInputSize, input.begin());
+    Run(&input[0], &output[0]);
+    for (int j = 0; j < set.mDesireSize; ++j) {
+      const real diff = set.Desire(p)[j] - output[j];
+      error += diff * diff;
+    }
+  }
+  return error;
+}
+
+/**
+ * 小批量训练：每批的梯度按块分给多个线程计算，再按块的编号依次归约，
+ * 所以结果与线程数无关。留出验证集时，验证误差连续 mPatience 轮没有
+ * 下降就停止，并恢复到验证误差最小时的权值
+ */
+void Net::TrainMiniBatch(const PatternSet &set) {
+  FILE *log_file = 0;
+  if (mLogName != 0) {
+    log_file = fopen(mLogName, "w");
+    if (log_file == 0) {
+      perror("fopen(mLogName)");
+      exit(1);
+    }
   }
-  int patterns;
-  int input_size;
-  int desire_size;
-  real **input;
-  real **desire;
 
-  SCAN_PARAMS(patterns, input_size, desire_size)
+  //每隔 1 / mValidationRatio 个样本取一个作为验证集，样本文件通常是有序的
+  std::vector<int> train, validation;
+  const int stride =
+      mValidationRatio > 0.0 ? Max(2, (int)(1.0 / mValidationRatio + 0.5)) : 0;
+  for (int p = 0; p < set.mPatterns; ++p) {
+    if (stride > 0 && p % stride == stride - 1) {
+      validation.push_back(p);
+    } else {
+      train.push_back(p);
+    }
+  }
 
-  input = new real *[patterns];
-  desire = new real *[patterns];
-  for (int i = 0; i < patterns; ++i) {
-    input[i] = new real[input_size];
-    desire[i] = new real[desire_size];
+  TrainTask task;
+  task.mSet = &set;
+  task.mWeightSize = 0;
+  task.mWeightOffset.resize(mLayers, 0);
+  for (int i = 1; i < mLayers; ++i) {
+    task.mWeightOffset[i] = task.mWeightSize;
+    task.mWeightSize += mUnits[i] * mStride[i];
   }
 
-  SCAN_TRAIN(patterns, input_size, desire_size, input, desire)
+  int threads = mThreads;
+#ifndef WIN32
+  if (threads <= 0) {
+    threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+#endif
+  threads = Max(1, threads);
 
+  const int batch_size = Min(mBatchSize, (int)train.size());
+  const int max_chunks = (batch_size + PATTERN_CHUNK - 1) / PATTERN_CHUNK;
+  task.mGradient.resize(max_chunks, std::vector<real>(task.mWeightSize));
+  task.mError.resize(max_chunks);
+  std::vector<real> gradient(task.mWeightSize);
+
+  task.mQuit = false;
+  std::vector<TrainWorker *> workers;
+  for (int t = 1; t < Min(threads, max_chunks); ++t) {
+    workers.push_back(new TrainWorker(*this, task, t));
+    workers.back()->Start();
+  }
+
+  std::vector<real> best_weight;
+  real best_error = 0.0;
+  int best_epoch = 0;
+
+  RealTime start_time = GetRealTime();
   real error = 0.0;
-  for (int p = 0; p < patterns; ++p) {
-    SetDesire(desire[p]);
-    Run(input[p], 0);
-    error += Error();
+  int epochs = 0;
+  while (epochs < mMaxEpochs) {
+    ++epochs;
+    error = 0.0;
+    for (int begin = 0; begin < (int)train.size(); begin += batch_size) {
+      task.mIndex = &train[begin];
+      task.mSize = Min(batch_size, (int)train.size() - begin);
+      task.mChunks = (task.mSize + PATTERN_CHUNK - 1) / PATTERN_CHUNK;
+      task.mThreads = Min(threads, task.mChunks);
+
+      for (int t = 1; t < task.mThreads; ++t) {
+        workers[t - 1]->mStart.Post();
+      }
+      TrainWorker(*this, task, 0).Run();
+      for (int t = 1; t < task.mThreads; ++t) {
+        task.mDone.Wait();
+      }
+
+      std::fill(gradient.begin(), gradient.end(), real(0.0));
+      for (int c = 0; c < task.mChunks; ++c) {
+        for (int w = 0; w < task.mWeightSize; ++w) {
+          gradient[w] += task.mGradient[c][w];
+        }
+        error += task.mError[c];
+      }
+
+      const real rate = mEta / task.mSize;
+      for (int i = 1; i < mLayers; ++i) {
+        const real *g = &gradient[task.mWeightOffset[i]];
+        real *w = mWeight[i];
+        real *dw = mDeltaWeight[i];
+        for (int k = 0; k < mUnits[i] * mStride[i]; ++k) {
+          dw[k] = rate * g[k] + mAlpha * dw[k];
+          w[k] += dw[k];
+        }
+      }
+    }
+
+    real validation_error = 0.0;
+    if (!validation.empty()) {
+      validation_error = ValidationError(set, validation);
+      if (best_weight.empty() || validation_error < best_error) {
+        best_error = validation_error;
+        best_epoch = epochs;
+        best_weight.clear();
+        for (int i = 1; i < mLayers; ++i) {
+          best_weight.insert(best_weight.end(), mWeight[i],
+                             mWeight[i] + mUnits[i] * mStride[i]);
+        }
+      }
+    }
+
+    if (mLogName) {
+      fprintf(log_file, "%d %f %f\n", epochs, (double)error,
+              (double)validation_error);
+    }
+    if (error < mDesiredError) {
+      break;
+    }
+    if (!validation.empty() && mPatience > 0 &&
+        epochs - best_epoch >= mPatience) {
+      break;
+    }
   }
 
-  for (int i = 0; i < patterns; ++i) {
-    delete[] input[i];
-    delete[] desire[i];
+  task.mQuit = true;
+  for (size_t t = 0; t < workers.size(); ++t) {
+    workers[t]->mStart.Post();
+    workers[t]->Join();
+    delete workers[t];
   }
-  delete[] input;
-  delete[] desire;
 
-  return error;
+  if (!best_weight.empty()) {
+    for (int i = 1, offset = 0; i < mLayers; ++i) {
+      std::copy(best_weight.begin() + offset,
+                best_weight.begin() + offset + mUnits[i] * mStride[i],
+                mWeight[i]);
+      offset += mUnits[i] * mStride[i];
+    }
+  }
+
+  const double seconds = (RealTime(GetRealTime()) - start_time) / 1000.0;
+  std::cout << "BPN::TrainOnFile: " << epochs << " epochs in " << seconds
+            << " s (" << epochs / Max(seconds, 1.0e-6) << " epochs/s, "
+            << threads << " threads), train error " << error;
+  if (!validation.empty()) {
+    std::cout << ", best validation error " << best_error << " at epoch "
+              << best_epoch;
+  }
+  std::cout << std::endl;
+
+  if (mLogName != 0) {
+    fclose(log_file);
+  }
+}
+
+real Net::TestOnFile(const char *fname) {
+  if (mUnits == 0)
+    return -1.0;
+
+  PatternSet set;
+  if (!LoadPatterns(fname, set)) {
+    return -1.0;
+  }
+
+  std::vector<int> index(set.mPatterns);
+  for (int p = 0; p < set.mPatterns; ++p) {
+    index[p] = p;
+  }
+  return ValidationError(set, index);
 }
@@ -32,42 +32,69 @@
 #ifndef BPN_H_
 #define BPN_H_
 
+#include <vector>
+
+/**
+ * 编译时定义 NET_FLOAT 则网络用 float 计算，模型文件中仍然存 double；
+ * 定义 NET_FAST_SIGMOID 则 sigmoid 用多项式近似 exp，批量计算时可以向量化
+ */
+#ifdef NET_FLOAT
+typedef float real;
+#else
 typedef double real;
+#endif
 
 class Net {
-  int mLayers; /// number of layers(including input layer)
-  int *mUnits; /// the number of units of each layer
+  int mLayers;  /// number of layers(including input layer)
+  int *mUnits;  /// the number of units of each layer
+  int *mStride; /// 每层权值矩阵一行的长度（含偏置，按 ALIGN_UNITS 对齐）
 
-  real ***mWeight;      /// weight of each conjuction between units
-  real ***mDeltaWeight; /// delta weight of each conjuction between units
-  real **mDelta;        /// delta value of each unit
-  real **mOutput;       /// output value of each unit
-  real *mDesire;        /// desired output value of output layer
+  real **mWeight;      /// 每层一块连续的权值，第j个单元的权值从
+                       /// mWeight[i] + j * mStride[i] 开始，最后一个为偏置
+  real **mDeltaWeight; /// delta weight of each conjuction between units
+  real **mDelta;       /// delta value of each unit
+  real **mOutput;      /// output value of each unit
+  real *mDesire;       /// desired output value of output layer
+  real **mBatchOutput; /// 批量计算时每层的输出，按 [单元][样本] 存放
 
   real mEta;
   real mAlpha;
   real mDesiredError;
   int mMaxEpochs;
 
+  int mBatchSize;        /// 小批量的样本数，0表示逐个样本在线训练
+  int mThreads;          /// 计算梯度的线程数，0表示使用所有CPU
+  real mValidationRatio; /// 留作验证集的样本比例
+  int mPatience;         /// 验证误差连续这么多轮没有下降就停止
+
   char *mLogName;
 
 public:
+  enum {
+    ALIGN_UNITS = 4, /// 权值行按4个real对齐
+    BATCH_SIZE = 64  /// 批量计算时一次处理的样本数
+  };
+
   Net(int Layers = 0, int *Units = 0);
   Net(const char *fname);
   ~Net();
 
   void Construct(int layers, int *units);
-  void Construct(const char *fname);
+  void Construct(const char *fname); /// 根据文件内容识别二进制或文本格式
   void Destroy();
-  void Save(const char *fname);
+  void Save(const char *fname, bool binary = true);
 
   void
   Run(real *input,
       real *output); /// calc outout of input and return sum of square error
+  void Run(int size, real *const *input,
+           real *const *output); /// 批量计算，结果与逐个 Run 完全一致
   real Train(real *input,
              real *desire); /// train network with sample <Input, Desire>
-  void TrainOnFile(const char *fname);
+  bool TrainOnFile(const char *fname); /// 样本文件可以是文本或二进制格式，读取失败返回false
   real TestOnFile(const char *fname);
+  static bool ConvertTrainFile(const char *text_file,
+                               const char *binary_file);
   real Error();
 
   void SetLearningRate(real rate);
@@ -75,19 +102,56 @@ public:
   void SetDesiredError(real d);
   void SetLogName(const char *);
   void SetMaxEpochs(int);
+  void SetBatchSize(int);
+  void SetThreads(int);
+  void SetValidation(real ratio, int patience);
 
 private:
+  /**
+   * 二进制样本文件头，后面紧跟每个样本的 input_size + desire_size 个 double
+   */
+  struct PatternHeader {
+    char mMagic[4]; /// "WENP"
+    int mVersion;
+    int mPatterns;
+    int mInputSize;
+    int mDesireSize;
+    int mReserved[3]; /// 保持头部为32字节
+  };
+
+  struct PatternSet;
+  struct TrainTask;
+  class TrainWorker;
+
+  static bool LoadPatterns(const char *fname, PatternSet &set);
+  void TrainOnline(const PatternSet &set);
+  void TrainMiniBatch(const PatternSet &set);
+  void ComputeGradient(TrainTask &task, int chunk);
+  real ValidationError(const PatternSet &set, const std::vector<int> &index);
+
   Net(const Net &);
   void Memaloc();
   void SetDefaultValue();
+  void SetTrainDefaultValue();
 
   void SetInput(real *input);
   void SetDesire(real *desire);
   void InitWeight();
   void FeedForward();
+  void BatchFeedForward(int size);
   void BackProp();
   void UpdateWeight();
 
+  real *Weight(int layer, int unit) {
+    return mWeight[layer] + unit * mStride[layer];
+  }
+  real *DeltaWeight(int layer, int unit) {
+    return mDeltaWeight[layer] + unit * mStride[layer];
+  }
+
+  static real *AlignedAlloc(int size);
+  static void AlignedFree(real *p);
+
   real sigmoid(real s);
   real small_rand();
 };
@@ -31,6 +31,7 @@
 
 #include "Parser.h"
 #include "DynamicDebug.h"
+#include "Kicker.h"
 #include "Logger.h"
 #include "NetworkTest.h"
 #include "Observer.h"
@@ -51,6 +52,138 @@ const double Parser::INVALID_VALUE = std::numeric_limits<double>::max();
 #define PARSE_ERROR(x)
 #endif
 
+namespace {
+/**
+ * 视觉信息中标志、球门和边线的名字，通过完美哈希直接映射到编号，
+ * 代替逐字符的分支判断
+ * Names of flags, goals and lines in see messages, resolved to their ids by a
+ * perfect hash instead of character-by-character branching.
+ */
+struct ObjName {
+  const char *name;
+  ObjectType type;
+  int id; // MarkerType or SideLineType
+};
+
+const ObjName OBJ_NAMES[] = {
+    {"g l", OBJ_Marker, Goal_L},
+    {"g r", OBJ_Marker, Goal_R},
+    {"f c", OBJ_Marker, Flag_C},
+    {"f c t", OBJ_Marker, Flag_CT},
+    {"f c b", OBJ_Marker, Flag_CB},
+    {"f l t", OBJ_Marker, Flag_LT},
+    {"f l b", OBJ_Marker, Flag_LB},
+    {"f r t", OBJ_Marker, Flag_RT},
+    {"f r b", OBJ_Marker, Flag_RB},
+    {"f p l t", OBJ_Marker, Flag_PLT},
+    {"f p l c", OBJ_Marker, Flag_PLC},
+    {"f p l b", OBJ_Marker, Flag_PLB},
+    {"f p r t", OBJ_Marker, Flag_PRT},
+    {"f p r c", OBJ_Marker, Flag_PRC},
+    {"f p r b", OBJ_Marker, Flag_PRB},
+    {"f g l t", OBJ_Marker, Flag_GLT},
+    {"f g l b", OBJ_Marker, Flag_GLB},
+    {"f g r t", OBJ_Marker, Flag_GRT},
+    {"f g r b", OBJ_Marker, Flag_GRB},
+    {"f t l 50", OBJ_Marker, Flag_TL50},
+    {"f t l 40", OBJ_Marker, Flag_TL40},
+    {"f t l 30", OBJ_Marker, Flag_TL30},
+    {"f t l 20", OBJ_Marker, Flag_TL20},
+    {"f t l 10", OBJ_Marker, Flag_TL10},
+    {"f t 0", OBJ_Marker, Flag_T0},
+    {"f t r 10", OBJ_Marker, Flag_TR10},
+    {"f t r 20", OBJ_Marker, Flag_TR20},
+    {"f t r 30", OBJ_Marker, Flag_TR30},
+    {"f t r 40", OBJ_Marker, Flag_TR40},
+    {"f t r 50", OBJ_Marker, Flag_TR50},
+    {"f b l 50", OBJ_Marker, Flag_BL50},
+    {"f b l 40", OBJ_Marker, Flag_BL40},
+    {"f b l 30", OBJ_Marker, Flag_BL30},
+    {"f b l 20", OBJ_Marker, Flag_BL20},
+    {"f b l 10", OBJ_Marker, Flag_BL10},
+    {"f b 0", OBJ_Marker, Flag_B0},
+    {"f b r 10", OBJ_Marker, Flag_BR10},
+    {"f b r 20", OBJ_Marker, Flag_BR20},
+    {"f b r 30", OBJ_Marker, Flag_BR30},
+    {"f b r 40", OBJ_Marker, Flag_BR40},
+    {"f b r 50", OBJ_Marker, Flag_BR50},
+    {"f l t 30", OBJ_Marker, Flag_LT30},
+    {"f l t 20", OBJ_Marker, Flag_LT20},
+    {"f l t 10", OBJ_Marker, Flag_LT10},
+    {"f l 0", OBJ_Marker, Flag_L0},
+    {"f l b 10", OBJ_Marker, Flag_LB10},
+    {"f l b 20", OBJ_Marker, Flag_LB20},
+    {"f l b 30", OBJ_Marker, Flag_LB30},
+    {"f r t 30", OBJ_Marker, Flag_RT30},
+    {"f r t 20", OBJ_Marker, Flag_RT20},
+    {"f r t 10", OBJ_Marker, Flag_RT10},
+    {"f r 0", OBJ_Marker, Flag_R0},
+    {"f r b 10", OBJ_Marker, Flag_RB10},
+    {"f r b 20", OBJ_Marker, Flag_RB20},
+    {"f r b 30", OBJ_Marker, Flag_RB30},
+    {"l l", OBJ_Line, SL_Left},
+    {"l r", OBJ_Line, SL_Right},
+    {"l t", OBJ_Line, SL_Top},
+    {"l b", OBJ_Line, SL_Bottom},
+};
+
+const int OBJ_NAMES_NUM = sizeof(OBJ_NAMES) / sizeof(OBJ_NAMES[0]);
+
+/**
+ * 构造时搜索一个没有冲突的种子，之后每次查找只需一次哈希和一次比较
+ * The constructor searches for a collision-free seed; a lookup is then one
+ * hash plus one comparison.
+ */
+class ObjNameTable {
+  ObjNameTable() {
+    for (mSeed = 1;; ++mSeed) {
+      memset(mTable, 0, sizeof(mTable));
+      int i = 0;
+      for (; i < OBJ_NAMES_NUM; ++i) {
+        const unsigned h =
+            Hash(OBJ_NAMES[i].name, strlen(OBJ_NAMES[i].name), mSeed);
+        if (mTable[h] != 0) {
+          break;
+        }
+        mTable[h] = &OBJ_NAMES[i];
+      }
+      if (i == OBJ_NAMES_NUM) {
+        break;
+      }
+    }
+  }
+
+public:
+  static ObjNameTable &instance() {
+    static ObjNameTable table;
+    return table;
+  }
+
+  const ObjName *Find(const char *name, const int len) const {
+    const ObjName *obj_name = mTable[Hash(name, len, mSeed)];
+    if (obj_name != 0 && !strncmp(obj_name->name, name, len) &&
+        obj_name->name[len] == '\0') {
+      return obj_name;
+    }
+    return 0;
+  }
+
+private:
+  static const unsigned TABLE_SIZE = 256;
+
+  static unsigned Hash(const char *name, const int len, const unsigned seed) {
+    unsigned h = seed;
+    for (int i = 0; i < len; ++i) {
+      h = h * 31 + static_cast<unsigned char>(name[i]);
+    }
+    return (h ^ (h >> 8)) & (TABLE_SIZE - 1);
+  }
+
+  unsigned mSeed;
+  const ObjName *mTable[TABLE_SIZE];
+};
+} // namespace
+
 Parser::Parser(Observer *p_observer) {
   mpObserver = p_observer;
 
@@ -63,7 +196,10 @@ Parser::Parser(Observer *p_observer) {
 
   mLastServerPlayMode = SPM_Null;
 
+  mHasArrivalTime = false;
+
   ServerPlayModeMap::instance();
+  ObjNameTable::instance();
 
   if (PlayerParam::instance().isCoach()) {
     UDPSocket::instance().Initial(ServerParam::instance().serverHost().c_str(),
@@ -82,20 +218,44 @@ Parser::~Parser() {}
 void Parser::StartRoutine() {
   ConnectToServer();
 
-  while (true) {
-    if (UDPSocket::instance().Receive(mBuf) > 0) {
-      NetworkTest::instance().AddParserBegin();
+  if (PlayerParam::instance().BatchReceive()) {
+    while (true) {
+      //一次收下所有排队的消息，按到达顺序解析
+      const int n = UDPSocket::instance().ReceiveBatch();
+      for (int i = 0; i < n; ++i) {
+        mHasArrivalTime =
+            UDPSocket::instance().GetBatchArrivalTime(i, &mArrivalTime);
+        ProcessMessage(UDPSocket::instance().GetBatchMessage(i));
+      }
+      mHasArrivalTime = false;
+    }
+  } else {
+    while (true) {
+      if (UDPSocket::instance().Receive(mBuf) > 0) {
+        ProcessMessage(mBuf);
+      }
+    }
+  }
+}
 
-      DynamicDebug::instance().AddMessage(mBuf,
-                                          MT_Parse); // 动态调试记录Parser信息
+void Parser::ProcessMessage(char *msg) {
+  NetworkTest::instance().AddParserBegin();
 
-      mpObserver->Lock(); // parse时禁止WorldState更新
-      Parse(mBuf);
-      mpObserver->UnLock();
+  DynamicDebug::instance().AddMessage(msg,
+                                      MT_Parse); // 动态调试记录Parser信息
 
-      NetworkTest::instance().AddParserEnd(mpObserver->CurrentTime());
-    }
+  mpObserver->Lock(); // parse时禁止WorldState更新
+  Parse(msg);
+  mpObserver->UnLock();
+
+  NetworkTest::instance().AddParserEnd(mpObserver->CurrentTime());
+}
+
+RealTime Parser::GetArrivalTime() {
+  if (mHasArrivalTime) {
+    return GetRealTimeParser(mArrivalTime);
   }
+  return GetRealTimeParser();
 }
 
 void Parser::ConnectToServer() {
@@ -200,6 +360,8 @@ bool Parser::ParseInitializeMsg(const char *msg) {
 }
 
 void Parser::Parse(char *msg) {
+  TIMETEST("Parse");
+
   ServerMsgType msg_type = None_Msg;
 
   switch (msg[1]) {
@@ -545,7 +707,7 @@ void Parser::ParseTime(char *msg, char **end_ptr, bool is_new_cycle) {
   *end_ptr = msg;
   int time = parser::get_int(end_ptr);
 
-  RealTime real_time = GetRealTimeParser();
+  RealTime real_time = GetArrivalTime();
 
   /* if (mpObserver->IsPlanned()) { // -- 决策完了，才收到信息
           std::cerr << "# " << mpObserver->SelfUnum() << " @ " <<
@@ -617,6 +779,14 @@ void Parser::ParsePlayerType(char *msg) {
 
   if (type >= PlayerParam::instance().playerTypes() - 1) {
     mIsPlayerTypesReady = true;
+
+    if (!PlayerParam::instance().isCoach() &&
+        !PlayerParam::instance().isTrainer()) {
+      //按真实参数在后台准备自己类型的踢球表，其他类型用到时再准备
+      const Unum self = mpObserver->SelfUnum();
+      Kicker::instance().RequestUtilityTable(
+          self > 0 ? mpObserver->GetTeammateType(self) : 0);
+    }
   }
 }
 
@@ -625,6 +795,11 @@ void Parser::ParseChangePlayerType(char *msg) {
   if (*msg != ')') {
     int type = parser::get_int(msg);
     mpObserver->SetTeammateType(player, type);
+    if (player == mpObserver->SelfUnum() &&
+        !PlayerParam::instance().isCoach() &&
+        !PlayerParam::instance().isTrainer()) {
+      Kicker::instance().RequestUtilityTable(type); //自己换了类型
+    }
   } else {
     mpObserver->AddOpponentTypeChangedCount(player);
   }
@@ -634,15 +809,20 @@ void Parser::ParseSight(char *msg) {
   NetworkTest::instance().End("Sense", "Sight");
 
   mpObserver->SetLastSightRealTime(
-      GetRealTimeParser()); // set the last sight time
+      GetArrivalTime()); // set the last sight time
   mpObserver->SetLatestSightTime(mpObserver->CurrentTime());
 
   msg = strstr(msg, "((");
-  while (msg != 0) {                 // 直到没有object为止
-    msg += 2;                        // 跳过 ((
-    ObjType obj = ParseObjType(msg); // 获得object的类型
-    msg = strchr(msg, ')');
-    ObjProperty prop = ParseObjProperty(msg + 1); // 获得object的属性
+  while (msg != 0) { // 直到没有object为止
+    msg += 2;        // 跳过 ((
+    char *name_end = strchr(msg, ')');
+    if (name_end == 0) {
+      PARSE_ERROR("incomplete sight message");
+      break;
+    }
+    ObjType obj = ParseObjType(msg, name_end); // 获得object的类型
+    ObjProperty prop =
+        ParseObjProperty(name_end + 1, &msg); // 获得object的属性，msg移到末尾
 
     switch (obj.type) {
     case OBJ_Marker:
@@ -725,16 +905,19 @@ Parser::ObjType Parser::ParseObjType_Fullstate(char *msg) {
   return result;
 }
 
-Parser::ObjType Parser::ParseObjType(char *msg) {
+Parser::ObjType Parser::ParseObjType(char *msg, const char *end) {
   switch (*msg) {
   case 'g':
-  case 'G':
-    return ParseGoal(msg);
   case 'f':
-  case 'F':
-    return ParseMarker(msg);
   case 'l':
-    return ParseLine(msg);
+    return ParseMarker(msg, (end != 0) ? end : strchr(msg, ')'));
+  case 'G':
+  case 'F': {
+    ObjType result;
+    result.type = OBJ_Marker_Behind;
+    // result.marker = _pMem->ClosestFlagTo(); /*TODO:  could be No_Marker */
+    return result;
+  }
   case 'p':
   case 'P':
     return ParsePlayer(msg);
@@ -751,270 +934,21 @@ Parser::ObjType Parser::ParseObjType(char *msg) {
   return result;
 }
 
-Parser::ObjType Parser::ParseGoal(char *msg) {
+Parser::ObjType Parser::ParseMarker(char *msg, const char *end) {
   ObjType result;
-  if (*msg == 'g') { // goal
-    result.type = OBJ_Marker;
-    msg += 2; // 'g '
-    if (*msg == 'r') {
-      result.marker = Goal_R;
-    } else if (*msg == 'l') {
-      result.marker = Goal_L;
-    } else {
-      PARSE_ERROR("goal ?");
-    }
-  } else if (*msg == 'G') { // goal behind
-    result.type = OBJ_Marker_Behind;
-    // result.marker = _pMem->ClosestGoal(); TODO: how to process?
-  }
-  return result;
-}
 
-Parser::ObjType Parser::ParseMarker(char *msg) {
-  ObjType result;
-  if (*msg == 'f') { // flag
-    result.type = OBJ_Marker;
-    msg += 2; // 'f '
-    if (*msg == 'r') {
-      msg += 2; // 'r'
-      if (*msg == '0') {
-        result.marker = Flag_R0;
-      } else if (*msg == 'b') {
-        msg += 1;
-        if (*msg == ')') {
-          result.marker = Flag_RB;
-        } else {    // flag r b
-          msg += 1; // skip space
-          if (*msg == '1') {
-            result.marker = Flag_RB10;
-          } else if (*msg == '2') {
-            result.marker = Flag_RB20;
-          } else if (*msg == '3') {
-            result.marker = Flag_RB30;
-          } else {
-            PARSE_ERROR("flag r b ?");
-          }
-        }
-      } else if (*msg == 't') {
-        msg += 1;
-        if (*msg == ')') {
-          result.marker = Flag_RT;
-        } else { // flag r t
-          msg += 1;
-          if (*msg == '1') {
-            result.marker = Flag_RT10;
-          } else if (*msg == '2') {
-            result.marker = Flag_RT20;
-          } else if (*msg == '3') {
-            result.marker = Flag_RT30;
-          } else {
-            PARSE_ERROR("flag r t ?");
-          }
-        }
-      } else {
-        PARSE_ERROR("flag r ?");
-      }
-    } else if (*msg == 'l') { // flag l
-      msg += 2;               // 'l '
-      if (*msg == '0') {
-        result.marker = Flag_L0;
-      } else if (*msg == 'b') { // flag l b
-        msg += 1;
-        if (*msg == ')') {
-          result.marker = Flag_LB;
-        } else {
-          msg += 1;
-          if (*msg == '1') {
-            result.marker = Flag_LB10;
-          } else if (*msg == '2') {
-            result.marker = Flag_LB20;
-          } else if (*msg == '3') {
-            result.marker = Flag_LB30;
-          } else {
-            PARSE_ERROR("flag l b ?");
-          }
-        }
-      } else if (*msg == 't') { // flag l t
-        msg += 1;
-        if (*msg == ')') {
-          result.marker = Flag_LT;
-        } else {
-          msg += 1;
-          if (*msg == '1') {
-            result.marker = Flag_LT10;
-          } else if (*msg == '2') {
-            result.marker = Flag_LT20;
-          } else if (*msg == '3') {
-            result.marker = Flag_LT30;
-          } else {
-            PARSE_ERROR("flag l t ?");
-          }
-        }
-      } else {
-        PARSE_ERROR("flag l ?");
-      }
-    } else if (*msg == 't') { // flag t
-      msg += 2;
-      if (*msg == '0') {
-        result.marker = Flag_T0;
-      } else if (*msg == 'l') {
-        msg += 2;
-        if (*msg == '1') {
-          result.marker = Flag_TL10;
-        } else if (*msg == '2') {
-          result.marker = Flag_TL20;
-        } else if (*msg == '3') {
-          result.marker = Flag_TL30;
-        } else if (*msg == '4') {
-          result.marker = Flag_TL40;
-        } else if (*msg == '5') {
-          result.marker = Flag_TL50;
-        } else {
-          PARSE_ERROR("flag t l ?");
-        }
-      } else if (*msg == 'r') {
-        msg += 2;
-        if (*msg == '1') {
-          result.marker = Flag_TR10;
-        } else if (*msg == '2') {
-          result.marker = Flag_TR20;
-        } else if (*msg == '3') {
-          result.marker = Flag_TR30;
-        } else if (*msg == '4') {
-          result.marker = Flag_TR40;
-        } else if (*msg == '5') {
-          result.marker = Flag_TR50;
-        } else {
-          PARSE_ERROR("flag t r ?");
-        }
-      } else {
-        PARSE_ERROR("flag t ?");
-      }
-    } else if (*msg == 'b') {
-      msg += 2;
-      if (*msg == '0') {
-        result.marker = Flag_B0;
-      } else if (*msg == 'l') {
-        msg += 2;
-        if (*msg == '1') {
-          result.marker = Flag_BL10;
-        } else if (*msg == '2') {
-          result.marker = Flag_BL20;
-        } else if (*msg == '3') {
-          result.marker = Flag_BL30;
-        } else if (*msg == '4') {
-          result.marker = Flag_BL40;
-        } else if (*msg == '5') {
-          result.marker = Flag_BL50;
-        } else {
-          PARSE_ERROR("flag b l ?");
-        }
-      } else if (*msg == 'r') {
-        msg += 2;
-        if (*msg == '1') {
-          result.marker = Flag_BR10;
-        } else if (*msg == '2') {
-          result.marker = Flag_BR20;
-        } else if (*msg == '3') {
-          result.marker = Flag_BR30;
-        } else if (*msg == '4') {
-          result.marker = Flag_BR40;
-        } else if (*msg == '5') {
-          result.marker = Flag_BR50;
-        } else {
-          PARSE_ERROR("flag b r ?");
-        }
-      } else {
-        PARSE_ERROR("flag b ?");
-      }
-    } else if (*msg == 'c') {
-      msg += 1;
-      if (*msg == ')') {
-        result.marker = Flag_C;
-      } else {
-        msg += 1;
-        if (*msg == 'b') {
-          result.marker = Flag_CB;
-        } else if (*msg == 't') {
-          result.marker = Flag_CT;
-        } else {
-          PARSE_ERROR("flag c ?");
-        }
-      }
-    } else if (*msg == 'p') {
-      msg += 2;
-      if (*msg == 'r') {
-        msg += 2;
-        if (*msg == 't') {
-          result.marker = Flag_PRT;
-        } else if (*msg == 'c') {
-          result.marker = Flag_PRC;
-        } else if (*msg == 'b') {
-          result.marker = Flag_PRB;
-        } else {
-          PARSE_ERROR("flag p r ?");
-        }
-      } else if (*msg == 'l') {
-        msg += 2;
-        if (*msg == 't') {
-          result.marker = Flag_PLT;
-        } else if (*msg == 'c') {
-          result.marker = Flag_PLC;
-        } else if (*msg == 'b') {
-          result.marker = Flag_PLB;
-        } else {
-          PARSE_ERROR("flag p l ?");
-        }
-      } else {
-        PARSE_ERROR("flag p ?");
-      }
-    } else if (*msg == 'g') {
-      msg += 2;
-      if (*msg == 'l') {
-        msg += 2;
-        if (*msg == 't') {
-          result.marker = Flag_GLT;
-        } else if (*msg == 'b') {
-          result.marker = Flag_GLB;
-        } else {
-          PARSE_ERROR("flag g l ?");
-        }
-      } else if (*msg == 'r') {
-        msg += 2;
-        if (*msg == 't') {
-          result.marker = Flag_GRT;
-        } else if (*msg == 'b') {
-          result.marker = Flag_GRB;
-        } else {
-          PARSE_ERROR("flag g r ?");
-        }
-      } else {
-        PARSE_ERROR("flag g ?");
-      }
-    } else {
-      PARSE_ERROR("flag ?");
-    }
-  } else if (*msg == 'F') { // Flag behind
-    result.type = OBJ_Marker_Behind;
-    // result.marker = _pMem->ClosestFlagTo(); /*TODO:  could be No_Marker */
+  const ObjName *obj_name =
+      (end != 0) ? ObjNameTable::instance().Find(msg, end - msg) : 0;
+  if (obj_name == 0) {
+    PARSE_ERROR("unknown marker or line");
+    return result;
   }
-  return result;
-}
 
-Parser::ObjType Parser::ParseLine(char *msg) {
-  ObjType result;
-  result.type = OBJ_Line;
-  msg += 2; // 'l'
-  if (*msg == 'r') {
-    result.line = SL_Right;
-  } else if (*msg == 'l') {
-    result.line = SL_Left;
-  } else if (*msg == 't') {
-    result.line = SL_Top;
-  } else if (*msg == 'b') {
-    result.line = SL_Bottom;
+  result.type = obj_name->type;
+  if (result.type == OBJ_Line) {
+    result.line = static_cast<SideLineType>(obj_name->id);
   } else {
-    PARSE_ERROR("line ?");
+    result.marker = static_cast<MarkerType>(obj_name->id);
   }
   return result;
 }
@@ -1098,103 +1032,90 @@ Parser::ObjType Parser::ParseBall(char *msg) {
   return result;
 }
 
-Parser::ObjProperty Parser::ParseObjProperty(char *msg) {
+Parser::ObjProperty Parser::ParseObjProperty(char *msg, char **end_ptr) {
+  // 一遍扫描，数字依次存下，标志字母直接记录，最后按数字的个数确定含义：
+  // 2: dist dir
+  // 3: dist dir point_dir
+  // 4: dist dir dist_chg dir_chg
+  // 6: dist dir dist_chg dir_chg body_dir head_dir
+  // 7: dist dir dist_chg dir_chg body_dir head_dir point_dir
+  // 标志 t/k/f 和 y/r 可以出现在数字之间或者最后
   ObjProperty result;
 
-  /* 'high' quality only */
-  result.dist = parser::get_double(&msg); /* 'high' quality     */
-  result.dir = parser::get_double(&msg);
+  double values[7];
+  int n = 0;
 
-  if (*msg != ')') {
-    if (*msg == ' ') {
-      ++msg;
-    }
-    if (*msg == 't') {
+  while (*msg != ')' && *msg) {
+    switch (*msg) {
+    case ' ':
+      break;
+    case 't':
       result.tackling = true;
-      ++msg;
-    } else if (*msg == 'k') {
+      break;
+    case 'k':
       result.kicked = true;
-      ++msg;
-    } else if (*msg == 'f') {
+      break;
+    case 'f':
       result.lying = true;
-      ++msg;
-    }
-  }
-  if (*msg != ')') {
-    result.dist_chg = parser::get_double(&msg); // 也可能是pointdir
-    if (*msg == ' ') {                          // 后面还有
-      msg++;                                    // 跳过空格
-      if (*msg == 't' || *msg == 'k' || *msg == 'f') {
-        if (*msg == 't') {
-          result.tackling = true;
-        } else if (*msg == 'k') {
-          result.kicked = true;
-        } else
-          result.lying = true;
-        msg++;
-        result.point_dir = result.dist_chg;
-        result.pointing = true;
-        result.dist_chg = INVALID_VALUE;
+      break;
+    case 'y':
+      result.card_type = CR_Yellow;
+      break;
+    case 'r':
+      result.card_type = CR_Red;
+      break;
+    default: {
+      char *next = msg;
+      const double value = parser::str_to_double(msg, &next);
+      if (next == msg) {
+        PARSE_ERROR("why come to this place");
+        break;
+      }
+      if (n < 7) {
+        values[n++] = value;
       } else {
-        result.dir_chg = parser::get_double(&msg);
+        PARSE_ERROR("Should be done with object info here");
       }
-    } else if (*msg == ')') {
-      result.pointing = true;
-      result.point_dir = result.dist_chg;
-      result.dist_chg = INVALID_VALUE;
+      msg = next;
+      continue;
+    }
     }
+    ++msg;
   }
 
-  if (*msg != ')') {
-    result.body_dir = parser::get_double(&msg);
-    result.head_dir = parser::get_double(&msg);
-    if (*msg == ' ') { // 后面还有 pointdir and/or tackling/kicked flag
-      msg++;
-      if (*msg == 't' || *msg == 'k' ||
-          *msg == 'f') { // 只有tackling/kicked flag
-        if (*msg == 't') {
-          result.tackling = true;
-        } else if (*msg == 'k') {
-          result.kicked = true;
-        } else
-          result.lying = true;
-        msg++;
-      } else { // 是数字
-        result.pointing = true;
-        result.point_dir = parser::get_double(&msg);
-        if (*msg == ' ') {
-          while (*msg == ' ')
-            ++msg;
-          if (*msg == 't' || *msg == 'k' || *msg == 'f') {
-            if (*msg == 't') {
-              result.tackling = true;
-              ++msg;
-            } else if (*msg == 'k') {
-              result.kicked = true;
-              ++msg;
-            } else {
-              result.lying = true;
-              ++msg;
-            }
-            while (*msg == ' ')
-              ++msg;
-          }
-          if (*msg == 'y') {
-            result.card_type = CR_Yellow;
-            ++msg;
-          } else if (*msg == 'r') {
-            result.card_type = CR_Red;
-            ++msg;
-          } else if (*msg != ')') {
-            PARSE_ERROR("why come to this place");
-          }
-        }
-      }
+  switch (n) {
+  case 7:
+    result.pointing = true;
+    result.point_dir = values[6];
+  // fall through
+  case 6:
+    result.body_dir = values[4];
+    result.head_dir = values[5];
+  // fall through
+  case 4:
+    result.dist_chg = values[2];
+    result.dir_chg = values[3];
+  // fall through
+  case 2:
+    result.dist = values[0];
+    result.dir = values[1];
+    break;
+  case 3:
+    result.dist = values[0];
+    result.dir = values[1];
+    result.pointing = true;
+    result.point_dir = values[2];
+    break;
+  default:
+    PARSE_ERROR("Should be done with object info here");
+    if (n > 0) {
+      result.dist = values[0];
     }
+    break;
   }
 
-  if (*msg != ')') {
-    PARSE_ERROR("Should be done with object info here");
+  if (end_ptr != 0) {
+    *end_ptr = msg;
   }
 
   Assert(result.card_type ==
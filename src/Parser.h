@@ -167,6 +167,7 @@ public:
 
 private:
   void ConnectToServer();
+  void ProcessMessage(char *msg);
   void SendInitialLizeMsg();
   void ParseServerParam(char *msg);
   void ParsePlayerParam(char *msg);
@@ -271,16 +272,14 @@ private:
     CardType card_type;
   };
 
-  ObjType ParseObjType(char *msg);
-  ObjType ParseGoal(char *msg);
-  ObjType ParseMarker(char *msg);
-  ObjType ParseLine(char *msg);
+  ObjType ParseObjType(char *msg, const char *end = 0);
+  ObjType ParseMarker(char *msg, const char *end);
   ObjType ParsePlayer(char *msg);
   ObjType ParseBall(char *msg);
   ObjType ParseObjType_Fullstate(char *msg);
   ObjType ParsePlayer_Fullstate(char *msg);
 
-  ObjProperty ParseObjProperty(char *msg);
+  ObjProperty ParseObjProperty(char *msg, char **end_ptr = 0);
   ObjProperty_Coach ParseObjProperty_Coach(char *msg);
   ObjProperty_Fullstate ParseObjProperty_Fullstate(char *msg);
 
@@ -295,6 +294,14 @@ private:
 
   static char mBuf[MAX_MESSAGE];
 
+  bool mHasArrivalTime; // 当前消息是否带有内核到达时间
+  timeval mArrivalTime;  // 当前消息进入内核的时间
+
+  /**
+   * 当前消息的到达时间，有内核时间戳时用它，否则用解析时的时间
+   */
+  RealTime GetArrivalTime();
+
 public:
   bool IsConnectServerOk() {
     bool ret;
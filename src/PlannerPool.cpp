@@ -0,0 +1,144 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#include "PlannerPool.h"
+#include "Agent.h"
+#include "InfoState.h"
+#include "PlayerParam.h"
+#include "PositionInfo.h"
+#include "Tackler.h"
+#include "WorldState.h"
+
+PlannerPool::PlannerPool()
+    : mQuit(false), mpAgent(0), mpTasks(0), mTaskSize(0), mNextTask(0) {}
+
+PlannerPool::~PlannerPool() {
+  mQuit = true;
+  for (unsigned i = 0; i < mWorkers.size(); ++i) {
+    mWorkers[i]->mStart.Post();
+  }
+  for (unsigned i = 0; i < mWorkers.size(); ++i) {
+    mWorkers[i]->Join();
+    delete mWorkers[i];
+  }
+}
+
+PlannerPool &PlannerPool::instance() {
+  static PlannerPool pool;
+  return pool;
+}
+
+bool PlannerPool::IsEnabled() const {
+  const PlayerParam &param = PlayerParam::instance();
+
+  //这些记录都不是线程安全的，打开时仍然串行规划
+  return param.PlannerThreads() > 0 && !param.TimeTest() &&
+         !param.SaveTextLog() && !param.SaveServerMessage() &&
+         !param.DynamicDebugMode();
+}
+
+void PlannerPool::Freeze(Agent &agent) {
+  agent.Info().GetPositionInfo().Freeze();
+
+  const WorldState &world_state = agent.GetWorldState();
+  world_state.GetBall().WarmPredictor();
+  for (unsigned i = 0; i < world_state.GetPlayerList().size(); ++i) {
+    world_state.GetPlayerList()[i]->WarmPredictor();
+  }
+
+  Tackler::instance().UpdateTackleData(agent);
+}
+
+void PlannerPool::Run(Agent &agent, PlannerTask **tasks, int size) {
+  mRunMutex.Lock();
+  StartWorkers();
+
+  mpAgent = &agent;
+  mpTasks = tasks;
+  mTaskSize = size;
+  mNextTask = 0;
+
+  //调用线程自己也执行任务，所以最多只需要 size - 1 个工作线程
+  const int workers = Min(int(mWorkers.size()), size - 1);
+  for (int i = 0; i < workers; ++i) {
+    mWorkers[i]->mStart.Post();
+  }
+
+  Work();
+
+  for (int i = 0; i < workers; ++i) {
+    mDone.Wait();
+  }
+
+  mpAgent = 0;
+  mpTasks = 0;
+  mRunMutex.UnLock();
+}
+
+void PlannerPool::Work() {
+  for (;;) {
+    mTaskMutex.Lock();
+    const int i = mNextTask++;
+    mTaskMutex.UnLock();
+
+    if (i >= mTaskSize) {
+      break;
+    }
+    if (i > 0 && mpAgent->IsDecisionTimeOut()) {
+      continue;
+    }
+
+    mpTasks[i]->Run();
+  }
+}
+
+void PlannerPool::StartWorkers() {
+  if (!mWorkers.empty()) {
+    return;
+  }
+
+  for (int i = 0; i < PlayerParam::instance().PlannerThreads(); ++i) {
+    mWorkers.push_back(new Worker(*this));
+    mWorkers.back()->Start();
+  }
+}
+
+void PlannerPool::Worker::StartRoutine() {
+  for (;;) {
+    mStart.Wait();
+    if (mPool.mQuit) {
+      break;
+    }
+
+    mPool.Work();
+    mPool.mDone.Post();
+  }
+}
@@ -0,0 +1,132 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#ifndef __PlannerPool_H__
+#define __PlannerPool_H__
+
+#include "BehaviorBase.h"
+#include "Thread.h"
+#include <list>
+#include <vector>
+
+class Agent;
+
+/**
+ * 线程池里的一个规划任务，结果放在自己的列表里，由调用者按固定顺序合并
+ */
+class PlannerTask {
+public:
+  PlannerTask() {}
+  virtual ~PlannerTask() {}
+
+  virtual void Run() = 0;
+
+  std::list<ActiveBehavior> &GetBehaviorList() { return mBehaviorList; }
+
+protected:
+  std::list<ActiveBehavior> mBehaviorList;
+};
+
+/**
+ * 规划器在主线程构造和析构（构造时会压阵型栈），只有 Plan 在工作线程里执行
+ */
+template <class Planner> class PlanTask : public PlannerTask {
+public:
+  PlanTask(Agent &agent) : mPlanner(agent) {}
+
+  void Run() { mPlanner.Plan(mBehaviorList); }
+
+private:
+  Planner mPlanner;
+};
+
+/**
+ * 并行规划的线程池：固定数目的工作线程，和调用线程一起取任务执行。
+ * 运行之前要先 Freeze，把 InfoState 里按需计算的数据算完，之后各规划器对世界
+ * 状态只读。
+ * Fixed pool of planner workers; the calling thread takes tasks too. Results
+ * stay in each task, so the merge order never depends on scheduling.
+ */
+class PlannerPool {
+  PlannerPool();
+
+public:
+  ~PlannerPool();
+
+  static PlannerPool &instance();
+
+  /**
+   * 本周期是否并行规划：planner_threads 为 0，或者打开了非线程安全的记录时不并行
+   */
+  bool IsEnabled() const;
+
+  /**
+   * 冻结 agent 的世界状态：算完位置信息里的列表，球和球员的预测表，铲球表
+   */
+  void Freeze(Agent &agent);
+
+  /**
+   * 并行执行所有任务，返回时全部完成。超过决策截止时间后不再开始新任务，
+   * 第一个任务总会执行
+   */
+  void Run(Agent &agent, PlannerTask **tasks, int size);
+
+private:
+  class Worker : public Thread {
+  public:
+    Worker(PlannerPool &pool) : mPool(pool) {}
+    virtual ~Worker() {}
+
+    ThreadSemaphore mStart;
+
+  private:
+    void StartRoutine();
+
+    PlannerPool &mPool;
+  };
+
+  void Work();
+  void StartWorkers();
+
+private:
+  std::vector<Worker *> mWorkers;
+  ThreadSemaphore mDone;
+  ThreadMutex mTaskMutex;
+  ThreadMutex mRunMutex; //多个agent共用一个线程池时，一次只跑一批
+  bool mQuit;
+
+  Agent *mpAgent;
+  PlannerTask **mpTasks;
+  int mTaskSize;
+  int mNextTask;
+};
+
+#endif
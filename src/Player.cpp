@@ -71,7 +71,7 @@ void Player::SendOptionToServer() {
 }
 
 void Player::Run() {
-  // TIMETEST("Run");
+  TIMETEST("Run");
 
   static Time last_time = Time(-100, 0);
 
@@ -103,6 +103,18 @@ void Player::Run() {
       .UpdateOpponentRole(); // TODO:
                              // 暂时放在这里，教练未发来对手阵型信息时自己先计算
 
+  //同步模式下服务器会等待决策结束，不需要截止时间
+  if (PlayerParam::instance().AnytimeDecision() &&
+      !ServerParam::instance().synchMode()) {
+    mpAgent->SetDecisionDeadline(
+        mpObserver->GetLastCycleBeginRealTime() +
+        int(ServerParam::instance().simStep() *
+                ServerParam::instance().slowDownFactor() -
+            PlayerParam::instance().DecisionDeadlineBuffer()));
+  } else {
+    mpAgent->ClearDecisionDeadline();
+  }
+
   VisualSystem::instance().ResetVisualRequest();
   mpDecisionTree->Decision(*mpAgent);
 
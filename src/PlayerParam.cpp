@@ -102,14 +102,25 @@ const bool PlayerParam::DYNAMIC_DEBUG_MODE = false;
 const bool PlayerParam::SAVE_SERVER_MESSAGE = false;
 const bool PlayerParam::SAVE_SIGHT_LOG = false;
 const bool PlayerParam::SAVE_DEC_LOG = false;
+const bool PlayerParam::SIGHT_LOG_BINARY = true;
+const char PlayerParam::SIGHT_LOG_CONVERT[] = "";
 const bool PlayerParam::SAVE_TEXT_LOG = false;
 const bool PlayerParam::USE_PLOTTER = false;
 const bool PlayerParam::USE_TEAM_GRAPHIC = true;
 const bool PlayerParam::TIME_TEST = false;
 const bool PlayerParam::NETWORK_TEST = false;
+const bool PlayerParam::BATCH_RECEIVE = true;
+const bool PlayerParam::INTERCEPT_CHECK = false;
+const bool PlayerParam::HEADLESS_MODE = false;
+const int PlayerParam::HEADLESS_CYCLES = 6000;
+const int PlayerParam::HEADLESS_UNUM = 10;
+const int PlayerParam::HEADLESS_SEED = 1;
 const int PlayerParam::WAIT_SIGHT_BUFFER = 40; // 每周期最多等视觉40毫秒
 const int PlayerParam::WAIT_HEAR_BUFFER = 40; // 每周期最多等听觉40毫秒
 const int PlayerParam::WAIT_TIME_OUT = 10; // 每场比赛最多等server10秒
+const bool PlayerParam::ANYTIME_DECISION = true;
+const int PlayerParam::DECISION_DEADLINE_BUFFER = 10;
+const int PlayerParam::HISTORY_DEPTH = 100;
 const double PlayerParam::ROUTE_ANGLE_DIFF = 1.0;
 const double PlayerParam::OPP_TACKLE_THRESHOLD_FORWARD = 0.69;
 const double PlayerParam::OPP_TACKLE_THRESHOLD_MID = 0.75;
@@ -117,6 +128,25 @@ const double PlayerParam::OPP_TACKLE_THRESHOLD_BACK = 0.85;
 const double PlayerParam::TIRED_BUFFER = 10.0;
 const double PlayerParam::AT_POINT_BUFFER = 1.0;
 const int PlayerParam::KICKER_MODE = 0;
+const int PlayerParam::KICKER_TYPE = -1;
+const int PlayerParam::KICKER_THREADS = 0;
+const double PlayerParam::EVALUATION_LATTICE_STEP = 0.5;
+const bool PlayerParam::EVALUATION_CHECK = false;
+const bool PlayerParam::NET_TRAIN = false;
+const char PlayerParam::NET_TRAIN_FILE[] = "data/sensitivity.train";
+const char PlayerParam::NET_MODEL_FILE[] = "data/sensitivity.net";
+const int PlayerParam::NET_BATCH_SIZE = 64;
+const int PlayerParam::NET_TRAIN_THREADS = 0;
+const double PlayerParam::NET_VALIDATION_RATIO = 0.1;
+const int PlayerParam::NET_PATIENCE = 50;
+const double PlayerParam::DRIBBLE_ANGLE_STEP = 2.5;
+const double PlayerParam::PASS_CLEAR_FAN_ANGLE = 45.0;
+const double PlayerParam::PASS_CLEAR_ANGLE_STEP = 2.5;
+const int PlayerParam::DECISION_SEARCH_DEPTH = 1;
+const int PlayerParam::LOOKAHEAD_NODE_BUDGET = 256;
+const double PlayerParam::LOOKAHEAD_DISCOUNT = 0.9;
+const int PlayerParam::PLANNER_THREADS = 0;
+const double PlayerParam::DOMINANCE_GRID_STEP = 1.0;
 const int PlayerParam::MARKOV_DRIBBLER_MODE = 0;
 const int PlayerParam::MARKOV_DRIBBLER_HORIZON = 3;
 const int PlayerParam::MARKOV_DRIBBLER_METHOD = 1;
@@ -300,18 +330,50 @@ void PlayerParam::AddParams() {
   AddParam("save_server_message", &mSaveServerMessage, SAVE_SERVER_MESSAGE);
   AddParam("save_sight_log", &mSaveSightLog, SAVE_SIGHT_LOG);
   AddParam("save_dec_log", &mSaveDecLog, SAVE_DEC_LOG);
+  AddParam("sight_log_binary", &mSightLogBinary, SIGHT_LOG_BINARY);
+  AddParam("sight_log_convert", &mSightLogConvert,
+           std::string(SIGHT_LOG_CONVERT));
   AddParam("save_text_log", &mSaveTextLog, SAVE_TEXT_LOG);
   AddParam("use_plotter", &mUsePlotter, USE_PLOTTER);
   AddParam("use_team_graphic", &mUseTeamGraphic, USE_TEAM_GRAPHIC);
   AddParam("time_test", &mTimeTest, TIME_TEST);
   AddParam("network_test", &mNetworkTest, NETWORK_TEST);
+  AddParam("batch_receive", &mBatchReceive, BATCH_RECEIVE);
+  AddParam("intercept_check", &mInterceptCheck, INTERCEPT_CHECK);
+  AddParam("headless_mode", &mHeadlessMode, HEADLESS_MODE);
+  AddParam("headless_cycles", &mHeadlessCycles, HEADLESS_CYCLES);
+  AddParam("headless_unum", &mHeadlessUnum, HEADLESS_UNUM);
+  AddParam("headless_seed", &mHeadlessSeed, HEADLESS_SEED);
   AddParam("wait_sight_buffer", &mWaitSightBuffer, WAIT_SIGHT_BUFFER);
   AddParam("wait_hear_buffer", &mWaitHearBuffer, WAIT_HEAR_BUFFER);
   AddParam("wait_time_out", &mWaitTimeOut, WAIT_TIME_OUT);
+  AddParam("anytime_decision", &mAnytimeDecision, ANYTIME_DECISION);
+  AddParam("decision_deadline_buffer", &mDecisionDeadlineBuffer,
+           DECISION_DEADLINE_BUFFER);
+  AddParam("history_depth", &mHistoryDepth, HISTORY_DEPTH);
 
   AddParam("tired_buffer", &mTiredBuffer, TIRED_BUFFER);
   AddParam("at_point_buffer", &mAtPointBuffer, AT_POINT_BUFFER);
   AddParam("kicker_mode", &mKickerMode, KICKER_MODE);
+  AddParam("kicker_type", &mKickerType, KICKER_TYPE);
+  AddParam("kicker_threads", &mKickerThreads, KICKER_THREADS);
+  AddParam("evaluation_lattice_step", &mEvaluationLatticeStep, EVALUATION_LATTICE_STEP);
+  AddParam("evaluation_check", &mEvaluationCheck, EVALUATION_CHECK);
+  AddParam("net_train", &mNetTrain, NET_TRAIN);
+  AddParam("net_train_file", &mNetTrainFile, std::string(NET_TRAIN_FILE));
+  AddParam("net_model_file", &mNetModelFile, std::string(NET_MODEL_FILE));
+  AddParam("net_batch_size", &mNetBatchSize, NET_BATCH_SIZE);
+  AddParam("net_train_threads", &mNetTrainThreads, NET_TRAIN_THREADS);
+  AddParam("net_validation_ratio", &mNetValidationRatio, NET_VALIDATION_RATIO);
+  AddParam("net_patience", &mNetPatience, NET_PATIENCE);
+  AddParam("dribble_angle_step", &mDribbleAngleStep, DRIBBLE_ANGLE_STEP);
+  AddParam("pass_clear_fan_angle", &mPassClearFanAngle, PASS_CLEAR_FAN_ANGLE);
+  AddParam("pass_clear_angle_step", &mPassClearAngleStep, PASS_CLEAR_ANGLE_STEP);
+  AddParam("decision_search_depth", &mDecisionSearchDepth, DECISION_SEARCH_DEPTH);
+  AddParam("lookahead_node_budget", &mLookaheadNodeBudget, LOOKAHEAD_NODE_BUDGET);
+  AddParam("lookahead_discount", &mLookaheadDiscount, LOOKAHEAD_DISCOUNT);
+  AddParam("planner_threads", &mPlannerThreads, PLANNER_THREADS);
+  AddParam("dominance_grid_step", &mDominanceGridStep, DOMINANCE_GRID_STEP);
 
   AddParam("our_goalie_unum", &M_our_goalie_unum, 1);
   AddParam("goalie", &M_is_goalie, false);
@@ -327,6 +389,8 @@ void PlayerParam::AddParams() {
   AddParam("say_ball_speed_eps", &M_say_ball_speed_eps, 0.1);
   AddParam("say_player_speed_eps", &M_say_player_speed_eps, 0.1);
   AddParam("say_dir_eps", &M_say_dir_eps, 1.0);
+  AddParam("say_planner", &M_say_planner, true);
+  AddParam("say_codec_check", &M_say_codec_check, false);
 
   AddParam("max_conf", &M_max_conf, MAX_CONF);
   AddParam("min_valid_conf", &M_min_valid_conf, MIN_VALID_CONF);
@@ -281,6 +281,8 @@ private:
   double M_say_ball_speed_eps;
   double M_say_player_speed_eps;
   double M_say_dir_eps;
+  bool M_say_planner; //按效用用背包选择说话内容，否则按固定顺序贪心
+  bool M_say_codec_check; //检查说话编解码的往返误差和耗时
 
   double M_max_conf;
   double M_min_valid_conf;
@@ -548,6 +550,8 @@ public:
   const double &sayBallSpeedEps() const { return M_say_ball_speed_eps; }
   const double &sayPlayerSpeedEps() const { return M_say_player_speed_eps; }
   const double &sayDirEps() const { return M_say_dir_eps; }
+  const bool &sayPlanner() const { return M_say_planner; }
+  const bool &sayCodecCheck() const { return M_say_codec_check; }
 
 private:
   HeteroParam *mHeteroPlayer;
@@ -571,15 +575,26 @@ private:
   static const bool SAVE_SERVER_MESSAGE;
   static const bool SAVE_SIGHT_LOG;
   static const bool SAVE_DEC_LOG;
+  static const bool SIGHT_LOG_BINARY;
+  static const char SIGHT_LOG_CONVERT[];
   static const bool SAVE_TEXT_LOG;
   static const bool SAVE_STAT_LOG;
   static const bool USE_PLOTTER;
   static const bool USE_TEAM_GRAPHIC;
   static const bool TIME_TEST;
   static const bool NETWORK_TEST;
+  static const bool BATCH_RECEIVE;
+  static const bool INTERCEPT_CHECK;
+  static const bool HEADLESS_MODE;
+  static const int HEADLESS_CYCLES;
+  static const int HEADLESS_UNUM;
+  static const int HEADLESS_SEED;
   static const int WAIT_SIGHT_BUFFER;
   static const int WAIT_HEAR_BUFFER;
   static const int WAIT_TIME_OUT;
+  static const bool ANYTIME_DECISION;
+  static const int DECISION_DEADLINE_BUFFER;
+  static const int HISTORY_DEPTH;
   static const double ROUTE_ANGLE_DIFF;
   static const double OPP_TACKLE_THRESHOLD_FORWARD;
   static const double OPP_TACKLE_THRESHOLD_MID;
@@ -587,6 +602,25 @@ private:
   static const double TIRED_BUFFER;
   static const double AT_POINT_BUFFER;
   static const int KICKER_MODE;
+  static const int KICKER_TYPE;
+  static const int KICKER_THREADS;
+  static const double EVALUATION_LATTICE_STEP;
+  static const bool EVALUATION_CHECK;
+  static const bool NET_TRAIN;
+  static const char NET_TRAIN_FILE[];
+  static const char NET_MODEL_FILE[];
+  static const int NET_BATCH_SIZE;
+  static const int NET_TRAIN_THREADS;
+  static const double NET_VALIDATION_RATIO;
+  static const int NET_PATIENCE;
+  static const double DRIBBLE_ANGLE_STEP;
+  static const double PASS_CLEAR_FAN_ANGLE;
+  static const double PASS_CLEAR_ANGLE_STEP;
+  static const int DECISION_SEARCH_DEPTH;
+  static const int LOOKAHEAD_NODE_BUDGET;
+  static const double LOOKAHEAD_DISCOUNT;
+  static const int PLANNER_THREADS;
+  static const double DOMINANCE_GRID_STEP;
   static const int MARKOV_DRIBBLER_MODE;
   static const int MARKOV_DRIBBLER_HORIZON;
   static const int MARKOV_DRIBBLER_METHOD;
@@ -607,14 +641,25 @@ private:
   bool mSaveServerMessage; // 是否保存server的信息，用于动态调试
   bool mSaveSightLog;      // 是否保存sight_log
   bool mSaveDecLog;        // 是否保存dec_log
+  bool mSightLogBinary;    // sight_log是否用二进制分列格式
+  std::string mSightLogConvert; // 把这个二进制sight_log转成rcg后退出
   bool mSaveTextLog;
   bool mUsePlotter;
   bool mUseTeamGraphic;
   bool mTimeTest;
   bool mNetworkTest;
+  bool mBatchReceive;   // 成批收消息并使用内核的到达时间
+  bool mInterceptCheck; // 批量截球与逐个计算的结果比对
+  bool mHeadlessMode;  // 离线无头模式，不连接server
+  int mHeadlessCycles; // 无头模式运行的周期数
+  int mHeadlessUnum;   // 无头模式下被测agent的号码
+  int mHeadlessSeed;   // 无头模式的随机种子，保证结果可重复
   int mWaitSightBuffer; // 等待视觉到来的最大buffer
   int mWaitHearBuffer;  // 等待听觉到来的最大buffer
   int mWaitTimeOut;     // 等待server的最大时间
+  bool mAnytimeDecision; // 决策超过截止时间时用已有的最好结果
+  int mDecisionDeadlineBuffer; // 决策截止时间距周期结束的毫秒数
+  int mHistoryDepth;    // 世界状态历史的最大深度
 
   double mTiredBuffer;
   double mMinStamina;
@@ -630,6 +675,25 @@ private:
    * 1表示离线计算值函数，需要关掉所有log
    */
   int mKickerMode;
+  int mKickerType;    // 离线计算时只重算该类型的值函数，-1表示所有类型
+  int mKickerThreads; // 计算值函数的线程数，0表示使用所有CPU
+  double mEvaluationLatticeStep; // 位置评价网格的间距，0表示直接用网络
+  bool mEvaluationCheck; // 检查位置评价网格与网络的误差
+  bool mNetTrain;       // 离线训练网络，训练完后退出
+  std::string mNetTrainFile; // 训练样本文件，文本或二进制格式
+  std::string mNetModelFile; // 初始网络，训练结果也存回这里
+  int mNetBatchSize;    // 小批量的样本数，0表示在线训练
+  int mNetTrainThreads; // 训练的线程数，0表示使用所有CPU
+  double mNetValidationRatio; // 留作验证集的样本比例
+  int mNetPatience;     // 验证误差多少轮不降就停止
+  double mDribbleAngleStep; // 带球规划的方向间隔
+  double mPassClearFanAngle; // 解围时出球方向相对身体的最大偏角，180 为整圈
+  double mPassClearAngleStep; // 解围的方向间隔
+  int mDecisionSearchDepth; // 决策树搜索的步数，大于 1 时用多步搜索重新评价传球和带球
+  int mLookaheadNodeBudget; // 多步搜索每个周期最多展开的节点数
+  double mLookaheadDiscount; // 多步搜索每多一步评价的折扣
+  int mPlannerThreads;  // 并行规划的工作线程数，0为不并行
+  double mDominanceGridStep; // 控制区域网格的间距
 
   /**
    * 如果视觉部分导致超时严重，就调大这个变量，最大为1
@@ -644,14 +708,25 @@ public:
   const bool &SaveServerMessage() const { return mSaveServerMessage; }
   const bool &SaveSightLog() const { return mSaveSightLog; }
   const bool &SaveDecLog() const { return mSaveDecLog; }
+  const bool &SightLogBinary() const { return mSightLogBinary; }
+  const std::string &SightLogConvert() const { return mSightLogConvert; }
   const bool &SaveTextLog() const { return mSaveTextLog; }
   const bool &TimeTest() const { return mTimeTest; }
   const bool &NetworkTest() const { return mNetworkTest; }
+  const bool &BatchReceive() const { return mBatchReceive; }
+  const bool &InterceptCheck() const { return mInterceptCheck; }
+  const bool &HeadlessMode() const { return mHeadlessMode; }
+  const int &HeadlessCycles() const { return mHeadlessCycles; }
+  const int &HeadlessUnum() const { return mHeadlessUnum; }
+  const int &HeadlessSeed() const { return mHeadlessSeed; }
   const bool &UsePlotter() const { return mUsePlotter; }
   const bool &UseTeamGraphic() const { return mUseTeamGraphic; }
   const int &WaitSightBuffer() const { return mWaitSightBuffer; }
   const int &WaitHearBuffer() const { return mWaitHearBuffer; }
   const int &WaitTimeOut() const { return mWaitTimeOut; }
+  const bool &AnytimeDecision() const { return mAnytimeDecision; }
+  const int &DecisionDeadlineBuffer() const { return mDecisionDeadlineBuffer; }
+  const int &HistoryDepth() const { return mHistoryDepth; }
 
   const double &minAppearancePoss() const { return M_min_appearance_poss; }
 
@@ -659,6 +734,25 @@ public:
   const double &MinStamina() const { return mMinStamina; }
   const double &AtPointBuffer() const { return mAtPointBuffer; }
   const int &KickerMode() const { return mKickerMode; }
+  const int &KickerType() const { return mKickerType; }
+  const int &KickerThreads() const { return mKickerThreads; }
+  const double &EvaluationLatticeStep() const { return mEvaluationLatticeStep; }
+  const bool &EvaluationCheck() const { return mEvaluationCheck; }
+  const bool &NetTrain() const { return mNetTrain; }
+  const std::string &NetTrainFile() const { return mNetTrainFile; }
+  const std::string &NetModelFile() const { return mNetModelFile; }
+  const int &NetBatchSize() const { return mNetBatchSize; }
+  const int &NetTrainThreads() const { return mNetTrainThreads; }
+  const double &NetValidationRatio() const { return mNetValidationRatio; }
+  const int &NetPatience() const { return mNetPatience; }
+  const double &DribbleAngleStep() const { return mDribbleAngleStep; }
+  const double &PassClearFanAngle() const { return mPassClearFanAngle; }
+  const double &PassClearAngleStep() const { return mPassClearAngleStep; }
+  const int &DecisionSearchDepth() const { return mDecisionSearchDepth; }
+  const int &LookaheadNodeBudget() const { return mLookaheadNodeBudget; }
+  const double &LookaheadDiscount() const { return mLookaheadDiscount; }
+  const int &PlannerThreads() const { return mPlannerThreads; }
+  const double &DominanceGridStep() const { return mDominanceGridStep; }
 
   const double &LowStaminaPointThr() const { return mLowStaminaPointThr; }
 };
@@ -0,0 +1,164 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#include "PlayerSnapshot.h"
+#include "WorldState.h"
+#include <algorithm>
+#include <utility>
+using namespace std;
+
+namespace {
+/** 与WorldState::GetPlayerList()相同的遍历顺序：队友1，对手1，队友2，... */
+class PlayerOrder {
+public:
+  PlayerOrder() {
+    for (int i = 1; i <= TEAMSIZE; ++i) {
+      mIndex[2 * i - 2] = i;
+      mIndex[2 * i - 1] = TEAMSIZE + i;
+    }
+  }
+
+  int mIndex[2 * TEAMSIZE];
+};
+
+const PlayerOrder PLAYER_ORDER;
+
+bool Dist2Less(const pair<Unum, double> &i, const pair<Unum, double> &j) {
+  return i.second < j.second;
+}
+} // namespace
+
+PlayerSnapshot::PlayerSnapshot(WorldState *pWorldState, InfoState *pInfoState)
+    : InfoStateBase(pWorldState, pInfoState) {
+  for (int i = 0; i < ARRAY_SIZE; ++i) {
+    mX[i] = mY[i] = mVelX[i] = mVelY[i] = 0.0;
+    mBodyDir[i] = mPosConf[i] = 0.0;
+    mPosDelay[i] = 0;
+    mAlive[i] = mValid[i] = 0;
+  }
+}
+
+void PlayerSnapshot::UpdateRoutine() {
+  const BallState &ball = mpWorldState->GetBall();
+  mX[0] = ball.GetPos().X();
+  mY[0] = ball.GetPos().Y();
+  mVelX[0] = ball.GetVel().X();
+  mVelY[0] = ball.GetVel().Y();
+  mBodyDir[0] = 0.0;
+  mPosConf[0] = ball.GetPosConf();
+  mPosDelay[0] = ball.GetPosDelay();
+  mAlive[0] = 1;
+  mValid[0] = 0; //球不参与球员查询
+
+  for (int index = 1; index < OBJECT_NUM; ++index) {
+    const PlayerState &player = mpWorldState->GetPlayer(Index2Unum(index));
+    mX[index] = player.GetPos().X();
+    mY[index] = player.GetPos().Y();
+    mVelX[index] = player.GetVel().X();
+    mVelY[index] = player.GetVel().Y();
+    mBodyDir[index] = player.GetBodyDir();
+    mPosConf[index] = player.GetPosConf();
+    mPosDelay[index] = player.GetPosDelay();
+    mAlive[index] = player.IsAlive();
+    mValid[index] = player.IsAlive() && player.GetPosConf() > FLOAT_EPS;
+  }
+}
+
+void PlayerSnapshot::GetDist2ToPoint(double x, double y, double *dist2) const {
+  for (int i = 0; i < ARRAY_SIZE; ++i) {
+    const double dx = mX[i] - x;
+    const double dy = mY[i] - y;
+    dist2[i] = dx * dx + dy * dy;
+  }
+}
+
+void PlayerSnapshot::GetDistToPoint(double x, double y, double *dist) const {
+  GetDist2ToPoint(x, y, dist);
+  for (int i = 0; i < ARRAY_SIZE; ++i) {
+    dist[i] = Sqrt(dist[i]);
+  }
+}
+
+vector<Unum> PlayerSnapshot::GetNearest(const Vector &point, int k,
+                                        Unum exclude_unum) const {
+  double dist2[ARRAY_SIZE];
+  GetDist2ToPoint(point.X(), point.Y(), dist2);
+
+  const int exclude = exclude_unum == 0 ? -1 : Unum2Index(exclude_unum);
+
+  pair<Unum, double> tmp[2 * TEAMSIZE];
+  int n = 0;
+  for (int i = 0; i < 2 * TEAMSIZE; ++i) {
+    const int index = PLAYER_ORDER.mIndex[i];
+    if (mValid[index] && index != exclude) {
+      tmp[n++] = pair<Unum, double>(Index2Unum(index), dist2[index]);
+    }
+  }
+
+  if (k < 0 || k >= n) {
+    k = n;
+    sort(tmp, tmp + n, Dist2Less);
+  } else {
+    partial_sort(tmp, tmp + k, tmp + n, Dist2Less);
+  }
+
+  vector<Unum> ret(k);
+  for (int i = 0; i < k; ++i) {
+    ret[i] = tmp[i].first;
+  }
+  return ret;
+}
+
+vector<Unum> PlayerSnapshot::GetWithinRadius(const Vector &point,
+                                             double radius,
+                                             Unum exclude_unum) const {
+  double dist2[ARRAY_SIZE];
+  GetDist2ToPoint(point.X(), point.Y(), dist2);
+
+  const int exclude = exclude_unum == 0 ? -1 : Unum2Index(exclude_unum);
+  const double radius2 = radius * radius;
+
+  pair<Unum, double> tmp[2 * TEAMSIZE];
+  int n = 0;
+  for (int i = 0; i < 2 * TEAMSIZE; ++i) {
+    const int index = PLAYER_ORDER.mIndex[i];
+    if (mValid[index] && index != exclude && dist2[index] < radius2) {
+      tmp[n++] = pair<Unum, double>(Index2Unum(index), dist2[index]);
+    }
+  }
+  sort(tmp, tmp + n, Dist2Less);
+
+  vector<Unum> ret(n);
+  for (int i = 0; i < n; ++i) {
+    ret[i] = tmp[i].first;
+  }
+  return ret;
+}
@@ -0,0 +1,110 @@
+/************************************************************************************
+ * WrightEagle (Soccer Simulation League 2D) * BASE SOURCE CODE RELEASE 2016 *
+ * Copyright (c) 1998-2016 WrightEagle 2D Soccer Simulation Team, * Multi-Agent
+ *Systems Lab.,                                * School of Computer Science and
+ *Technology,               * University of Science and Technology of China *
+ * All rights reserved. *
+ *                                                                                  *
+ * Redistribution and use in source and binary forms, with or without *
+ * modification, are permitted provided that the following conditions are met: *
+ *     * Redistributions of source code must retain the above copyright *
+ *       notice, this list of conditions and the following disclaimer. *
+ *     * Redistributions in binary form must reproduce the above copyright *
+ *       notice, this list of conditions and the following disclaimer in the *
+ *       documentation and/or other materials provided with the distribution. *
+ *     * Neither the name of the WrightEagle 2D Soccer Simulation Team nor the *
+ *       names of its contributors may be used to endorse or promote products *
+ *       derived from this software without specific prior written permission. *
+ *                                                                                  *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *AND  * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *IMPLIED    * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ *PURPOSE ARE           * DISCLAIMED. IN NO EVENT SHALL WrightEagle 2D Soccer
+ *Simulation Team BE LIABLE    * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ *EXEMPLARY, OR CONSEQUENTIAL       * DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ *PROCUREMENT OF SUBSTITUTE GOODS OR       * SERVICES; LOSS OF USE, DATA, OR
+ *PROFITS; OR BUSINESS INTERRUPTION) HOWEVER       * CAUSED AND ON ANY THEORY OF
+ *LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,    * OR TORT (INCLUDING
+ *NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF * THIS SOFTWARE,
+ *EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.                *
+ ************************************************************************************/
+
+#ifndef __PlayerSnapshot_H__
+#define __PlayerSnapshot_H__
+
+#include "InfoState.h"
+#include <vector>
+
+/**
+ * 每周期一次性把球和22名球员的状态按分量存成连续数组，供各种距离查询使用
+ * 下标与PositionInfo的距离矩阵一致：0为球，1-11为队友，12-22为对手
+ * Structure-of-arrays snapshot of the ball and all players. Queries run over
+ * fixed-size contiguous arrays so the compiler can vectorize them.
+ */
+class PlayerSnapshot : public InfoStateBase {
+public:
+  PlayerSnapshot(WorldState *pWorldState, InfoState *pInfoState);
+
+  enum {
+    OBJECT_NUM = 1 + 2 * TEAMSIZE,
+    ARRAY_SIZE = (OBJECT_NUM + 3) & ~3 /** 补齐到4的倍数，方便向量化 */
+  };
+
+  /** 数组下标和球员号码之间的相互转化，球员号码正表示队友，负表示对手 */
+  static int Unum2Index(Unum unum) { return unum > 0 ? unum : TEAMSIZE - unum; }
+  static Unum Index2Unum(int index) {
+    return index <= TEAMSIZE ? index : TEAMSIZE - index;
+  }
+
+  const double *GetX() const { return mX; }
+  const double *GetY() const { return mY; }
+  const double *GetVelX() const { return mVelX; }
+  const double *GetVelY() const { return mVelY; }
+  const double *GetBodyDir() const { return mBodyDir; }
+  const double *GetPosConf() const { return mPosConf; }
+  const int *GetPosDelay() const { return mPosDelay; }
+
+  bool IsAlive(int index) const { return mAlive[index] != 0; }
+
+  /** 活着且位置可信（conf > FLOAT_EPS）的球员 */
+  bool IsValid(int index) const { return mValid[index] != 0; }
+
+  /**
+   * 所有对象到点(x, y)的距离平方，写入dist2[ARRAY_SIZE]
+   */
+  void GetDist2ToPoint(double x, double y, double *dist2) const;
+
+  /**
+   * 所有对象到点(x, y)的距离，写入dist[ARRAY_SIZE]
+   */
+  void GetDistToPoint(double x, double y, double *dist) const;
+
+  /**
+   * 按到点的距离从近到远得到最多k个有效球员，k < 0表示全部
+   * @param exclude_unum 排除的球员，通常是自己
+   */
+  std::vector<Unum> GetNearest(const Vector &point, int k = -1,
+                               Unum exclude_unum = 0) const;
+
+  /**
+   * 得到到点的距离小于radius的有效球员，按距离从近到远排列
+   */
+  std::vector<Unum> GetWithinRadius(const Vector &point, double radius,
+                                    Unum exclude_unum = 0) const;
+
+private:
+  void UpdateRoutine();
+
+private:
+  double mX[ARRAY_SIZE];
+  double mY[ARRAY_SIZE];
+  double mVelX[ARRAY_SIZE];
+  double mVelY[ARRAY_SIZE];
+  double mBodyDir[ARRAY_SIZE];
+  double mPosConf[ARRAY_SIZE];
+  int mPosDelay[ARRAY_SIZE];
+  char mAlive[ARRAY_SIZE];
+  char mValid[ARRAY_SIZE];
+};
+
+#endif
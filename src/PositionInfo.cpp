@@ -30,6 +30,8 @@
  ************************************************************************************/
 
 #include "PositionInfo.h"
+#include "PlayerSnapshot.h"
+#include "TimeTest.h"
 #include "Utilities.h"
 #include "WorldState.h"
 #include <algorithm>
@@ -39,9 +41,11 @@ using namespace std;
 
 PositionInfo::PositionInfo(WorldState *pWorldState, InfoState *pInfoState)
     : InfoStateBase(pWorldState, pInfoState),
-      mPlayerWithBallList_UpdateTime(Time(-3, 0)) {}
+      mPlayerWithBallList_UpdateTime(Time(-3, 0)), mIsFrozen(false) {}
 
 void PositionInfo::UpdateRoutine() {
+  TIMETEST("PositionInfo");
+
   UpdateDistMatrix();
   UpdateOffsideLine();
   UpdateOppGoalInfo();
@@ -59,6 +63,28 @@ void PositionInfo::UpdateRoutine() {
 
   mXSortTeammateList.clear();
   mXSortOpponentList.clear();
+
+  mIsFrozen = false;
+}
+
+void PositionInfo::Freeze() {
+  if (mIsFrozen) {
+    return;
+  }
+
+  GetCloseTeammateToBall();
+  GetCloseOpponentToBall();
+  for (Unum i = -TEAMSIZE; i <= TEAMSIZE; ++i) {
+    if (i != 0) {
+      GetCloseTeammateToPlayer(i);
+      GetCloseOpponentToPlayer(i);
+    }
+  }
+  GetPlayerWithBallList();
+  GetXSortTeammate();
+  GetXSortOpponent();
+
+  mIsFrozen = true;
 }
 
 void PositionInfo::UpdateDistMatrix() {
@@ -73,36 +99,33 @@ void PositionInfo::UpdateDistMatrix() {
     mOpponentDir2Ball[i] = 0.0;
   }
 
-  const vector<PlayerState *> &player_list = mpWorldState->GetPlayerList();
+  const PlayerSnapshot &snapshot = mpInfoState->GetPlayerSnapshot();
+  const double *x = snapshot.GetX();
+  const double *y = snapshot.GetY();
+  double dist[PlayerSnapshot::ARRAY_SIZE];
 
-  for (vector<PlayerState *>::const_iterator it = player_list.begin();
-       it != player_list.end(); ++it) {
-    if ((*it)->IsAlive()) {
-      int index = Unum2Index((*it)->GetUnum());
-      Vector rel_pos = (*it)->GetPos() - mpWorldState->GetBall().GetPos();
-      mDistMatrix[0][index] = rel_pos.Mod();
+  snapshot.GetDistToPoint(x[0], y[0], dist);
+  for (int index = 1; index < 1 + 2 * TEAMSIZE; ++index) {
+    if (snapshot.IsAlive(index)) {
+      mDistMatrix[0][index] = dist[index];
       mDistMatrix[index][index] = 0.0;
 
       // 更新球员相对于球的角度
-      if ((*it)->GetUnum() > 0) {
-        mTeammateDir2Ball[(*it)->GetUnum() - 1] = rel_pos.Dir();
+      AngleDeg dir = ATan2(y[index] - y[0], x[index] - x[0]);
+      if (index <= TEAMSIZE) {
+        mTeammateDir2Ball[index - 1] = dir;
       } else {
-        mOpponentDir2Ball[-(*it)->GetUnum() - 1] = rel_pos.Dir();
+        mOpponentDir2Ball[index - TEAMSIZE - 1] = dir;
       }
     }
   }
 
-  const uint player_list_size = player_list.size();
-  for (unsigned int i = 0; i < player_list_size; ++i) {
-    const PlayerState *pi = player_list[i];
-    if (pi->IsAlive()) {
-      for (unsigned int j = i + 1; j < player_list_size; ++j) {
-        const PlayerState *pj = player_list[j];
-        if (pj->IsAlive()) {
-          int index1 = Unum2Index(pi->GetUnum());
-          int index2 = Unum2Index(pj->GetUnum());
-          mDistMatrix[index1][index2] = mDistMatrix[index2][index1] =
-              pi->GetPos().Dist(pj->GetPos());
+  for (int i = 1; i < 1 + 2 * TEAMSIZE; ++i) {
+    if (snapshot.IsAlive(i)) {
+      snapshot.GetDistToPoint(x[i], y[i], dist);
+      for (int j = 1; j < 1 + 2 * TEAMSIZE; ++j) {
+        if (j != i && snapshot.IsAlive(j)) {
+          mDistMatrix[i][j] = dist[j];
         }
       }
     }
@@ -224,13 +247,13 @@ void PositionInfo::UpdateOppGoalInfo() {
 }
 
 const list<KeyPlayerInfo> &PositionInfo::GetXSortTeammate() {
-  if (mXSortTeammateList.empty()) {
+  if (!mIsFrozen && mXSortTeammateList.empty()) {
+    const PlayerSnapshot &snapshot = mpInfoState->GetPlayerSnapshot();
     KeyPlayerInfo kp;
     for (int i = 1; i <= TEAMSIZE; i++) {
-      if (mpWorldState->GetTeammate(i).IsAlive() == true &&
-          mpWorldState->GetTeammate(i).GetPosConf() > FLOAT_EPS) {
+      if (snapshot.IsValid(Unum2Index(i))) {
         kp.mUnum = i;
-        kp.mValue = mpWorldState->GetTeammate(i).GetPos().X();
+        kp.mValue = snapshot.GetX()[Unum2Index(i)];
         mXSortTeammateList.push_back(kp);
       }
     }
@@ -240,13 +263,13 @@ const list<KeyPlayerInfo> &PositionInfo::GetXSortTeammate() {
 }
 
 const list<KeyPlayerInfo> &PositionInfo::GetXSortOpponent() {
-  if (mXSortOpponentList.empty()) {
+  if (!mIsFrozen && mXSortOpponentList.empty()) {
+    const PlayerSnapshot &snapshot = mpInfoState->GetPlayerSnapshot();
     KeyPlayerInfo kp;
     for (int i = 1; i <= TEAMSIZE; i++) {
-      if (mpWorldState->GetOpponent(i).IsAlive() == true &&
-          mpWorldState->GetOpponent(i).GetPosConf() > FLOAT_EPS) {
+      if (snapshot.IsValid(Unum2Index(-i))) {
         kp.mUnum = i;
-        kp.mValue = mpWorldState->GetOpponent(i).GetPos().X();
+        kp.mValue = snapshot.GetX()[Unum2Index(-i)];
         mXSortOpponentList.push_back(kp);
       }
     }
@@ -320,38 +343,19 @@ AngleDeg PositionInfo::GetShootAngle(AngleDeg left, AngleDeg right,
 vector<Unum>
 PositionInfo::GetClosePlayerToPoint(const Vector &bp,
                                     const Unum &exclude_unum) const {
-  vector<pair<Unum, double>> tmp;
-
-  for (vector<PlayerState *>::const_iterator it =
-           mpWorldState->GetPlayerList().begin();
-       it != mpWorldState->GetPlayerList().end(); ++it) {
-    if ((*it)->IsAlive() && (*it)->GetPosConf() > FLOAT_EPS &&
-        (*it)->GetUnum() != exclude_unum) { // 算距离自己的球员时把自己排除掉
-      tmp.push_back(
-          pair<Unum, double>((*it)->GetUnum(), (*it)->GetPos().Dist2(bp)));
-    }
-  }
-
-  sort(tmp.begin(), tmp.end(), PlayerDistCompare());
-
-  vector<Unum> ret;
-  for (vector<pair<Unum, double>>::iterator it = tmp.begin(); it != tmp.end();
-       ++it) {
-    ret.push_back(it->first);
-  }
-
-  return ret;
+  // 算距离自己的球员时把自己排除掉
+  return mpInfoState->GetPlayerSnapshot().GetNearest(bp, -1, exclude_unum);
 }
 
 const vector<Unum> &PositionInfo::GetClosePlayerToBall() {
-  if (mPlayer2BallList.empty()) {
+  if (!mIsFrozen && mPlayer2BallList.empty()) {
     mPlayer2BallList = GetClosePlayerToPoint(mpWorldState->GetBall().GetPos());
   }
   return mPlayer2BallList;
 }
 
 const vector<Unum> &PositionInfo::GetCloseTeammateToBall() {
-  if (mTeammate2BallList.empty()) {
+  if (!mIsFrozen && mTeammate2BallList.empty()) {
     const vector<Unum> &player2ball = GetClosePlayerToBall();
     for (vector<Unum>::const_iterator it = player2ball.begin();
          it != player2ball.end(); ++it) {
@@ -364,7 +368,7 @@ const vector<Unum> &PositionInfo::GetCloseTeammateToBall() {
 }
 
 const vector<Unum> &PositionInfo::GetCloseOpponentToBall() {
-  if (mOpponent2BallList.empty()) {
+  if (!mIsFrozen && mOpponent2BallList.empty()) {
     const vector<Unum> &player2ball = GetClosePlayerToBall();
     for (vector<Unum>::const_iterator it = player2ball.begin();
          it != player2ball.end(); ++it) {
@@ -391,7 +395,7 @@ vector<Unum> PositionInfo::GetCloseOpponentToPoint(const Vector &bp) {
 
 const vector<Unum> &PositionInfo::GetClosePlayerToPlayer(Unum i) {
   int index = Unum2Index(i);
-  if (mPlayer2PlayerList[index].empty()) {
+  if (!mIsFrozen && mPlayer2PlayerList[index].empty()) {
     mPlayer2PlayerList[index] =
         GetClosePlayerToPoint(mpWorldState->GetPlayer(i).GetPos(), i);
   }
@@ -400,7 +404,7 @@ const vector<Unum> &PositionInfo::GetClosePlayerToPlayer(Unum i) {
 
 const vector<Unum> &PositionInfo::GetCloseTeammateToPlayer(Unum i) {
   int index = Unum2Index(i);
-  if (mTeammate2PlayerList[index].empty()) {
+  if (!mIsFrozen && mTeammate2PlayerList[index].empty()) {
     const vector<Unum> &player2player = GetClosePlayerToPlayer(i);
     for (vector<Unum>::const_iterator it = player2player.begin();
          it != player2player.end(); ++it) {
@@ -414,7 +418,7 @@ const vector<Unum> &PositionInfo::GetCloseTeammateToPlayer(Unum i) {
 
 const vector<Unum> &PositionInfo::GetCloseOpponentToPlayer(Unum i) {
   int index = Unum2Index(i);
-  if (mOpponent2PlayerList[index].empty()) {
+  if (!mIsFrozen && mOpponent2PlayerList[index].empty()) {
     const vector<Unum> &player2player = GetClosePlayerToPlayer(i);
     for (vector<Unum>::const_iterator it = player2player.begin();
          it != player2player.end(); ++it) {
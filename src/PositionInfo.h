@@ -47,6 +47,11 @@ class PositionInfo : public InfoStateBase {
 public:
   PositionInfo(WorldState *pWorldState, InfoState *pInfoState);
 
+  /**
+   * 一次性算出本周期所有按需计算的列表，之后各个get只读，可供多线程共享
+   */
+  void Freeze();
+
   const double &GetBallDistToPlayer(Unum unum) const;
   const double &GetPlayerDistToPlayer(Unum unum1, Unum unum2) const;
   const double &GetBallDistToTeammate(Unum unum) const {
@@ -283,14 +288,9 @@ private:
       mPlayerWithBallList; //当前可以踢球的队员集合 -- 不加buffer的判断
   Time mPlayerWithBallList_UpdateTime;
 
+  bool mIsFrozen; // 本周期的列表已经全部算出，空列表也不再重算
+
 private:
-  class PlayerDistCompare {
-  public:
-    bool operator()(const std::pair<Unum, double> &i,
-                    const std::pair<Unum, double> &j) {
-      return i.second < j.second;
-    }
-  };
   class PlayerDirCompare {
   public:
     bool operator()(const std::pair<Unum, double> &i,
@@ -167,9 +167,16 @@ bool Tackler::GetTackleInfoToDir(const Agent &agent, AngleDeg dir,
   bool ret = false;
 
   for (int j = 0; j < 3; ++j) {
-    for (uint i = 0; i < mDirMap[dir_idx[j]].size(); ++i) {
-      const int angle_idx1 = mDirMap[dir_idx[j]][i].first;
-      const int angle_idx2 = mDirMap[dir_idx[j]][i].second;
+    //用find而不是[]，不往mDirMap里插空项，这样并行规划时只读
+    std::map<int, std::vector<std::pair<int, int>>>::const_iterator it =
+        mDirMap.find(dir_idx[j]);
+    if (it == mDirMap.end()) {
+      continue;
+    }
+
+    for (uint i = 0; i < it->second.size(); ++i) {
+      const int angle_idx1 = it->second[i].first;
+      const int angle_idx2 = it->second[i].second;
 
       AngleDeg dir1 = mBallVelAfterTackle[angle_idx1].Dir();
       AngleDeg dir2 = mBallVelAfterTackle[angle_idx2].Dir();
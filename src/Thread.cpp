@@ -59,6 +59,16 @@ void ThreadMutex::Lock() { WaitForSingleObject(mEvent, 50); }
 
 void ThreadMutex::UnLock() { ReleaseMutex(mEvent); }
 
+ThreadSemaphore::ThreadSemaphore() {
+  mSemaphore = CreateSemaphore(0, 0, 0x7fffffff, 0);
+}
+
+ThreadSemaphore::~ThreadSemaphore() { CloseHandle(mSemaphore); }
+
+void ThreadSemaphore::Wait() { WaitForSingleObject(mSemaphore, INFINITE); }
+
+void ThreadSemaphore::Post() { ReleaseSemaphore(mSemaphore, 1, 0); }
+
 #else
 
 ThreadCondition::ThreadCondition() {
@@ -115,6 +125,37 @@ void ThreadMutex::UnLock() {
   while (pthread_mutex_unlock(&mMutex)) {
   }
 }
+
+ThreadSemaphore::ThreadSemaphore() : mCount(0) {
+  pthread_mutex_init(&mMutex, 0);
+  pthread_cond_init(&mCond, 0);
+}
+
+ThreadSemaphore::~ThreadSemaphore() {
+  pthread_mutex_destroy(&mMutex);
+  pthread_cond_destroy(&mCond);
+}
+
+void ThreadSemaphore::Wait() {
+  while (pthread_mutex_lock(&mMutex)) {
+  }
+  while (mCount == 0) {
+    pthread_cond_wait(&mCond, &mMutex);
+  }
+  --mCount;
+  while (pthread_mutex_unlock(&mMutex)) {
+  }
+}
+
+void ThreadSemaphore::Post() {
+  while (pthread_mutex_lock(&mMutex)) {
+  }
+  ++mCount;
+  while (pthread_cond_signal(&mCond)) {
+  }
+  while (pthread_mutex_unlock(&mMutex)) {
+  }
+}
 #endif
 
 void *Thread::Spawner(void *thread) {
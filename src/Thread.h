@@ -73,6 +73,24 @@ private:
   HANDLE mEvent;
 };
 
+class ThreadSemaphore {
+public:
+  /**
+   * 构造函数和析构函数
+   */
+  ThreadSemaphore();
+  ~ThreadSemaphore();
+
+  /**
+   * 计数信号量，Post不会像ThreadCondition::Set那样丢失
+   */
+  void Wait();
+  void Post();
+
+private:
+  HANDLE mSemaphore;
+};
+
 #else
 
 #include <errno.h>
@@ -119,6 +137,26 @@ public:
 private:
   pthread_mutex_t mMutex;
 };
+
+class ThreadSemaphore {
+public:
+  /**
+   * 构造函数和析构函数
+   */
+  ThreadSemaphore();
+  ~ThreadSemaphore();
+
+  /**
+   * 计数信号量，Post不会像ThreadCondition::Set那样丢失
+   */
+  void Wait();
+  void Post();
+
+private:
+  pthread_cond_t mCond;
+  pthread_mutex_t mMutex;
+  int mCount;
+};
 #endif
 
 class Thread {
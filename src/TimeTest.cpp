@@ -31,16 +31,89 @@
 
 #include "TimeTest.h"
 #include "PlayerParam.h"
+#include "ServerParam.h"
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
+
+#ifdef WIN32
+#define TIMETEST_THREAD_LOCAL __declspec(thread)
+#else
+#define TIMETEST_THREAD_LOCAL __thread
+#endif
+
+/**
+ * 一个线程在一条记录上的累计耗时，只由这个线程写。mCost和mCalls只增不减，
+ * 结算时与上次合并的值相减得到本周期的部分，所以合并不需要清零，也不需要锁
+ * One thread's running totals for one record, written only by that thread.
+ * The totals never reset; merging takes the difference to the last merge.
+ */
+struct TimeThreadRecord {
+  TimeCost mEachTime;
+  long mCost;
+  long mCalls;
+
+  long mMergedCost; // 上次合并时的mCost，只由合并的线程写
+  long mMergedCalls;
+};
+
+/**
+ * 一个线程的记录槽，第一次计时时建立，之后一直存在（线程可能在TimeTest析构
+ * 之后还在运行，所以不释放）
+ * Record slots of one thread, created on its first scope and never freed.
+ */
+struct TimeThreadSlot {
+  TimeThreadSlot() {
+    memset(mChildRecord, 0, sizeof(mChildRecord));
+    for (int i = 0; i < TimeTest::MAX_RECORDS; ++i) {
+      mRecords[i].mCost = 0;
+      mRecords[i].mCalls = 0;
+      mRecords[i].mMergedCost = 0;
+      mRecords[i].mMergedCalls = 0;
+    }
+  }
+
+  TimeThreadRecord mRecords[TimeTest::MAX_RECORDS];
+  // [外层+1][测试]，存记录编号+1，0表示本线程还没查过
+  int mChildRecord[TimeTest::MAX_RECORDS + 1][TimeTest::MAX_EVENTS];
+};
+
+namespace {
+/**
+ * 每个线程各自的测试嵌套栈、开始时间和记录槽，各线程互不干扰
+ * Per-thread stack of open scopes, their begin times and the record slots.
+ */
+TIMETEST_THREAD_LOCAL int scope_stack[TimeTest::MAX_EVENTS];
+TIMETEST_THREAD_LOCAL int scope_event[TimeTest::MAX_EVENTS];
+TIMETEST_THREAD_LOCAL timeval scope_begin[TimeTest::MAX_EVENTS];
+TIMETEST_THREAD_LOCAL int scope_depth = 0;
+TIMETEST_THREAD_LOCAL TimeThreadSlot *thread_slot = 0;
+
+long Percentile(std::vector<long> costs, const double p) {
+  if (costs.empty()) {
+    return 0;
+  }
+  const unsigned idx = std::min(static_cast<unsigned>(costs.size() - 1),
+                                static_cast<unsigned>(p * costs.size()));
+  std::nth_element(costs.begin(), costs.begin() + idx, costs.end());
+  return costs[idx];
+}
+} // namespace
 
 /**
  * Constructor.
  */
 TimeTest::TimeTest() {
-  mEventQueue.clear();
-  mRecordQueue.clear();
-  mIsExecute.clear();
-  mIsBegin.clear();
+  mEventCount = 0;
+  mRecordCount = 0;
+  for (int i = 0; i <= MAX_RECORDS; ++i) {
+    for (int j = 0; j < MAX_EVENTS; ++j) {
+      mChildRecord[i][j] = -1;
+    }
+  }
+  mRingHead = 0;
+  mRingFull = false;
+  mOverBudgetCount = 0;
 
   mUpdateTime = Time(-3, 0);
   mUnum = 0;
@@ -50,48 +123,22 @@ TimeTest::TimeTest() {
  * Destructor, which will write all records to files.
  */
 TimeTest::~TimeTest() {
-  if (mEventQueue.size() == 0 || mEventQueue.size() != mRecordQueue.size()) {
-    return;
+  mRecordMutex.Lock();
+  MergeThreadSlots();
+  bool executed = false;
+  for (int i = 0; i < mRecordCount; ++i) {
+    executed = executed || mRecords[i].mEachTime.mNum > 0;
   }
-
-  char *file_name = new char[256];
-  std::ofstream out_file;
-  TimeCost *pTimeCost;
-
-  for (unsigned i = 0; i < mEventQueue.size(); ++i) {
-    sprintf(file_name, "Test/TimeTest-%s-%d.txt", mEventQueue[i].data(), mUnum);
-    out_file.open(file_name);
-    if (out_file.good() == false) {
-      PRINT_ERROR("open file error  " << file_name);
-      continue;
-    }
-
-    out_file << mEventQueue[i].data() << std::endl;
-
-    pTimeCost = &(mRecordQueue[i].mEachTime);
-    out_file << std::endl << std::endl;
-    out_file << "Time cost for each time: " << std::endl;
-    out_file << "Num: " << pTimeCost->mNum << std::endl;
-    out_file << "Ave: " << pTimeCost->mAveCost / 1000.0 << " ms" << std::endl;
-    out_file << "Max: " << pTimeCost->mMaxCost / 1000.0 << " ms  "
-             << pTimeCost->mMaxTime << std::endl;
-    out_file << "Min: " << pTimeCost->mMinCost / 1000.0 << " ms  "
-             << pTimeCost->mMinTime << std::endl;
-
-    pTimeCost = &(mRecordQueue[i].mEachCycle);
-    out_file << std::endl << std::endl;
-    out_file << "Time cost for each cycle: " << std::endl;
-    out_file << "Num: " << pTimeCost->mNum << std::endl;
-    out_file << "Ave: " << pTimeCost->mAveCost / 1000.0 << " ms" << std::endl;
-    out_file << "Max: " << pTimeCost->mMaxCost / 1000.0 << " ms  "
-             << pTimeCost->mMaxTime << std::endl;
-    out_file << "Min: " << pTimeCost->mMinCost / 1000.0 << " ms  "
-             << pTimeCost->mMinTime << std::endl;
-
-    out_file.close();
+  if (executed) {
+    CloseCycle();
+  }
+  mRecordMutex.UnLock();
+  if (!executed) {
+    return;
   }
 
-  delete[] file_name;
+  WriteReport();
+  WriteRing();
 }
 
 /**
@@ -114,97 +161,427 @@ void TimeTest::Update(Time current_time) {
       return;
     }
 
-    long last_num = 0;
-    double last_ave_cost = 0;
-    long cycle_time_cost = 0;
-    for (unsigned i = 0; i < mEventQueue.size(); ++i) {
-      if (mIsExecute[i] == false) {
+    mRecordMutex.Lock();
+    MergeThreadSlots();
+    CloseCycle();
+    mUpdateTime = current_time;
+    mRecordMutex.UnLock();
+  }
+}
+
+/**
+ * 把各线程槽里自上次合并以来的耗时加到本周期，并重新汇总每次调用的统计。
+ * 要在mRecordMutex下调用。其他线程可能正在写自己的槽，这时这一次调用会算到
+ * 下一个周期
+ * Fold what each thread timed since the last merge into the current cycle.
+ * Called under mRecordMutex; a scope ending concurrently lands in the next
+ * cycle.
+ */
+void TimeTest::MergeThreadSlots() {
+  for (int i = 0; i < mRecordCount; ++i) {
+    mRecords[i].mEachTime = TimeCost();
+  }
+
+  for (unsigned k = 0; k < mThreadSlots.size(); ++k) {
+    TimeThreadSlot &slot = *mThreadSlots[k];
+    for (int i = 0; i < mRecordCount; ++i) {
+      TimeThreadRecord &thread_record = slot.mRecords[i];
+      const long calls = thread_record.mCalls;
+      if (calls == 0) {
         continue;
       }
+      const long cost = thread_record.mCost;
 
-      last_num = mRecordQueue[i].mEachCycle.mNum;
-      last_ave_cost = mRecordQueue[i].mEachCycle.mAveCost;
-      cycle_time_cost = mRecordQueue[i].mCycleTimeCost;
+      TimeRecord &record = mRecords[i];
+      record.mCycleTimeCost += cost - thread_record.mMergedCost;
+      record.mCycleCalls += calls - thread_record.mMergedCalls;
+      if (calls > thread_record.mMergedCalls) {
+        record.mIsExecute = true;
+      }
+      thread_record.mMergedCost = cost;
+      thread_record.mMergedCalls = calls;
 
-      if (cycle_time_cost > mRecordQueue[i].mEachCycle.mMaxCost) {
-        mRecordQueue[i].mEachCycle.mMaxCost = cycle_time_cost;
-        mRecordQueue[i].mEachCycle.mMaxTime = mUpdateTime;
+      const TimeCost &thread_time = thread_record.mEachTime;
+      TimeCost &each_time = record.mEachTime;
+      if (thread_time.mNum == 0) {
+        continue;
       }
-      if (cycle_time_cost < mRecordQueue[i].mEachCycle.mMinCost) {
-        mRecordQueue[i].mEachCycle.mMinCost = cycle_time_cost;
-        mRecordQueue[i].mEachCycle.mMinTime = mUpdateTime;
+      if (thread_time.mMaxCost > each_time.mMaxCost) {
+        each_time.mMaxCost = thread_time.mMaxCost;
+        each_time.mMaxTime = thread_time.mMaxTime;
       }
+      if (thread_time.mMinCost < each_time.mMinCost) {
+        each_time.mMinCost = thread_time.mMinCost;
+        each_time.mMinTime = thread_time.mMinTime;
+      }
+      each_time.mAveCost = (each_time.mAveCost * each_time.mNum +
+                            thread_time.mAveCost * thread_time.mNum) /
+                           (each_time.mNum + thread_time.mNum);
+      each_time.mNum += thread_time.mNum;
+    }
+  }
+}
+
+/**
+ * 结算上一个周期：每周期统计，分位数历史，环形缓冲区和超时检查
+ * Close the cycle labelled mUpdateTime.
+ */
+void TimeTest::CloseCycle() {
+  if (mRing.empty()) {
+    mRing.resize(RING_SIZE);
+  }
 
-      mRecordQueue[i].mEachCycle.mAveCost =
-          (last_ave_cost * last_num + cycle_time_cost) / (last_num + 1);
-      ++mRecordQueue[i].mEachCycle.mNum;
-      mRecordQueue[i].mCycleTimeCost = 0;
-      mIsExecute[i] = false;
+  long root_cost = 0;
+  for (int i = 0; i < mRecordCount; ++i) {
+    TimeRecord &record = mRecords[i];
+    if (record.mIsExecute == false) {
+      continue;
     }
 
-    mUpdateTime = current_time;
+    const long cycle_time_cost = record.mCycleTimeCost;
+    TimeCost &each_cycle = record.mEachCycle;
+
+    if (cycle_time_cost > each_cycle.mMaxCost) {
+      each_cycle.mMaxCost = cycle_time_cost;
+      each_cycle.mMaxTime = mUpdateTime;
+    }
+    if (cycle_time_cost < each_cycle.mMinCost) {
+      each_cycle.mMinCost = cycle_time_cost;
+      each_cycle.mMinTime = mUpdateTime;
+    }
+
+    if (record.mCycleCosts.size() < CYCLE_HISTORY) {
+      record.mCycleCosts.push_back(cycle_time_cost);
+    } else {
+      record.mCycleCosts[each_cycle.mNum % CYCLE_HISTORY] = cycle_time_cost;
+    }
+
+    each_cycle.mAveCost = (each_cycle.mAveCost * each_cycle.mNum +
+                           cycle_time_cost) /
+                          (each_cycle.mNum + 1);
+    ++each_cycle.mNum;
+
+    TimeSample &sample = mRing[mRingHead];
+    sample.mCycle = mUpdateTime.T();
+    sample.mStopTime = mUpdateTime.S();
+    sample.mEventID = i;
+    sample.mCalls = record.mCycleCalls;
+    sample.mCost = cycle_time_cost;
+    if (++mRingHead == RING_SIZE) {
+      mRingHead = 0;
+      mRingFull = true;
+    }
+
+    if (record.mParent < 0) {
+      root_cost += cycle_time_cost;
+    }
+  }
+
+  if (root_cost > ServerParam::instance().simStep() * 1000) {
+    ++mOverBudgetCount;
+
+    if (static_cast<int>(mOverBudget.size()) < MAX_OVER_BUDGET_RECORDS) {
+      // 从最外层开始，每层取耗时最多的那个，得到最耗时的路径
+      OverBudget over;
+      over.mTime = mUpdateTime;
+      over.mCost = root_cost;
+      over.mPathCost = 0;
+
+      int parent = -1;
+      while (true) {
+        int slowest = -1;
+        for (int i = 0; i < mRecordCount; ++i) {
+          if (mRecords[i].mIsExecute && mRecords[i].mParent == parent &&
+              (slowest < 0 || mRecords[i].mCycleTimeCost >
+                                  mRecords[slowest].mCycleTimeCost)) {
+            slowest = i;
+          }
+        }
+        if (slowest < 0) {
+          break;
+        }
+        if (!over.mPath.empty()) {
+          over.mPath += "/";
+        }
+        over.mPath += mRecords[slowest].mName;
+        over.mPathCost = mRecords[slowest].mCycleTimeCost;
+        parent = slowest;
+      }
+
+      mOverBudget.push_back(over);
+    }
+  }
+
+  for (int i = 0; i < mRecordCount; ++i) {
+    mRecords[i].mCycleTimeCost = 0;
+    mRecords[i].mCycleCalls = 0;
+    mRecords[i].mIsExecute = false;
   }
 }
 
 /**
- * 每次测试的开始
- * Begin of each test.
- * \param func_name name of the function which will be tested.
- * \return event ID.
+ * 按名字注册一个测试
+ * Register a scope by name.
+ * \param func_name name of the scope.
+ * \return event ID, -1 if there are too many scopes.
  */
-int TimeTest::Begin(std::string func_name) {
+int TimeTest::Register(const char *func_name) {
+  mRegisterMutex.Lock();
+
   int i = 0;
-  if (PlayerParam::instance().TimeTest()) {
-    for (; i < (int)mEventQueue.size(); ++i) {
-      if (mEventQueue[i] == func_name) {
-        break;
-      }
+  for (; i < mEventCount; ++i) {
+    if (mEventNames[i] == func_name) {
+      break;
     }
+  }
 
-    if (i == (int)mEventQueue.size()) {
-      TimeRecord time_record;
-      mEventQueue.push_back(func_name);
-      mRecordQueue.push_back(time_record);
-      mIsExecute.push_back(false);
-      mIsBegin.push_back(true);
-      mRecordQueue[i].mBeginTime = GetRealTime();
-    } else if (mIsBegin[i] == false) {
-      mIsBegin[i] = true;
-      mRecordQueue[i].mBeginTime = GetRealTime();
+  if (i == mEventCount) {
+    if (mEventCount < MAX_EVENTS) {
+      mEventNames[i] = func_name;
+      ++mEventCount;
     } else {
+      PRINT_ERROR("too many time test events: " << func_name);
       i = -1;
     }
   }
+
+  mRegisterMutex.UnLock();
   return i;
 }
 
 /**
- * 每次测试的结束
- * End of each test.
- * \param event_id.
+ * 为当前线程建立记录槽并登记，每个线程只调用一次
+ * Create and register the record slots of the calling thread.
  */
-void TimeTest::End(int event_id) {
-  if (PlayerParam::instance().TimeTest()) {
-    RealTime end_time = GetRealTime();
-    long cost_time = end_time.Sub(mRecordQueue[event_id].mBeginTime);
-    long last_num = mRecordQueue[event_id].mEachTime.mNum;
-    double last_ave_cost = mRecordQueue[event_id].mEachTime.mAveCost;
-    if (cost_time > mRecordQueue[event_id].mEachTime.mMaxCost) {
-      mRecordQueue[event_id].mEachTime.mMaxCost = cost_time;
-      mRecordQueue[event_id].mEachTime.mMaxTime = mUpdateTime;
+TimeThreadSlot *TimeTest::CreateThreadSlot() {
+  TimeThreadSlot *slot = new TimeThreadSlot;
+  mRecordMutex.Lock();
+  mThreadSlots.push_back(slot);
+  mRecordMutex.UnLock();
+  return slot;
+}
+
+/**
+ * 找到（或建立）调用树中（外层记录，测试）对应的记录
+ * Find or create the record of event_id under parent.
+ * \return record ID, -1 if there are too many records.
+ */
+int TimeTest::FindRecord(int parent, int event_id, int depth) {
+  mRecordMutex.Lock();
+  int record_id = mChildRecord[parent + 1][event_id];
+  if (record_id < 0 && mRecordCount < MAX_RECORDS) {
+    record_id = mRecordCount;
+    TimeRecord &record = mRecords[record_id];
+    mRegisterMutex.Lock();
+    record.mName = mEventNames[event_id];
+    mRegisterMutex.UnLock();
+    record.mEvent = event_id;
+    record.mParent = parent;
+    record.mDepth = depth;
+    mChildRecord[parent + 1][event_id] = record_id;
+    ++mRecordCount;
+  }
+  mRecordMutex.UnLock();
+  return record_id;
+}
+
+/**
+ * 每次测试的开始，按当前线程的外层测试找到调用树中的记录。查找结果缓存在线程
+ * 自己的槽里，只有每个线程第一次遇到某个（外层，测试）时才加锁
+ * Begin of each test. The record is looked up by the enclosing scope of the
+ * calling thread, so threads nesting a scope differently do not mix. Lookups
+ * are cached per thread, so only the first visit of a pair takes a lock.
+ * \param event_id ID returned by Register().
+ * \return record ID, -1 if the test should be skipped.
+ */
+int TimeTest::Begin(int event_id) {
+  if (!PlayerParam::instance().TimeTest() || event_id < 0 ||
+      scope_depth >= MAX_EVENTS) {
+    return -1;
+  }
+
+  for (int i = 0; i < scope_depth; ++i) { // 递归调用只统计最外层
+    if (scope_event[i] == event_id) {
+      return -1;
     }
-    if (cost_time < mRecordQueue[event_id].mEachTime.mMinCost) {
-      mRecordQueue[event_id].mEachTime.mMinCost = cost_time;
-      mRecordQueue[event_id].mEachTime.mMinTime = mUpdateTime;
+  }
+
+  if (thread_slot == 0) {
+    thread_slot = CreateThreadSlot();
+  }
+
+  const int parent = (scope_depth > 0) ? scope_stack[scope_depth - 1] : -1;
+
+  int record_id = thread_slot->mChildRecord[parent + 1][event_id] - 1;
+  if (record_id < 0) {
+    record_id = FindRecord(parent, event_id, scope_depth);
+    if (record_id < 0) {
+      return -1;
     }
+    thread_slot->mChildRecord[parent + 1][event_id] = record_id + 1;
+  }
+
+  scope_stack[scope_depth] = record_id;
+  scope_event[scope_depth] = event_id;
+  scope_begin[scope_depth] = GetRealTime();
+  ++scope_depth;
+  return record_id;
+}
 
-    mRecordQueue[event_id].mEachTime.mAveCost =
-        (last_ave_cost * last_num + cost_time) / (last_num + 1);
-    ++mRecordQueue[event_id].mEachTime.mNum;
-    mRecordQueue[event_id].mCycleTimeCost += cost_time;
-    mIsExecute[event_id] = true;
-    mIsBegin[event_id] = false;
+/**
+ * 每次测试的开始
+ * Begin of each test.
+ * \param func_name name of the function which will be tested.
+ * \return event ID.
+ */
+int TimeTest::Begin(std::string func_name) {
+  if (!PlayerParam::instance().TimeTest()) {
+    return -1;
+  }
+  return Begin(Register(func_name.c_str()));
+}
+
+/**
+ * 每次测试的结束，只写当前线程自己的槽，不加锁
+ * End of each test. Only the calling thread's slot is written, lock-free.
+ * \param record_id ID returned by Begin().
+ */
+void TimeTest::End(int record_id) {
+  if (record_id < 0 || scope_depth <= 0 ||
+      scope_stack[scope_depth - 1] != record_id) {
+    return;
+  }
+
+  --scope_depth;
+  const long cost_time =
+      RealTime(GetRealTime()).Sub(RealTime(scope_begin[scope_depth]));
+
+  TimeThreadRecord &record = thread_slot->mRecords[record_id];
+  TimeCost &each_time = record.mEachTime;
+
+  if (cost_time > each_time.mMaxCost) {
+    each_time.mMaxCost = cost_time;
+    each_time.mMaxTime = mUpdateTime;
+  }
+  if (cost_time < each_time.mMinCost) {
+    each_time.mMinCost = cost_time;
+    each_time.mMinTime = mUpdateTime;
   }
+
+  each_time.mAveCost =
+      (each_time.mAveCost * each_time.mNum + cost_time) / (each_time.mNum + 1);
+  ++each_time.mNum;
+  record.mCost += cost_time;
+  ++record.mCalls;
+}
+
+/**
+ * 输出文本报告，按嵌套关系缩进，每周期耗时给出p50/p95/p99/max
+ * Write the text report, scopes indented by nesting.
+ */
+void TimeTest::WriteReport() {
+  char file_name[256];
+  sprintf(file_name, "Test/TimeTest-%d.txt", mUnum);
+  std::ofstream out_file(file_name);
+  if (out_file.good() == false) {
+    PRINT_ERROR("open file error  " << file_name);
+    return;
+  }
+
+  out_file << std::fixed << std::setprecision(3);
+  out_file << "# name calls ave/call max/call | cycles ave p50 p95 p99 max"
+           << " (ms)" << std::endl;
+
+  // 深度优先，子测试紧跟在父测试后面
+  std::vector<int> stack;
+  for (int i = mRecordCount - 1; i >= 0; --i) {
+    if (mRecords[i].mParent < 0) {
+      stack.push_back(i);
+    }
+  }
+  while (!stack.empty()) {
+    const int id = stack.back();
+    stack.pop_back();
+    for (int i = mRecordCount - 1; i >= 0; --i) {
+      if (mRecords[i].mParent == id) {
+        stack.push_back(i);
+      }
+    }
+
+    const TimeRecord &record = mRecords[id];
+    if (record.mEachTime.mNum == 0) {
+      continue;
+    }
+    out_file << std::string(record.mDepth * 2, ' ') << record.mName << " "
+             << record.mEachTime.mNum << " "
+             << record.mEachTime.mAveCost / 1000.0 << " "
+             << record.mEachTime.mMaxCost / 1000.0 << " | "
+             << record.mEachCycle.mNum << " "
+             << record.mEachCycle.mAveCost / 1000.0 << " "
+             << Percentile(record.mCycleCosts, 0.50) / 1000.0 << " "
+             << Percentile(record.mCycleCosts, 0.95) / 1000.0 << " "
+             << Percentile(record.mCycleCosts, 0.99) / 1000.0 << " "
+             << record.mEachCycle.mMaxCost / 1000.0 << "  "
+             << record.mEachCycle.mMaxTime << std::endl;
+  }
+
+  out_file << std::endl
+           << "Cycles over " << ServerParam::instance().simStep()
+           << " ms: " << mOverBudgetCount << std::endl;
+  for (unsigned i = 0; i < mOverBudget.size(); ++i) {
+    out_file << mOverBudget[i].mTime << " " << mOverBudget[i].mCost / 1000.0
+             << " " << mOverBudget[i].mPath << " "
+             << mOverBudget[i].mPathCost / 1000.0 << std::endl;
+  }
+
+  out_file.close();
+}
+
+/**
+ * 输出二进制环形缓冲区，格式为：
+ * "WETT" int:version int:n {int:parent char[32]:name}*n int:m TimeSample*m
+ * Dump the binary ring buffer in chronological order.
+ */
+void TimeTest::WriteRing() {
+  char file_name[256];
+  sprintf(file_name, "Test/TimeTest-%d.bin", mUnum);
+  std::ofstream out_file(file_name, std::ios::binary);
+  if (out_file.good() == false) {
+    PRINT_ERROR("open file error  " << file_name);
+    return;
+  }
+
+  const int version = 1;
+  out_file.write("WETT", 4);
+  out_file.write((const char *)&version, sizeof(version));
+  out_file.write((const char *)&mRecordCount, sizeof(mRecordCount));
+  for (int i = 0; i < mRecordCount; ++i) {
+    char name[32];
+    memset(name, 0, sizeof(name));
+    strncpy(name, mRecords[i].mName.c_str(), sizeof(name) - 1);
+    out_file.write((const char *)&mRecords[i].mParent, sizeof(int));
+    out_file.write(name, sizeof(name));
+  }
+
+  const int count = mRingFull ? RING_SIZE : mRingHead;
+  out_file.write((const char *)&count, sizeof(count));
+  if (mRingFull) {
+    out_file.write((const char *)&mRing[mRingHead],
+                   sizeof(TimeSample) * (RING_SIZE - mRingHead));
+  }
+  if (mRingHead > 0) {
+    out_file.write((const char *)&mRing[0], sizeof(TimeSample) * mRingHead);
+  }
+
+  out_file.close();
+}
+
+/**
+ * Constructor.
+ * \param event_id ID returned by TimeTest::Register().
+ */
+TimeTestFunc::TimeTestFunc(int event_id) {
+  mRecordID = TimeTest::instance().Begin(event_id);
 }
 
 /**
@@ -212,19 +589,15 @@ void TimeTest::End(int event_id) {
  * \param func_name name of the function which will be tested.
  */
 TimeTestFunc::TimeTestFunc(std::string func_name) {
-  if (PlayerParam::instance().TimeTest()) {
-    mEventID = TimeTest::instance().Begin(func_name);
-  }
+  mRecordID = TimeTest::instance().Begin(func_name);
 }
 
 /**
  * Destructor.
  */
 TimeTestFunc::~TimeTestFunc() {
-  if (PlayerParam::instance().TimeTest()) {
-    if (mEventID >= 0) {
-      TimeTest::instance().End(mEventID);
-    }
+  if (mRecordID >= 0) {
+    TimeTest::instance().End(mRecordID);
   }
 }
 
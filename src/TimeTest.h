@@ -32,15 +32,26 @@
 #ifndef __TimeTest_H__
 #define __TimeTest_H__
 
+#include "Thread.h"
 #include "Utilities.h"
 #include <cstring>
+#include <string>
 #include <vector>
 
+#define TIMETEST_CAT_(a, b) a##b
+#define TIMETEST_CAT(a, b) TIMETEST_CAT_(a, b)
+
 /**
- * 测试函数所花时间的接口
- * Interface to calculate the time cost of a function.
+ * 测试函数所花时间的接口，可以嵌套使用，内层的统计会挂在外层下面。
+ * 每个调用点只在第一次执行时按名字注册一次，之后只有两次取时间的开销。
+ * Interface to calculate the time cost of a scope. Scopes may nest; each call
+ * site registers its name once, so the steady-state cost is two clock reads.
  */
-#define TIMETEST(func_name) TimeTestFunc time_test_func(func_name);
+#define TIMETEST(func_name)                                                    \
+  static const int TIMETEST_CAT(time_test_event_, __LINE__) =                  \
+      TimeTest::instance().Register(func_name);                                \
+  TimeTestFunc TIMETEST_CAT(time_test_func_, __LINE__)(                        \
+      TIMETEST_CAT(time_test_event_, __LINE__));
 
 /**
  * TimeCost.
@@ -103,10 +114,21 @@ struct TimeRecord {
    * Constructor.
    */
   TimeRecord() {
-    mBeginTime = RealTime(0, 0);
+    mEvent = -1;
     mCycleTimeCost = 0;
+    mCycleCalls = 0;
+    mParent = -1;
+    mDepth = 0;
+    mIsExecute = false;
   }
 
+  /**
+   * 测试的名字和注册编号
+   * Name and registered event ID of the scope.
+   */
+  std::string mName;
+  int mEvent;
+
   /**
    * 每周期的信息
    * Time cost for every cycle.
@@ -120,18 +142,47 @@ struct TimeRecord {
   TimeCost mEachTime;
 
   /**
-   * 每一次的开始时间
-   * Begin time for each call.
+   * 每一周期总共花的时间和调用次数
+   * Total cost and number of calls in the current cycle.
    */
-  RealTime mBeginTime;
+  long mCycleTimeCost;
+  int mCycleCalls;
 
   /**
-   * 每一周期总共花的时间
-   * Total cost for each cycle.
+   * 外层测试的记录，-1表示最外层。同一个测试在不同外层下是不同的记录
+   * Record of the enclosing scope, -1 for a root scope. A scope gets one
+   * record per distinct parent.
    */
-  long mCycleTimeCost;
+  int mParent;
+  int mDepth;
+
+  bool mIsExecute; // 记录当前周期是否被执行过
+
+  /**
+   * 最近若干周期每周期的耗时，用于统计分位数
+   * Per-cycle costs of the recent cycles, used for percentiles.
+   */
+  std::vector<long> mCycleCosts;
 };
 
+/**
+ * 写入二进制环形缓冲区的记录，每周期每个被执行过的测试一条
+ * One entry of the binary ring buffer, per executed scope per cycle.
+ */
+struct TimeSample {
+  int mCycle;
+  short mStopTime;
+  short mEventID;
+  int mCalls;
+  int mCost; // 微秒
+};
+
+/**
+ * 每个线程自己的记录槽，定义在TimeTest.cpp里
+ * Per-thread record slots, defined in TimeTest.cpp.
+ */
+struct TimeThreadSlot;
+
 /**
  * TimeTest.
  */
@@ -154,16 +205,23 @@ public:
   void Update(Time current_time);
 
   /**
-   * 每次测试的开始
-   * Begin of each test.
+   * 按名字注册一个测试，返回其编号，重复注册返回同一个编号
+   * Register a scope by name and return its event ID.
    */
+  int Register(const char *func_name);
+
+  /**
+   * 每次测试的开始，返回调用树中的记录编号
+   * Begin of each test, returns the record ID in the call tree.
+   */
+  int Begin(int event_id);
   int Begin(std::string func_name);
 
   /**
    * 每次测试的结束
    * End of each test.
    */
-  void End(int event_id);
+  void End(int record_id);
 
   /**
    * 设置自己的号码，用于文件名的赋值
@@ -171,11 +229,53 @@ public:
    */
   inline void SetUnum(int unum) { mUnum = unum; }
 
+  static const int MAX_EVENTS = 64;
+  static const int MAX_RECORDS = 256; // 调用树中（外层，测试）的组合数
+  static const unsigned CYCLE_HISTORY = 6000; // 用于统计分位数的周期数
+  static const unsigned RING_SIZE = 1 << 16;  // 二进制环形缓冲区的记录数
+  static const int MAX_OVER_BUDGET_RECORDS = 100;
+
 private:
-  std::vector<std::string> mEventQueue; // 记录测试函数的名字
-  std::vector<TimeRecord> mRecordQueue; // 记录测试的结果
-  std::vector<bool> mIsExecute;         // 记录当前周期是否被执行过
-  std::vector<bool> mIsBegin; // 用来保证Begin()和End()交替执行
+  TimeThreadSlot *CreateThreadSlot();
+  int FindRecord(int parent, int event_id, int depth);
+  void MergeThreadSlots();
+  void CloseCycle();
+  void WriteReport();
+  void WriteRing();
+
+  std::string mEventNames[MAX_EVENTS];
+  int mEventCount;
+  ThreadMutex mRegisterMutex; // parser线程和决策线程都可能注册
+
+  /**
+   * 调用树中每个（外层记录，测试）一条记录，创建后位置不变。各线程的耗时先记在
+   * 自己的槽里，不加锁；每周期结算时在mRecordMutex下合并到这里
+   * One record per (parent record, scope) pair. Threads time into their own
+   * slots without locking; the slots are merged here under mRecordMutex when
+   * a cycle closes.
+   */
+  TimeRecord mRecords[MAX_RECORDS];
+  int mRecordCount;
+  int mChildRecord[MAX_RECORDS + 1][MAX_EVENTS]; // [外层+1][测试]，-1表示没有
+  std::vector<TimeThreadSlot *> mThreadSlots;
+  ThreadMutex mRecordMutex;
+
+  std::vector<TimeSample> mRing;
+  unsigned mRingHead; // 下一条记录写入的位置
+  bool mRingFull;
+
+  /**
+   * 超出一个仿真周期的记录，以及当时最耗时的那条路径
+   * Cycles which exceeded the simulator step, with their slowest path.
+   */
+  struct OverBudget {
+    Time mTime;
+    long mCost;
+    std::string mPath; // 每层耗时最多的测试连成的路径
+    long mPathCost;    // 路径最内层的耗时
+  };
+  std::vector<OverBudget> mOverBudget;
+  long mOverBudgetCount;
 
   Time mUpdateTime; // 上次update的周期
   int mUnum;        // 自己的号码
@@ -186,11 +286,12 @@ private:
  */
 class TimeTestFunc {
 public:
+  TimeTestFunc(int event_id);
   TimeTestFunc(std::string func_name);
   ~TimeTestFunc();
 
 private:
-  int mEventID;
+  int mRecordID;
 };
 
 #endif
@@ -33,6 +33,7 @@
 #include "Agent.h"
 #include "DynamicDebug.h"
 #include "Logger.h"
+#include "MatchLog.h"
 #include "PlayerParam.h"
 #include "Thread.h"
 #include "UDPSocket.h"
@@ -492,6 +493,10 @@ void Trainer::ReadConfigFile() {
 }
 
 bool Trainer::ReadRcgFile() {
+  if (MatchLogReader::IsMatchLog(mTrainRcg)) {
+    return ReadMatchLogFile();
+  }
+
   // TODO 读取之前的PlayMode
   string line;
   const char *buf = 0;
@@ -620,6 +625,49 @@ bool Trainer::ReadRcgFile() {
   return !mPlayerStatesList.empty();
 }
 
+/**
+ * 从二进制sight_log读训练场景，借助索引直接定位到开始周期
+ */
+bool Trainer::ReadMatchLogFile() {
+  const int begin_time = mTrainTime - mInitialTime;
+  const int end_time = mTrainTime;
+
+  MatchLogReader reader;
+  if (!reader.Open(mTrainRcg) || !reader.Seek(begin_time)) {
+    return false;
+  }
+
+  MatchLogShow show;
+  while (reader.Next(show)) {
+    pair<Vector, Vector> bs(Vector(show.mBall[0], show.mBall[1]),
+                            Vector(show.mBall[2], show.mBall[3]));
+    bs.second /= 0.94;
+    bs.first -= bs.second; //这是因为Server接到后会模拟一周期
+
+    vector<PlayerState> ps;
+    for (int i = 0; i < ServerParam::TEAM_SIZE * 2; ++i) {
+      const MatchLogShow::Player &player = show.mPlayers[i];
+      const Unum unum = i < ServerParam::TEAM_SIZE
+                            ? i + 1
+                            : ServerParam::TEAM_SIZE - i - 1; // 右方为负
+      ps.push_back(Trainer::PlayerState(
+          unum, Vector(player.mPos[0], player.mPos[1]),
+          Vector(player.mVel[0], player.mVel[1]), player.mBodyDir,
+          player.mType));
+    }
+
+    mServerPlayModeList.push_back(reader.GetPlayMode());
+    mPlayerStatesList.push_back(ps);
+    mBallStateList.push_back(bs);
+
+    if (show.mTime >= end_time) {
+      break;
+    }
+  }
+
+  return !mPlayerStatesList.empty();
+}
+
 void Trainer::Condition::OptimizeConditionTree() {
   for (std::vector<Trainer::Condition>::iterator it = mSubCondition.begin();
        it != mSubCondition.end();) {
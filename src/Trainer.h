@@ -146,6 +146,7 @@ private:
   void InitializeStadium();
   void PrepareForTrain();
   bool ReadRcgFile();
+  bool ReadMatchLogFile();
   bool CheckOpponent() const;
 
   void Start();
@@ -30,12 +30,26 @@
  ************************************************************************************/
 
 #include "UDPSocket.h"
+#include <cerrno>
 
 //==============================================================================
-UDPSocket::UDPSocket() { mIsInitialOK = false; }
+UDPSocket::UDPSocket() {
+  mIsInitialOK = false;
+#ifdef __linux__
+  mEpollfd = -1;
+  mHasTimestamp = false;
+#endif
+}
 
 //==============================================================================
-UDPSocket::~UDPSocket() {}
+UDPSocket::~UDPSocket() {
+#ifdef __linux__
+  if (mEpollfd >= 0) {
+    close(mEpollfd);
+    mEpollfd = -1;
+  }
+#endif
+}
 
 //==============================================================================
 UDPSocket &UDPSocket::instance() {
@@ -91,6 +105,28 @@ void UDPSocket::Initial(const char *host, int port) {
   mAddress.sin_family = AF_INET;
   mAddress.sin_addr.s_addr = inet_addr(host);
   mAddress.sin_port = htons(port);
+
+#ifdef __linux__
+  int on = 1;
+  mHasTimestamp = setsockopt(mSockfd, SOL_SOCKET, SO_TIMESTAMPNS, &on,
+                             sizeof(on)) == 0;
+
+  mEpollfd = epoll_create1(0);
+  if (mEpollfd >= 0) {
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = mSockfd;
+    if (epoll_ctl(mEpollfd, EPOLL_CTL_ADD, mSockfd, &event) < 0) {
+      close(mEpollfd);
+      mEpollfd = -1;
+    }
+  }
+  if (mEpollfd < 0) {
+    PRINT_ERROR("epoll failed, fall back to blocking receive");
+  }
+#endif
+
   mIsInitialOK = true;
 }
 
@@ -114,6 +150,78 @@ int UDPSocket::Receive(char *msg) {
   return n;
 }
 
+//==============================================================================
+int UDPSocket::ReceiveBatch() {
+#ifdef __linux__
+  if (mEpollfd >= 0) {
+    epoll_event event;
+    int ready = 0;
+    while ((ready = epoll_wait(mEpollfd, &event, 1, -1)) < 0 &&
+           errno == EINTR) {
+    }
+    if (ready <= 0) {
+      return ready;
+    }
+
+    for (int i = 0; i < MAX_BATCH; ++i) {
+      mBatchIov[i].iov_base = mBatchBuf[i];
+      mBatchIov[i].iov_len = MAX_MESSAGE;
+
+      msghdr &hdr = mBatchHeader[i].msg_hdr;
+      memset(&hdr, 0, sizeof(hdr));
+      hdr.msg_name = &mBatchAddress[i];
+      hdr.msg_namelen = sizeof(mBatchAddress[i]);
+      hdr.msg_iov = &mBatchIov[i];
+      hdr.msg_iovlen = 1;
+      hdr.msg_control = mBatchControl[i];
+      hdr.msg_controllen = CONTROL_SIZE;
+    }
+
+    //epoll已经告诉有数据，这里不阻塞，把队列里的一次收完
+    int n = recvmmsg(mSockfd, mBatchHeader, MAX_BATCH, MSG_DONTWAIT, 0);
+    if (n < 0) {
+      return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : n;
+    }
+
+    for (int i = 0; i < n; ++i) {
+      mBatchBuf[i][mBatchHeader[i].msg_len] = '\0';
+      mBatchHasTime[i] = false;
+
+      msghdr &hdr = mBatchHeader[i].msg_hdr;
+      for (cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg != 0;
+           cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+          timespec stamp;
+          memcpy(&stamp, CMSG_DATA(cmsg), sizeof(stamp));
+          mBatchTime[i].tv_sec = stamp.tv_sec;
+          mBatchTime[i].tv_usec = stamp.tv_nsec / 1000;
+          mBatchHasTime[i] = mHasTimestamp;
+        }
+      }
+    }
+
+    if (n > 0) {
+      mAddress.sin_port = mBatchAddress[n - 1].sin_port;
+    }
+    return n;
+  }
+#endif
+
+  int n = Receive(mBatchBuf[0]);
+  mBatchHasTime[0] = false;
+  return (n > 0) ? 1 : n;
+}
+
+//==============================================================================
+bool UDPSocket::GetBatchArrivalTime(int i, timeval *arrival) const {
+  if (mBatchHasTime[i]) {
+    *arrival = mBatchTime[i];
+    return true;
+  }
+  return false;
+}
+
 //==============================================================================
 int UDPSocket::Send(const char *msg) {
   if (mIsInitialOK == true) {
@@ -40,10 +40,15 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <unistd.h>
 #endif
 
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
 #include "Types.h"
 #include <iostream>
 
@@ -59,6 +64,24 @@ public:
   int Receive(char *msg);
   int Send(const char *msg);
 
+  enum {
+    MAX_BATCH = 16 /** 一次最多收下的消息条数 */
+  };
+
+  /**
+   * 阻塞到有消息可读，然后一次收下所有排队的消息，返回收到的条数。
+   * Linux下用epoll等待，recvmmsg一次系统调用收完，并带上SO_TIMESTAMPNS给出的
+   * 内核到达时间；其他平台退化为一次收一条
+   */
+  int ReceiveBatch();
+
+  char *GetBatchMessage(int i) { return mBatchBuf[i]; }
+
+  /**
+   * 第i条消息进入内核的时间，没有时间戳时返回false
+   */
+  bool GetBatchArrivalTime(int i, timeval *arrival) const;
+
 private:
   bool mIsInitialOK;
   sockaddr_in mAddress;
@@ -68,6 +91,22 @@ private:
 #else
   int mSockfd;
 #endif
+
+#ifdef __linux__
+  int mEpollfd;
+  bool mHasTimestamp; // SO_TIMESTAMPNS是否设置成功
+
+  enum { CONTROL_SIZE = 64 };
+
+  mmsghdr mBatchHeader[MAX_BATCH];
+  iovec mBatchIov[MAX_BATCH];
+  sockaddr_in mBatchAddress[MAX_BATCH];
+  char mBatchControl[MAX_BATCH][CONTROL_SIZE];
+#endif
+
+  char mBatchBuf[MAX_BATCH][MAX_MESSAGE + 1];
+  bool mBatchHasTime[MAX_BATCH];
+  timeval mBatchTime[MAX_BATCH];
 };
 
 #endif
@@ -64,6 +64,16 @@ timeval GetRealTimeParser() {
   return time_val;
 }
 
+timeval GetRealTimeParser(const timeval &arrival) {
+  if (PlayerParam::instance().DynamicDebugMode() == true) {
+    return DynamicDebug::instance().GetTimeParser();
+  }
+
+  timeval time_val = arrival;
+  DynamicDebug::instance().AddTimeParser(time_val);
+  return time_val;
+}
+
 timeval GetRealTimeDecision() {
   if (PlayerParam::instance().DynamicDebugMode() == true) {
     return DynamicDebug::instance().GetTimeDecision();
@@ -245,6 +245,7 @@ inline double drand(double low, double high) {
  */
 timeval GetRealTime();
 timeval GetRealTimeParser();
+timeval GetRealTimeParser(const timeval &arrival); // 消息带有内核到达时间时用
 timeval GetRealTimeDecision();
 timeval GetRealTimeCommandSend();
 
@@ -461,30 +462,139 @@ private:
  * bellow is parse utilities
  */
 namespace parser {
+/**
+ * 手写的十进制数解析，server发来的数最多只有十几位有效数字，
+ * 尾数在2^53以内且指数绝对值不超过22时结果与strtod完全一致
+ * Hand-written decimal parsers used on the hot path instead of strtod/strtol.
+ * For mantissas below 2^53 and |exponent| <= 22 the result is exactly the
+ * correctly rounded value strtod would return.
+ */
+inline double str_to_double(const char *str, char **end_ptr) {
+  static const double POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                 1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  const char *p = str;
+  bool negative = false;
+  if (*p == '-') {
+    negative = true;
+    ++p;
+  } else if (*p == '+') {
+    ++p;
+  }
+
+  unsigned long long mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool has_digit = false;
+
+  for (; *p >= '0' && *p <= '9'; ++p) {
+    has_digit = true;
+    if (digits < 18) {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += (mantissa != 0);
+    } else {
+      ++exponent;
+    }
+  }
+  if (*p == '.') {
+    ++p;
+    for (; *p >= '0' && *p <= '9'; ++p) {
+      has_digit = true;
+      if (digits < 18) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += (mantissa != 0);
+        --exponent;
+      }
+    }
+  }
+
+  if (!has_digit) {
+    *end_ptr = const_cast<char *>(str);
+    return 0.0;
+  }
+
+  if (*p == 'e' || *p == 'E') {
+    const char *q = p + 1;
+    bool exp_negative = false;
+    if (*q == '-') {
+      exp_negative = true;
+      ++q;
+    } else if (*q == '+') {
+      ++q;
+    }
+    if (*q >= '0' && *q <= '9') {
+      int e = 0;
+      for (; *q >= '0' && *q <= '9'; ++q) {
+        e = e * 10 + (*q - '0');
+      }
+      exponent += exp_negative ? -e : e;
+      p = q;
+    }
+  }
+
+  *end_ptr = const_cast<char *>(p);
+
+  double value = static_cast<double>(mantissa);
+  if (exponent < 0) {
+    value = (exponent >= -22) ? value / POW10[-exponent]
+                              : value * pow(10.0, exponent);
+  } else if (exponent > 0) {
+    value = (exponent <= 22) ? value * POW10[exponent]
+                             : value * pow(10.0, exponent);
+  }
+  return negative ? -value : value;
+}
+
+inline int str_to_int(const char *str, char **end_ptr) {
+  const char *p = str;
+  bool negative = false;
+  if (*p == '-') {
+    negative = true;
+    ++p;
+  } else if (*p == '+') {
+    ++p;
+  }
+
+  if (!(*p >= '0' && *p <= '9')) {
+    *end_ptr = const_cast<char *>(str);
+    return 0;
+  }
+
+  int value = 0;
+  for (; *p >= '0' && *p <= '9'; ++p) {
+    value = value * 10 + (*p - '0');
+  }
+
+  *end_ptr = const_cast<char *>(p);
+  return negative ? -value : value;
+}
+
 inline double get_double(char **str_ptr) {
   while (!isdigit(**str_ptr) && **str_ptr != '-' && **str_ptr != '+' &&
          **str_ptr != '.' && **str_ptr)
     (*str_ptr)++;
-  return strtod(*str_ptr, str_ptr);
+  return str_to_double(*str_ptr, str_ptr);
 }
 
 inline double get_double(char *str) {
   while (!isdigit(*str) && *str != '-' && *str != '+' && *str != '.' && *str)
     str++;
-  return strtod(str, (char **)0);
+  return str_to_double(str, &str);
 }
 
 inline int get_int(char **str_ptr) {
   while (!isdigit(**str_ptr) && **str_ptr != '-' && **str_ptr != '+' &&
          **str_ptr != '.' && **str_ptr)
     (*str_ptr)++;
-  return static_cast<int>(strtol(*str_ptr, str_ptr, 10));
+  return str_to_int(*str_ptr, str_ptr);
 }
 
 inline int get_int(char *str) {
   while (!isdigit(*str) && *str != '-' && *str != '+' && *str != '.' && *str)
     str++;
-  return static_cast<int>(strtol(str, (char **)0, 10));
+  return str_to_int(str, &str);
 }
 
 inline char *get_word(char **str_ptr) {
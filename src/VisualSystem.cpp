@@ -103,6 +103,8 @@ void VisualSystem::ResetVisualRequest() {
 }
 
 void VisualSystem::Decision() {
+  TIMETEST("VisualSystem");
+
   if (mpAgent->GetActionEffector().IsTurnNeck())
     return; //其他地方已经产生了转脖子动作
   if (mForbidden)
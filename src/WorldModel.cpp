@@ -32,7 +32,10 @@
 #include "WorldModel.h"
 #include "InfoState.h"
 #include "Observer.h"
+#include "PlayerParam.h"
+#include "TimeTest.h"
 #include "WorldState.h"
+#include <iostream>
 
 WorldModel::WorldModel() {
   mpHistoryState[0] = new HistoryState;
@@ -41,9 +44,18 @@ WorldModel::WorldModel() {
   mpHistoryState[1] = new HistoryState;
   mpWorldState[1] =
       new WorldState(mpHistoryState[1]); //供反算时用的，对手的世界状态
+
+  mIsReverseDirty = false;
+  mUpdateCount = 0;
+  mReverseCount = 0;
 }
 
 WorldModel::~WorldModel() {
+  if (PlayerParam::instance().TimeTest()) {
+    std::cerr << "reverse world used in " << mReverseCount << " of "
+              << mUpdateCount << " updates" << std::endl;
+  }
+
   delete mpWorldState[0];
   delete mpHistoryState[0];
 
@@ -52,19 +64,41 @@ WorldModel::~WorldModel() {
 }
 
 void WorldModel::Update(Observer *observer) {
+  TIMETEST("WorldModel");
+
   //存储一下当前的世界
   mpHistoryState[0]->UpdateHistory(*mpWorldState[0]);
-  mpHistoryState[1]->UpdateHistory(*mpWorldState[1]);
 
   mpWorldState[0]->UpdateFromObserver(observer); //自己方决策使用的世界状态
-  mpWorldState[1]->GetReverseFrom(
-      mpWorldState[0]); //可供反算对手时使用的世界状态
+
+  mIsReverseDirty = true; //可供反算对手时使用的世界状态，用到时再算
+  ++mUpdateCount;
+}
+
+void WorldModel::UpdateReverse() const {
+  if (!mIsReverseDirty) {
+    return;
+  }
+
+  TIMETEST("ReverseWorld");
+
+  mpHistoryState[1]->GetReverseFrom(mpHistoryState[0]);
+  mpWorldState[1]->GetReverseFrom(mpWorldState[0]);
+
+  mIsReverseDirty = false;
+  ++mReverseCount;
 }
 
 const WorldState &WorldModel::GetWorldState(bool reverse) const {
+  if (reverse) {
+    UpdateReverse();
+  }
   return *(reverse ? mpWorldState[1] : mpWorldState[0]);
 }
 
 WorldState &WorldModel::World(bool reverse) {
+  if (reverse) {
+    UpdateReverse();
+  }
   return *(reverse ? mpWorldState[1] : mpWorldState[0]);
 }
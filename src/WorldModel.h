@@ -38,6 +38,7 @@ class HistoryState;
 
 /**
  * WorldModel 里面存放两对 WorldState，一对用于队友的决策，另一对用于对手的决策
+ * 对手的那一对只在第一次被取用时才从队友的世界反算出来
  */
 class WorldModel {
   WorldModel(WorldModel &);
@@ -51,9 +52,20 @@ public:
   const WorldState &GetWorldState(bool reverse) const;
   WorldState &World(bool reverse);
 
+  /** 总的更新次数，以及其中反算世界被用到的次数 */
+  int GetUpdateCount() const { return mUpdateCount; }
+  int GetReverseCount() const { return mReverseCount; }
+
 private:
+  /** 如果反算世界过期了，从队友的世界和历史重新反算 */
+  void UpdateReverse() const;
+
   WorldState *mpWorldState[2];
   HistoryState *mpHistoryState[2];
+
+  mutable bool mIsReverseDirty; /** 反算世界是否落后于队友的世界 */
+  int mUpdateCount;
+  mutable int mReverseCount;
 };
 
 #endif /* WORLDMODEL_H_ */
@@ -66,6 +66,10 @@ WorldState *WorldState::GetHistory(int i) const {
   return mpHistory->GetHistory(i);
 }
 
+const WorldSnapshot *WorldState::GetSnapshot(int i) const {
+  return mpHistory->GetSnapshot(i);
+}
+
 Time WorldState::GetTimeBeforeCurrent(int cycle) const {
   Assert(cycle <= HistoryState::HISTORY_SIZE && cycle >= 1);
 
@@ -3350,9 +3354,83 @@ double WorldStateUpdater::ComputeTackleProb(const Unum &unum, bool foul) {
   return GetTackleProb(ball_2_player, foul);
 }
 
+HistoryState::HistoryState()
+    : mNum(0), mSnapshot(Max(0, PlayerParam::instance().HistoryDepth())),
+      mCount(0) {}
+
+void ObjectSnapshot::Save(const MobileState &state) {
+  mPos = state.GetPos();
+  mVel = state.GetVel();
+  mPosConf = state.GetPosConf();
+  mVelConf = state.GetVelConf();
+  mPosDelay = Min(state.GetPosDelay(), 32767);
+  mVelDelay = Min(state.GetVelDelay(), 32767);
+  mBodyDir = 0.0f;
+  mNeckDir = 0.0f;
+  mBodyDirConf = 0.0f;
+  mBodyDirDelay = 0;
+  mIsAlive = true;
+}
+
+void ObjectSnapshot::Save(const PlayerState &state) {
+  Save(static_cast<const MobileState &>(state));
+  mBodyDir = state.GetBodyDir();
+  mNeckDir = state.GetNeckDir();
+  mBodyDirConf = state.GetBodyDirConf();
+  mBodyDirDelay = Min(state.GetBodyDirDelay(), 32767);
+  mIsAlive = state.IsAlive();
+}
+
+void ObjectSnapshot::GetReverseFrom(const ObjectSnapshot &o) {
+  *this = o;
+  mPos = o.mPos.Rotate(180.0);
+  mVel = o.mVel.Rotate(180.0);
+  mBodyDir = GetNormalizeAngleDeg(o.mBodyDir + 180.0);
+  mNeckDir = GetNormalizeAngleDeg(o.mNeckDir + 180.0);
+}
+
+void HistoryState::GetReverseFrom(HistoryState *history) {
+  const int count = history->mCount;
+
+  for (int i = Max(mCount, count - HISTORY_SIZE); i < count; ++i) {
+    WorldState &record = mRecord[i % HISTORY_SIZE];
+    record.GetReverseFrom(&history->mRecord[i % HISTORY_SIZE]);
+    record.mpHistory = this;
+  }
+
+  const int size = Min(mSnapshot.size(), history->mSnapshot.size());
+  for (int i = Max(mCount, count - size); i < count; ++i) {
+    const WorldSnapshot &o = history->mSnapshot[i % size];
+    WorldSnapshot &snapshot = mSnapshot[i % size];
+    snapshot.mCurrentTime = o.mCurrentTime;
+    snapshot.mPlayMode = o.mPlayMode;
+    snapshot.mBall.GetReverseFrom(o.mBall);
+    for (int j = 0; j < TEAMSIZE; ++j) {
+      snapshot.mTeammate[j].GetReverseFrom(o.mOpponent[j]);
+      snapshot.mOpponent[j].GetReverseFrom(o.mTeammate[j]);
+    }
+  }
+
+  mCount = count;
+  mNum = count > 0 ? (count - 1) % HISTORY_SIZE + 1 : 0;
+}
+
 void HistoryState::UpdateHistory(const WorldState &world) {
   mNum = mNum % HISTORY_SIZE;
   mRecord[mNum++] = world;
+
+  if (!mSnapshot.empty()) {
+    WorldSnapshot &snapshot = mSnapshot[mCount % mSnapshot.size()];
+    snapshot.mCurrentTime = world.mCurrentTime;
+    snapshot.mPlayMode = world.mPlayMode;
+    snapshot.mBall.Save(world.mBall);
+    for (Unum i = 1; i <= TEAMSIZE; ++i) {
+      snapshot.mTeammate[i - 1].Save(world.mTeammate[i]);
+      snapshot.mOpponent[i - 1].Save(world.mOpponent[i]);
+    }
+  }
+
+  ++mCount;
 }
 
 WorldState *HistoryState::GetHistory(int num) {
@@ -3363,3 +3441,11 @@ WorldState *HistoryState::GetHistory(int num) {
 
   return &mRecord[num];
 }
+
+const WorldSnapshot *HistoryState::GetSnapshot(int num) const {
+  if (num <= 0 || num > mCount || num > (int)mSnapshot.size()) {
+    return 0;
+  }
+
+  return &mSnapshot[(mCount - num) % mSnapshot.size()];
+}
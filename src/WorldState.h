@@ -37,6 +37,7 @@
 #include "Observer.h"
 #include "PlayerState.h"
 #include <cstdlib>
+#include <map>
 #include <vector>
 
 class PlayerObserver;
@@ -52,12 +53,47 @@ class UnknownUnumPlayerObserver;
 class HistoryState;
 class BeliefState;
 
+/**
+ * 一个对象在某周期的精简记录
+ * Compact per-object record of one cycle in the deep history.
+ */
+struct ObjectSnapshot {
+  Vector mPos;
+  Vector mVel;
+  float mPosConf;
+  float mVelConf;
+  float mBodyDir;
+  float mNeckDir;
+  float mBodyDirConf;
+  short mPosDelay;
+  short mVelDelay;
+  short mBodyDirDelay;
+  bool mIsAlive;
+
+  void Save(const MobileState &state);
+  void Save(const PlayerState &state);
+  void GetReverseFrom(const ObjectSnapshot &o);
+};
+
+/**
+ * 一个周期的精简记录，队员下标为号码减一
+ * Compact record of one cycle; player arrays are indexed by unum - 1.
+ */
+struct WorldSnapshot {
+  Time mCurrentTime;
+  PlayMode mPlayMode;
+  ObjectSnapshot mBall;
+  ObjectSnapshot mTeammate[TEAMSIZE];
+  ObjectSnapshot mOpponent[TEAMSIZE];
+};
+
 /**
  * WorldState
  * 里的信息跟自己得号码无关，由于所有信息用队友和对手区分，所以本质上也与自己的边无关
  */
 class WorldState {
   friend class WorldStateUpdater;
+  friend class HistoryState;
   WorldState(const WorldState &);
 
 public:
@@ -111,10 +147,16 @@ public:
   /**
    * get record history
    * @param i stand for i cycles before ,if i = 0 ,it means that you get current
-   * worldstate
+   * worldstate, i should be <= HISTORYSIZE
    */
   WorldState *GetHistory(int i) const;
 
+  /**
+   * 取i个周期前的精简记录，可以比HISTORY_SIZE深，取不到时返回0
+   * @param i 1 ~ history_depth
+   */
+  const WorldSnapshot *GetSnapshot(int i) const;
+
   /**
    * get time cycle  before current time
    * warning : this should not be used when you get WorldState from history  for
@@ -494,9 +536,15 @@ private:
 };
 
 /**记录StateWorld历史信息*/
+/**
+ * 世界状态的历史
+ * 最近HISTORY_SIZE个周期保存完整的WorldState，更新时要用到其中的各种信息；
+ * 每个周期另存一份只有位置、速度、朝向等的精简记录，深度由history_depth决定，
+ * 通过GetSnapshot取用
+ */
 class HistoryState {
 public:
-  HistoryState() : mNum(0) {}
+  HistoryState();
 
   enum { HISTORY_SIZE = 10 };
 
@@ -505,17 +553,35 @@ public:
    */
   void UpdateHistory(const WorldState &world);
 
+  /**
+   * 从队友的历史得到反算对手时用的历史，只补上还没反算过的周期
+   * @param history 队友的历史
+   */
+  void GetReverseFrom(HistoryState *history);
+
   /**获得之前的数组
-   * @param 取值范围为1~HISTORYSIZE，代表从最新到最前的搜索
+   * @param 取值范围为1~HISTORY_SIZE，代表从最新到最前的搜索
    */
   WorldState *GetHistory(int num);
 
+  /**
+   * 获得之前的精简记录
+   * @param num 取值范围为1~history_depth，还没有记录到的返回0
+   */
+  const WorldSnapshot *GetSnapshot(int num) const;
+
 private:
   /**记录StateWorld的数组*/
   Array<WorldState, HISTORY_SIZE> mRecord;
 
   /**记录数组当前的置顶前一个空白*/
   int mNum;
+
+  /** 所有周期的精简记录，环形使用 */
+  std::vector<WorldSnapshot> mSnapshot;
+
+  /** 已加入的总周期数 */
+  int mCount;
 };
 
 #endif /* WORLDSTATE_H_ */
@@ -32,6 +32,8 @@
 #include "Coach.h"
 #include "DynamicDebug.h"
 #include "Logger.h"
+#include "MatchLog.h"
+#include "Net.h"
 #include "Player.h"
 #include "PlayerParam.h"
 #include "ServerParam.h"
@@ -78,6 +80,43 @@ void signal_catcher(int sig) {
   exit(0); //这里会调用静态对象的析构函数
 #endif
 }
+
+/**
+ * 离线训练网络：从 net_model_file 读入网络，在 net_train_file 上训练后存回，
+ * 样本读取失败时不保存
+ */
+bool train_net() {
+  const PlayerParam &param = PlayerParam::instance();
+
+  Net net(param.NetModelFile().c_str());
+  net.SetBatchSize(param.NetBatchSize());
+  net.SetThreads(param.NetTrainThreads());
+  net.SetValidation(param.NetValidationRatio(), param.NetPatience());
+  if (!net.TrainOnFile(param.NetTrainFile().c_str())) {
+    return false;
+  }
+  net.Save(param.NetModelFile().c_str());
+  return true;
+}
+
+/**
+ * 把二进制的sight_log转成rcg文本，供不支持的回放工具使用，输出到同名的.rcg文件
+ */
+bool convert_sight_log() {
+  const std::string &file_name = PlayerParam::instance().SightLogConvert();
+
+  std::string rcg_file = file_name;
+  const std::string::size_type dot = rcg_file.rfind('.');
+  if (dot != std::string::npos &&
+      rcg_file.find('/', dot) == std::string::npos) {
+    rcg_file.erase(dot);
+  }
+  rcg_file += ".rcg";
+
+  MatchLogReader reader;
+  return reader.Open(file_name.c_str()) &&
+         reader.ConvertToRcg(rcg_file.c_str());
+}
 } // namespace
 
 void RegisterSignalHandler();
@@ -89,6 +128,14 @@ int main(int argc, char *argv[]) {
   ServerParam::instance().init(argc, argv);
   PlayerParam::instance().init(argc, argv);
 
+  if (PlayerParam::instance().NetTrain()) {
+    return train_net() ? 0 : 1;
+  }
+
+  if (!PlayerParam::instance().SightLogConvert().empty()) {
+    return convert_sight_log() ? 0 : 1;
+  }
+
   Client *client = 0;
 
   if (PlayerParam::instance().isCoach()) {
@@ -101,6 +148,8 @@ int main(int argc, char *argv[]) {
 
   if (PlayerParam::instance().DynamicDebugMode()) {
     client->RunDynamicDebug(); // 进入动态调试模式
+  } else if (PlayerParam::instance().HeadlessMode()) {
+    client->RunHeadless(); // 进入离线无头模式
   } else {
     client->RunNormal(); // 进入正常比赛模式
   }